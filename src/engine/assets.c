@@ -0,0 +1,439 @@
+#include "assets.h"
+#include "renderer.h"
+#include "glstate.h"
+#include "forgesystem.h"
+#include "timer.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glew.h>
+
+Assets g_assets;
+
+static int UseGL(void)
+{
+    return g_renderer && Renderer_GetBackend(g_renderer) == RENDERER_BACKEND_OPENGL;
+}
+
+// without threads the lock is NULL and loads decode on the calling thread
+static void Lock(void)
+{
+    if (g_assets.lock)
+    {
+        SDL_LockMutex(g_assets.lock);
+    }
+}
+
+static void Unlock(void)
+{
+    if (g_assets.lock)
+    {
+        SDL_UnlockMutex(g_assets.lock);
+    }
+}
+
+static void ClearSlot(TextureAsset* t)
+{
+    UnloadPNGPixels(t->pixels);
+    memset(t, 0, sizeof(*t));
+}
+
+static void FreeHandle(Texture2D* texture)
+{
+    // placeholders share one texture, which is not theirs to delete
+    if (texture->id == g_assets.placeholder)
+    {
+        free(texture);
+        return;
+    }
+    UnloadTexture(texture);
+}
+
+static TextureAsset* FindHandle(const Texture2D* texture)
+{
+    for (int i = 0; i < ASSETS_MAX_TEXTURES; ++i)
+    {
+        TextureAsset* t = &g_assets.textures[i];
+        if (t->state != ASSET_EMPTY && t->texture == texture)
+        {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+static void Decode(TextureAsset* t, const char* path)
+{
+    int width = 0;
+    int height = 0;
+    unsigned char* pixels = LoadPNGPixels(path, &width, &height);
+
+    Lock();
+    t->pixels = pixels;
+    t->width = width;
+    t->height = height;
+    t->state = pixels ? ASSET_DECODED : ASSET_FAILED;
+    Unlock();
+}
+
+static int AssetWorker(void* data)
+{
+    (void)data;
+    Assets* a = &g_assets;
+
+    SDL_LockMutex(a->lock);
+    for (;;)
+    {
+        while (!a->quit && a->queue_count == 0)
+        {
+            SDL_CondWait(a->wake, a->lock);
+        }
+        if (a->quit)
+        {
+            break;
+        }
+
+        int slot = a->queue[a->queue_head];
+        a->queue_head = (a->queue_head + 1) % ASSETS_MAX_TEXTURES;
+        a->queue_count--;
+
+        TextureAsset* t = &a->textures[slot];
+        if (t->refs == 0)
+        {
+            // released before it was picked up, Assets_Update clears the slot
+            t->state = ASSET_FAILED;
+            continue;
+        }
+
+        char path[sizeof(t->path)];
+        memcpy(path, t->path, sizeof(path));
+        t->state = ASSET_DECODING;
+        SDL_UnlockMutex(a->lock);
+
+        Decode(t, path);
+
+        SDL_LockMutex(a->lock);
+    }
+    SDL_UnlockMutex(a->lock);
+    return 0;
+}
+
+void Assets_Init(void)
+{
+    Assets* a = &g_assets;
+    memset(a, 0, sizeof(*a));
+
+    if (UseGL())
+    {
+        const unsigned char transparent[4] = { 0, 0, 0, 0 };
+        Texture2D* placeholder = LoadTextureFromPixels(transparent, 1, 1);
+        if (placeholder)
+        {
+            a->placeholder = placeholder->id;
+            free(placeholder);
+        }
+
+        if (GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object)
+        {
+            StreamBuffer_Init(&a->upload, GL_PIXEL_UNPACK_BUFFER, ASSETS_UPLOAD_BUFFER_SIZE);
+            // a bound unpack buffer turns every client pointer passed to glTex*Image into an offset
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+    }
+
+    a->lock = SDL_CreateMutex();
+    a->wake = SDL_CreateCond();
+    if (a->lock && a->wake)
+    {
+        for (int i = 0; i < ASSETS_WORKERS; ++i)
+        {
+            a->workers[a->worker_count] = SDL_CreateThread(AssetWorker, "assets", NULL);
+            if (a->workers[a->worker_count])
+            {
+                a->worker_count++;
+            }
+        }
+    }
+
+    if (a->worker_count == 0)
+    {
+        dbg_msg("Assets", "No worker threads (%s), decoding on the calling thread", SDL_GetError());
+        if (a->wake)
+        {
+            SDL_DestroyCond(a->wake);
+            a->wake = NULL;
+        }
+        if (a->lock)
+        {
+            SDL_DestroyMutex(a->lock);
+            a->lock = NULL;
+        }
+    }
+
+    a->initialized = 1;
+    dbg_msg("Assets", "Asset loader started with %d worker threads%s",
+        a->worker_count, a->upload.buffer ? ", PBO uploads" : "");
+}
+
+void Assets_Shutdown(void)
+{
+    Assets* a = &g_assets;
+    if (!a->initialized)
+    {
+        return;
+    }
+
+    if (a->worker_count > 0)
+    {
+        SDL_LockMutex(a->lock);
+        a->quit = 1;
+        SDL_CondBroadcast(a->wake);
+        SDL_UnlockMutex(a->lock);
+        for (int i = 0; i < a->worker_count; ++i)
+        {
+            SDL_WaitThread(a->workers[i], NULL);
+        }
+        SDL_DestroyCond(a->wake);
+        SDL_DestroyMutex(a->lock);
+    }
+
+    for (int i = 0; i < ASSETS_MAX_TEXTURES; ++i)
+    {
+        TextureAsset* t = &a->textures[i];
+        if (t->texture)
+        {
+            FreeHandle(t->texture);
+        }
+        ClearSlot(t);
+    }
+
+    StreamBuffer_Destroy(&a->upload);
+    if (a->placeholder != 0)
+    {
+        GLState_DeleteTexture(a->placeholder);
+    }
+    memset(a, 0, sizeof(*a));
+}
+
+Texture2D* Assets_LoadTexture(TextureAtlas* atlas, const char* path)
+{
+    Assets* a = &g_assets;
+    if (!path || !path[0])
+    {
+        return NULL;
+    }
+    if (!a->initialized)
+    {
+        dbg_msg("Assets", "Assets_Init was not called, cannot load %s", path);
+        return NULL;
+    }
+
+    Lock();
+    TextureAsset* t = NULL;
+    for (int i = 0; i < ASSETS_MAX_TEXTURES; ++i)
+    {
+        TextureAsset* s = &a->textures[i];
+        if (s->state == ASSET_EMPTY)
+        {
+            if (!t)
+            {
+                t = s;
+            }
+            continue;
+        }
+        if (s->refs > 0 && s->atlas == atlas && strcmp(s->path, path) == 0)
+        {
+            s->refs++;
+            Unlock();
+            return s->texture;
+        }
+    }
+
+    Texture2D* texture = t ? (Texture2D*)calloc(1, sizeof(Texture2D)) : NULL;
+    if (!texture)
+    {
+        Unlock();
+        dbg_msg("Assets", "No free texture slot for %s", path);
+        return NULL;
+    }
+    texture->id = a->placeholder;
+
+    strncpy(t->path, path, sizeof(t->path) - 1);
+    t->path[sizeof(t->path) - 1] = '\0';
+    t->atlas = atlas;
+    t->texture = texture;
+    t->refs = 1;
+    t->state = ASSET_QUEUED;
+
+    if (a->worker_count > 0)
+    {
+        a->queue[(a->queue_head + a->queue_count) % ASSETS_MAX_TEXTURES] = (int)(t - a->textures);
+        a->queue_count++;
+        SDL_CondSignal(a->wake);
+        Unlock();
+    }
+    else
+    {
+        Unlock();
+        t->state = ASSET_DECODING;
+        Decode(t, t->path);
+    }
+    return texture;
+}
+
+void Assets_ReleaseTexture(Texture2D* texture)
+{
+    if (!texture || !g_assets.initialized)
+    {
+        return;
+    }
+
+    Lock();
+    TextureAsset* t = FindHandle(texture);
+    if (!t || --t->refs > 0)
+    {
+        Unlock();
+        return;
+    }
+
+    t->texture = NULL;
+    // a slot still queued or decoding is cleared by Assets_Update once its worker is done
+    if (t->state != ASSET_QUEUED && t->state != ASSET_DECODING)
+    {
+        ClearSlot(t);
+    }
+    Unlock();
+
+    FreeHandle(texture);
+}
+
+int Assets_IsReady(const Texture2D* texture)
+{
+    if (!texture || !g_assets.initialized)
+    {
+        return 0;
+    }
+
+    Lock();
+    TextureAsset* t = FindHandle(texture);
+    int ready = t && t->state == ASSET_READY;
+    Unlock();
+    return ready;
+}
+
+// returns 1 when the pixels went through the unpack ring
+static int Upload(TextureAsset* t)
+{
+    Assets* a = &g_assets;
+    GLsizeiptr bytes = (GLsizeiptr)t->width * (GLsizeiptr)t->height * 4;
+    Texture2D* loaded = NULL;
+    int used_ring = 0;
+
+    if (UseGL() && t->atlas)
+    {
+        loaded = Atlas_AddPixels(t->atlas, t->pixels, t->width, t->height);
+    }
+    else if (UseGL() && a->upload.buffer && bytes <= ASSETS_UPLOAD_BUFFER_SIZE)
+    {
+        GLintptr offset = StreamBuffer_Upload(&a->upload, t->pixels, bytes, 4);
+        if (offset >= 0)
+        {
+            // with the unpack buffer bound the pixel pointer is read as an offset
+            // into it, and the driver copies from there after glTexImage2D returns
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, a->upload.buffer);
+            loaded = LoadTextureFromPixels((const unsigned char*)(intptr_t)offset, t->width, t->height);
+            used_ring = 1;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (!loaded && !used_ring)
+    {
+        // Direct2D ends up here too and draws the bitmap by path
+        loaded = LoadTextureFromPixels(t->pixels, t->width, t->height);
+    }
+    if (UseGL())
+    {
+        g_renderer->upload_bytes += (size_t)bytes;
+    }
+
+    UnloadPNGPixels(t->pixels);
+    t->pixels = NULL;
+
+    Lock();
+    if (loaded)
+    {
+        *t->texture = *loaded;
+        strncpy(t->texture->path, t->path, sizeof(t->texture->path) - 1);
+        t->texture->path[sizeof(t->texture->path) - 1] = '\0';
+        free(loaded);
+        t->state = ASSET_READY;
+    }
+    else
+    {
+        dbg_msg("Assets", "Failed to upload %s", t->path);
+        t->state = ASSET_FAILED;
+    }
+    Unlock();
+    return used_ring;
+}
+
+int Assets_Update(double budget)
+{
+    Assets* a = &g_assets;
+    if (!a->initialized)
+    {
+        return 0;
+    }
+
+    double start = GetTime();
+    int uploaded = 0;
+    int used_ring = 0;
+    int pending = 0;
+    for (;;)
+    {
+        TextureAsset* next = NULL;
+        pending = 0;
+
+        Lock();
+        for (int i = 0; i < ASSETS_MAX_TEXTURES; ++i)
+        {
+            TextureAsset* t = &a->textures[i];
+            if (t->refs == 0 && (t->state == ASSET_DECODED || t->state == ASSET_FAILED))
+            {
+                ClearSlot(t);
+            }
+            else if (t->state == ASSET_QUEUED || t->state == ASSET_DECODING || t->state == ASSET_DECODED)
+            {
+                pending++;
+                if (!next && t->state == ASSET_DECODED)
+                {
+                    next = t;
+                }
+            }
+        }
+        Unlock();
+
+        if (!next || (uploaded > 0 && GetTime() - start >= budget))
+        {
+            break;
+        }
+
+        // decoded slots are only touched on this thread, so the upload runs unlocked
+        used_ring |= Upload(next);
+        uploaded++;
+    }
+
+    if (used_ring)
+    {
+        StreamBuffer_EndFrame(&a->upload);
+    }
+    return pending;
+}
+
+void Assets_Finish(void)
+{
+    while (Assets_Update(1.0) > 0)
+    {
+        SDL_Delay(1);
+    }
+}
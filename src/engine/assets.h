@@ -0,0 +1,89 @@
+#ifndef __FORGE_ASSETS_H__
+#define __FORGE_ASSETS_H__
+
+#include "atlas.h"
+#include "streambuffer.h"
+#include "texture.h"
+#include <SDL2/SDL.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define ASSETS_MAX_TEXTURES 256
+#define ASSETS_WORKERS 2
+// per segment of the pixel unpack ring; larger images upload straight from memory
+#define ASSETS_UPLOAD_BUFFER_SIZE (4 * 1024 * 1024)
+
+typedef enum AssetState
+{
+    ASSET_EMPTY = 0,
+    ASSET_QUEUED,
+    ASSET_DECODING,
+    ASSET_DECODED,
+    ASSET_READY,
+    ASSET_FAILED
+} AssetState;
+
+typedef struct TextureAsset
+{
+    char path[260];
+    TextureAtlas* atlas;
+    Texture2D* texture;     // handle given out, NULL once the last reference is released
+    int refs;
+    AssetState state;
+    unsigned char* pixels;  // decoded RGBA, owned until uploaded
+    int width;
+    int height;
+} TextureAsset;
+
+// Textures are decoded by worker threads and uploaded on the GL thread by
+// Assets_Update within a time budget. Handles are stable: until the upload
+// they are 0x0 and sample a transparent placeholder, then their fields are
+// filled in place, so callers may hold them from the first frame. A failed
+// load stays 0x0, so code that measures a texture or gates gameplay on it
+// checks width > 0 where it used to check for NULL.
+typedef struct Assets
+{
+    TextureAsset textures[ASSETS_MAX_TEXTURES];
+    int queue[ASSETS_MAX_TEXTURES];     // slots waiting for a worker
+    int queue_head;
+    int queue_count;
+
+    SDL_mutex* lock;
+    SDL_cond* wake;
+    SDL_Thread* workers[ASSETS_WORKERS];
+    int worker_count;
+    int quit;
+
+    unsigned int placeholder;
+    StreamBuffer upload;
+    int initialized;
+} Assets;
+
+extern Assets g_assets;
+
+void Assets_Init(void);
+// releases every handle still held; later releases of those handles are ignored
+void Assets_Shutdown(void);
+
+// Returns a handle right away and queues the decode. Loading the same path
+// into the same atlas (or NULL for a standalone texture) again returns the
+// same handle with one more reference.
+Texture2D* Assets_LoadTexture(TextureAtlas* atlas, const char* path);
+// handles must be released here rather than with UnloadTexture
+void Assets_ReleaseTexture(Texture2D* texture);
+int  Assets_IsReady(const Texture2D* texture);
+
+// Uploads decoded images until `budget` seconds are spent, at least one per
+// call. Returns how many loads are still in flight.
+int  Assets_Update(double budget);
+// blocks until every queued load has been uploaded or has failed
+void Assets_Finish(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FORGE_ASSETS_H__
@@ -0,0 +1,286 @@
+#include "atlas.h"
+#include "renderer.h"
+#include "forgesystem.h"
+#include "glstate.h"
+#include <stdlib.h>
+#include <string.h>
+#include <GL/glew.h>
+
+// border around each sprite, filled with its edge texels so linear filtering never bleeds
+#define ATLAS_PADDING 1
+
+static int SkylineFit(const AtlasPage* page, int page_size, int index, int width, int height, int* out_y)
+{
+    int x = page->skyline[index].x;
+    if (x + width > page_size)
+    {
+        return 0;
+    }
+
+    int y = page->skyline[index].y;
+    int remaining = width;
+    int i = index;
+    while (remaining > 0)
+    {
+        if (i >= page->node_count)
+        {
+            return 0;
+        }
+        if (page->skyline[i].y > y)
+        {
+            y = page->skyline[i].y;
+        }
+        if (y + height > page_size)
+        {
+            return 0;
+        }
+        remaining -= page->skyline[i].width;
+        i++;
+    }
+
+    *out_y = y;
+    return 1;
+}
+
+static int SkylineInsert(AtlasPage* page, int page_size, int width, int height, int* out_x, int* out_y)
+{
+    int best_index = -1;
+    int best_bottom = page_size + 1;
+    int best_width = page_size + 1;
+    int best_y = 0;
+
+    for (int i = 0; i < page->node_count; ++i)
+    {
+        int y = 0;
+        if (!SkylineFit(page, page_size, i, width, height, &y))
+        {
+            continue;
+        }
+        int bottom = y + height;
+        if (bottom < best_bottom || (bottom == best_bottom && page->skyline[i].width < best_width))
+        {
+            best_index = i;
+            best_bottom = bottom;
+            best_width = page->skyline[i].width;
+            best_y = y;
+        }
+    }
+
+    if (best_index < 0 || page->node_count >= page_size)
+    {
+        return 0;
+    }
+
+    AtlasSkylineNode node = { page->skyline[best_index].x, best_y + height, width };
+    memmove(&page->skyline[best_index + 1], &page->skyline[best_index],
+            (size_t)(page->node_count - best_index) * sizeof(AtlasSkylineNode));
+    page->skyline[best_index] = node;
+    page->node_count++;
+
+    // trim the nodes now covered by the new one
+    for (int i = best_index + 1; i < page->node_count; ++i)
+    {
+        const AtlasSkylineNode* prev = &page->skyline[i - 1];
+        AtlasSkylineNode* cur = &page->skyline[i];
+        int overlap = prev->x + prev->width - cur->x;
+        if (overlap <= 0)
+        {
+            break;
+        }
+
+        cur->x += overlap;
+        cur->width -= overlap;
+        if (cur->width > 0)
+        {
+            break;
+        }
+
+        memmove(&page->skyline[i], &page->skyline[i + 1],
+                (size_t)(page->node_count - i - 1) * sizeof(AtlasSkylineNode));
+        page->node_count--;
+        i--;
+    }
+
+    for (int i = 0; i < page->node_count - 1; ++i)
+    {
+        if (page->skyline[i].y == page->skyline[i + 1].y)
+        {
+            page->skyline[i].width += page->skyline[i + 1].width;
+            memmove(&page->skyline[i + 1], &page->skyline[i + 2],
+                    (size_t)(page->node_count - i - 2) * sizeof(AtlasSkylineNode));
+            page->node_count--;
+            i--;
+        }
+    }
+
+    *out_x = node.x;
+    *out_y = best_y;
+    return 1;
+}
+
+static AtlasPage* AddPage(TextureAtlas* atlas)
+{
+    if (atlas->page_count >= ATLAS_MAX_PAGES)
+    {
+        return NULL;
+    }
+
+    AtlasPage* page = &atlas->pages[atlas->page_count];
+    page->skyline = (AtlasSkylineNode*)malloc(sizeof(AtlasSkylineNode) * (size_t)atlas->page_size);
+    if (!page->skyline)
+    {
+        return NULL;
+    }
+    page->skyline[0] = (AtlasSkylineNode){ 0, 0, atlas->page_size };
+    page->node_count = 1;
+
+    glGenTextures(1, &page->texture);
+    GLState_BindTexture(GL_TEXTURE_2D, page->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlas->page_size, atlas->page_size, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+    atlas->page_count++;
+    dbg_msg("Atlas", "Page %d created: %dx%d", atlas->page_count - 1, atlas->page_size, atlas->page_size);
+    return page;
+}
+
+static void UploadPadded(const AtlasPage* page, int x, int y, const unsigned char* pixels, int width, int height)
+{
+    int pw = width + ATLAS_PADDING * 2;
+    int ph = height + ATLAS_PADDING * 2;
+    unsigned char* padded = (unsigned char*)malloc((size_t)pw * (size_t)ph * 4);
+    if (!padded)
+    {
+        return;
+    }
+
+    for (int py = 0; py < ph; ++py)
+    {
+        int sy = py - ATLAS_PADDING;
+        sy = sy < 0 ? 0 : (sy >= height ? height - 1 : sy);
+        for (int px = 0; px < pw; ++px)
+        {
+            int sx = px - ATLAS_PADDING;
+            sx = sx < 0 ? 0 : (sx >= width ? width - 1 : sx);
+            memcpy(padded + ((size_t)py * pw + px) * 4, pixels + ((size_t)sy * width + sx) * 4, 4);
+        }
+    }
+
+    GLState_BindTexture(GL_TEXTURE_2D, page->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, pw, ph, GL_RGBA, GL_UNSIGNED_BYTE, padded);
+    free(padded);
+}
+
+TextureAtlas* LoadTextureAtlas(int page_size)
+{
+    if (page_size <= ATLAS_PADDING * 2)
+    {
+        return NULL;
+    }
+
+    TextureAtlas* atlas = (TextureAtlas*)calloc(1, sizeof(TextureAtlas));
+    if (!atlas)
+    {
+        return NULL;
+    }
+    atlas->page_size = page_size;
+    return atlas;
+}
+
+void UnloadTextureAtlas(TextureAtlas* atlas)
+{
+    if (!atlas)
+    {
+        return;
+    }
+
+    if (atlas->page_count > 0)
+    {
+        Renderer_Flush();
+    }
+    for (int i = 0; i < atlas->page_count; ++i)
+    {
+        GLState_DeleteTexture(atlas->pages[i].texture);
+        free(atlas->pages[i].skyline);
+    }
+    free(atlas);
+}
+
+Texture2D* Atlas_AddPixels(TextureAtlas* atlas, const unsigned char* pixels, int width, int height)
+{
+    if (!pixels || width <= 0 || height <= 0)
+    {
+        return NULL;
+    }
+
+    int pw = width + ATLAS_PADDING * 2;
+    int ph = height + ATLAS_PADDING * 2;
+    if (!atlas || !g_renderer || Renderer_GetBackend(g_renderer) != RENDERER_BACKEND_OPENGL ||
+        pw > atlas->page_size || ph > atlas->page_size)
+    {
+        return LoadTextureFromPixels(pixels, width, height);
+    }
+
+    int x = 0;
+    int y = 0;
+    AtlasPage* page = NULL;
+    for (int i = 0; i < atlas->page_count && !page; ++i)
+    {
+        if (SkylineInsert(&atlas->pages[i], atlas->page_size, pw, ph, &x, &y))
+        {
+            page = &atlas->pages[i];
+        }
+    }
+    if (!page)
+    {
+        page = AddPage(atlas);
+        if (!page || !SkylineInsert(page, atlas->page_size, pw, ph, &x, &y))
+        {
+            dbg_msg("Atlas", "Atlas full, loading %dx%d image standalone", width, height);
+            return LoadTextureFromPixels(pixels, width, height);
+        }
+    }
+
+    UploadPadded(page, x, y, pixels, width, height);
+
+    Texture2D* texture = (Texture2D*)calloc(1, sizeof(Texture2D));
+    texture->id = page->texture;
+    texture->width = width;
+    texture->height = height;
+    texture->atlas_x = x + ATLAS_PADDING;
+    texture->atlas_y = y + ATLAS_PADDING;
+    texture->atlas_width = atlas->page_size;
+    texture->atlas_height = atlas->page_size;
+    return texture;
+}
+
+Texture2D* Atlas_LoadTexture(TextureAtlas* atlas, const char* path)
+{
+    // Direct2D draws bitmaps by path, so there is nothing to pack
+    if (!g_renderer || Renderer_GetBackend(g_renderer) != RENDERER_BACKEND_OPENGL)
+    {
+        return LoadTexture(path);
+    }
+
+    int width = 0;
+    int height = 0;
+    unsigned char* pixels = LoadPNGPixels(path, &width, &height);
+    if (!pixels)
+    {
+        return NULL;
+    }
+
+    Texture2D* texture = Atlas_AddPixels(atlas, pixels, width, height);
+    UnloadPNGPixels(pixels);
+    if (texture && path)
+    {
+        strncpy(texture->path, path, sizeof(texture->path) - 1);
+        texture->path[sizeof(texture->path) - 1] = '\0';
+    }
+    return texture;
+}
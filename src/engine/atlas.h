@@ -0,0 +1,49 @@
+#ifndef __FORGE_ATLAS_H__
+#define __FORGE_ATLAS_H__
+
+#include "texture.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define ATLAS_MAX_PAGES 8
+
+typedef struct AtlasSkylineNode
+{
+    int x;
+    int y;
+    int width;
+} AtlasSkylineNode;
+
+typedef struct AtlasPage
+{
+    unsigned int texture;
+    AtlasSkylineNode* skyline;
+    int node_count;
+} AtlasPage;
+
+// Packs sprites into shared RGBA pages with a bottom-left skyline packer so
+// the batcher can draw mixed sprites without rebinding. Space is not reclaimed
+// when a sprite is unloaded; pages are released with the atlas.
+typedef struct TextureAtlas
+{
+    int page_size;
+    int page_count;
+    AtlasPage pages[ATLAS_MAX_PAGES];
+} TextureAtlas;
+
+TextureAtlas* LoadTextureAtlas(int page_size);
+void UnloadTextureAtlas(TextureAtlas* atlas);
+
+// returned textures are released with UnloadTexture; images that do not fit a
+// page, or any image under a non-OpenGL backend, come back as standalone textures
+Texture2D* Atlas_LoadTexture(TextureAtlas* atlas, const char* path);
+Texture2D* Atlas_AddPixels(TextureAtlas* atlas, const unsigned char* pixels, int width, int height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FORGE_ATLAS_H__
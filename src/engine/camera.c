@@ -39,13 +39,7 @@ void BeginCameraMode(Camera2D camera)
         -(right + left) / (right - left), -(top + bottom) / (top - bottom), 0.0f, 1.0f
     };
 
-    glUseProgram(g_renderer->primitive_shader.id);
-    GLint proj_uniform = glGetUniformLocation(g_renderer->primitive_shader.id, "projection");
-    glUniformMatrix4fv(proj_uniform, 1, GL_FALSE, projection);
-
-    glUseProgram(g_renderer->texture_shader.id);
-    proj_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "projection");
-    glUniformMatrix4fv(proj_uniform, 1, GL_FALSE, projection);
+    Renderer_SetProjection(projection);
 }
 
 void EndCameraMode(void)
@@ -78,11 +72,5 @@ void EndCameraMode(void)
         -(right + left) / (right - left), -(top + bottom) / (top - bottom), 0.0f, 1.0f
     };
 
-    glUseProgram(g_renderer->primitive_shader.id);
-    GLint proj_uniform = glGetUniformLocation(g_renderer->primitive_shader.id, "projection");
-    glUniformMatrix4fv(proj_uniform, 1, GL_FALSE, projection);
-
-    glUseProgram(g_renderer->texture_shader.id);
-    proj_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "projection");
-    glUniformMatrix4fv(proj_uniform, 1, GL_FALSE, projection);
+    Renderer_SetProjection(projection);
 }
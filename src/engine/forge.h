@@ -1,14 +1,21 @@
 #ifndef __FORGE_H__
 #define __FORGE_H__
 
+#include "assets.h"
+#include "atlas.h"
 #include "camera.h"
 #include "forgesystem.h"
+#include "framepacer.h"
+#include "glstate.h"
 #include "input.h"
+#include "lighting.h"
 #include "perlin.h"
+#include "profiler.h"
 #include "renderer.h"
 #include "rendertexture.h"
 #include "storage.h"
 #include "timer.h"
+#include "visibility.h"
 #include "window.h"
 #include "worldgen.h"
 
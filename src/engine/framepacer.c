@@ -0,0 +1,165 @@
+#include "framepacer.h"
+#include "forgesystem.h"
+#include "timer.h"
+
+// longest frame fed to the simulation; a stall beyond this is dropped, not replayed
+#define FRAME_PACER_MAX_FRAME_TIME 0.25
+
+// SDL_Delay can overshoot by a scheduler tick, so the last stretch is spun
+#define FRAME_PACER_SPIN_TIME 0.002
+
+static void SleepUntil(double deadline)
+{
+    double remaining = deadline - GetTime();
+    if (remaining > FRAME_PACER_SPIN_TIME)
+    {
+        SDL_Delay((Uint32)((remaining - FRAME_PACER_SPIN_TIME) * 1000.0));
+    }
+    while (GetTime() < deadline)
+    {
+    }
+}
+
+void FramePacer_Init(FramePacer* p, double simulation_hz, double target_fps)
+{
+    p->mode = FRAME_PACING_UNCAPPED;
+    p->target_fps = target_fps > 0.0 ? target_fps : 60.0;
+    p->frame_budget = 1.0 / p->target_fps;
+    p->fixed_step = 1.0 / (simulation_hz > 0.0 ? simulation_hz : 60.0);
+    p->max_steps = 5;
+
+    p->frame_start = 0.0;
+    p->next_frame = 0.0;
+    p->frame_time = 0.0;
+    p->accumulator = 0.0;
+    p->steps = 0;
+}
+
+void FramePacer_SetMode(FramePacer* p, Window* window, FramePacingMode mode)
+{
+    int interval = 0;
+    if (mode == FRAME_PACING_VSYNC)
+    {
+        interval = 1;
+    }
+    else if (mode == FRAME_PACING_ADAPTIVE)
+    {
+        interval = -1;
+    }
+
+    int applied = Window_SetSwapInterval(window, interval);
+    if (interval != 0 && applied == 0)
+    {
+        mode = FRAME_PACING_CAPPED;
+    }
+    else if (interval == -1 && applied == 1)
+    {
+        mode = FRAME_PACING_VSYNC;
+    }
+
+    p->mode = mode;
+    if (mode == FRAME_PACING_VSYNC || mode == FRAME_PACING_ADAPTIVE)
+    {
+        p->frame_budget = 1.0 / (double)Window_GetRefreshRate(window);
+    }
+    else
+    {
+        p->frame_budget = 1.0 / p->target_fps;
+    }
+    p->next_frame = 0.0;
+
+    dbg_msg("FramePacer", "Mode: %s (budget %.2f ms)", FramePacer_GetModeName(mode), p->frame_budget * 1000.0);
+}
+
+const char* FramePacer_GetModeName(FramePacingMode mode)
+{
+    switch (mode)
+    {
+        case FRAME_PACING_VSYNC:    return "VSync";
+        case FRAME_PACING_ADAPTIVE: return "Adaptive";
+        case FRAME_PACING_CAPPED:   return "Capped";
+        case FRAME_PACING_UNCAPPED: return "Uncapped";
+        default:                    return "Unknown";
+    }
+}
+
+void FramePacer_BeginFrame(FramePacer* p)
+{
+    if (p->mode == FRAME_PACING_CAPPED)
+    {
+        double interval = 1.0 / p->target_fps;
+        double now = GetTime();
+        // schedule from the previous deadline so oversleeping does not drift the cap,
+        // but start over once the loop has fallen a whole frame behind
+        if (p->next_frame <= 0.0 || now - p->next_frame > interval)
+        {
+            p->next_frame = now;
+        }
+        SleepUntil(p->next_frame);
+        p->next_frame += interval;
+    }
+
+    double now = GetTime();
+    double dt = p->frame_start > 0.0 ? now - p->frame_start : 0.0;
+    if (dt > FRAME_PACER_MAX_FRAME_TIME)
+    {
+        dt = FRAME_PACER_MAX_FRAME_TIME;
+    }
+
+    p->frame_start = now;
+    p->frame_time = dt;
+    p->accumulator += dt;
+    double backlog = p->fixed_step * (double)p->max_steps;
+    if (p->accumulator > backlog)
+    {
+        p->accumulator = backlog;
+    }
+    p->steps = 0;
+}
+
+int FramePacer_Step(FramePacer* p)
+{
+    if (p->accumulator < p->fixed_step || p->steps >= p->max_steps)
+    {
+        return 0;
+    }
+
+    p->accumulator -= p->fixed_step;
+    p->steps++;
+    return 1;
+}
+
+void FramePacer_Suspend(FramePacer* p)
+{
+    // exactly one step keeps the alpha at 1, so rendering holds the last simulated state
+    p->accumulator = p->fixed_step;
+    p->steps = 0;
+}
+
+float FramePacer_GetStep(const FramePacer* p)
+{
+    return (float)p->fixed_step;
+}
+
+float FramePacer_GetAlpha(const FramePacer* p)
+{
+    double alpha = p->accumulator / p->fixed_step;
+    if (alpha < 0.0) return 0.0f;
+    if (alpha > 1.0) return 1.0f;
+    return (float)alpha;
+}
+
+double FramePacer_GetElapsed(const FramePacer* p)
+{
+    return GetTime() - p->frame_start;
+}
+
+double FramePacer_GetRemaining(const FramePacer* p)
+{
+    return p->frame_budget - FramePacer_GetElapsed(p);
+}
+
+int FramePacer_HasBudget(const FramePacer* p, double seconds)
+{
+    return FramePacer_GetRemaining(p) >= seconds;
+}
@@ -0,0 +1,61 @@
+#ifndef __FORGE_FRAMEPACER_H__
+#define __FORGE_FRAMEPACER_H__
+
+#include "window.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum FramePacingMode
+{
+    FRAME_PACING_VSYNC = 0,
+    FRAME_PACING_ADAPTIVE,
+    FRAME_PACING_CAPPED,
+    FRAME_PACING_UNCAPPED,
+    FRAME_PACING_MODE_COUNT
+} FramePacingMode;
+
+// Paces the client loop and runs the simulation at a fixed rate: each frame
+// drains the elapsed time in fixed steps and leaves an interpolation factor
+// for rendering between the last two simulated states.
+typedef struct FramePacer
+{
+    FramePacingMode mode;
+    double target_fps;      // cap for FRAME_PACING_CAPPED
+    double frame_budget;    // seconds one frame may take at the current mode
+    double fixed_step;
+    int max_steps;          // catch-up limit, older time is dropped
+
+    double frame_start;
+    double next_frame;
+    double frame_time;
+    double accumulator;
+    int steps;
+} FramePacer;
+
+void FramePacer_Init(FramePacer* p, double simulation_hz, double target_fps);
+void FramePacer_SetMode(FramePacer* p, Window* window, FramePacingMode mode);
+const char* FramePacer_GetModeName(FramePacingMode mode);
+
+// Call once at the top of the loop; sleeps off the rest of a capped frame.
+void FramePacer_BeginFrame(FramePacer* p);
+// Returns 1 while another fixed step is due this frame.
+int FramePacer_Step(FramePacer* p);
+// Call instead of stepping on frames the simulation is suspended (menus, pause):
+// the time is dropped rather than replayed as a burst of steps on resume.
+void FramePacer_Suspend(FramePacer* p);
+float FramePacer_GetStep(const FramePacer* p);
+float FramePacer_GetAlpha(const FramePacer* p);
+
+double FramePacer_GetElapsed(const FramePacer* p);
+double FramePacer_GetRemaining(const FramePacer* p);
+// Whether work estimated at `seconds` still fits before the frame is due.
+int FramePacer_HasBudget(const FramePacer* p, double seconds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FORGE_FRAMEPACER_H__
@@ -0,0 +1,170 @@
+#include "glstate.h"
+#include <string.h>
+
+GLState g_glstate =
+{
+    .program = GLSTATE_UNKNOWN,
+    .vao = GLSTATE_UNKNOWN,
+    .texture_2d = GLSTATE_UNKNOWN,
+    .texture_2d_array = GLSTATE_UNKNOWN,
+    .framebuffer = GLSTATE_UNKNOWN,
+    .viewport = { -1, -1, -1, -1 },
+    .blend_src = GLSTATE_UNKNOWN,
+    .blend_dst = GLSTATE_UNKNOWN,
+    .frame = { 0 },
+    .last_frame = { 0 }
+};
+
+void GLState_Invalidate(void)
+{
+    g_glstate.program = GLSTATE_UNKNOWN;
+    g_glstate.vao = GLSTATE_UNKNOWN;
+    g_glstate.texture_2d = GLSTATE_UNKNOWN;
+    g_glstate.texture_2d_array = GLSTATE_UNKNOWN;
+    g_glstate.framebuffer = GLSTATE_UNKNOWN;
+    g_glstate.viewport[0] = -1;
+    g_glstate.viewport[1] = -1;
+    g_glstate.viewport[2] = -1;
+    g_glstate.viewport[3] = -1;
+    g_glstate.blend_src = GLSTATE_UNKNOWN;
+    g_glstate.blend_dst = GLSTATE_UNKNOWN;
+}
+
+void GLState_EndFrame(void)
+{
+    g_glstate.last_frame = g_glstate.frame;
+    memset(&g_glstate.frame, 0, sizeof(g_glstate.frame));
+}
+
+const GLStateStats* GLState_GetFrameStats(void)
+{
+    return &g_glstate.last_frame;
+}
+
+void GLState_UseProgram(GLuint program)
+{
+    if (g_glstate.program == program)
+    {
+        g_glstate.frame.skipped++;
+        return;
+    }
+    glUseProgram(program);
+    g_glstate.program = program;
+    g_glstate.frame.program_changes++;
+}
+
+void GLState_BindVertexArray(GLuint vao)
+{
+    if (g_glstate.vao == vao)
+    {
+        g_glstate.frame.skipped++;
+        return;
+    }
+    glBindVertexArray(vao);
+    g_glstate.vao = vao;
+    g_glstate.frame.vao_changes++;
+}
+
+void GLState_BindTexture(GLenum target, GLuint texture)
+{
+    GLuint* bound = target == GL_TEXTURE_2D_ARRAY ? &g_glstate.texture_2d_array : &g_glstate.texture_2d;
+    if (*bound == texture)
+    {
+        g_glstate.frame.skipped++;
+        return;
+    }
+    glBindTexture(target, texture);
+    *bound = texture;
+    g_glstate.frame.texture_changes++;
+}
+
+void GLState_BindFramebuffer(GLuint framebuffer)
+{
+    if (g_glstate.framebuffer == framebuffer)
+    {
+        g_glstate.frame.skipped++;
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    g_glstate.framebuffer = framebuffer;
+    g_glstate.frame.framebuffer_changes++;
+}
+
+void GLState_Viewport(GLint x, GLint y, GLint width, GLint height)
+{
+    GLint* v = g_glstate.viewport;
+    if (v[0] == x && v[1] == y && v[2] == width && v[3] == height)
+    {
+        g_glstate.frame.skipped++;
+        return;
+    }
+    glViewport(x, y, width, height);
+    g_glstate.frame.viewport_changes++;
+    v[0] = x;
+    v[1] = y;
+    v[2] = width;
+    v[3] = height;
+}
+
+void GLState_BlendFunc(GLenum src, GLenum dst)
+{
+    if (g_glstate.blend_src == src && g_glstate.blend_dst == dst)
+    {
+        g_glstate.frame.skipped++;
+        return;
+    }
+    glBlendFunc(src, dst);
+    g_glstate.blend_src = src;
+    g_glstate.blend_dst = dst;
+    g_glstate.frame.blend_changes++;
+}
+
+void GLState_DeleteProgram(GLuint program)
+{
+    if (g_glstate.program == program)
+    {
+        g_glstate.program = GLSTATE_UNKNOWN;
+    }
+    glDeleteProgram(program);
+}
+
+void GLState_DeleteVertexArray(GLuint vao)
+{
+    if (g_glstate.vao == vao)
+    {
+        g_glstate.vao = 0;
+    }
+    glDeleteVertexArrays(1, &vao);
+}
+
+void GLState_DeleteTexture(GLuint texture)
+{
+    if (g_glstate.texture_2d == texture)
+    {
+        g_glstate.texture_2d = 0;
+    }
+    if (g_glstate.texture_2d_array == texture)
+    {
+        g_glstate.texture_2d_array = 0;
+    }
+    glDeleteTextures(1, &texture);
+}
+
+void GLState_DeleteFramebuffer(GLuint framebuffer)
+{
+    if (g_glstate.framebuffer == framebuffer)
+    {
+        g_glstate.framebuffer = 0;
+    }
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void GLState_CountUniforms(int count)
+{
+    g_glstate.frame.uniform_uploads += count;
+}
+
+void GLState_SkipUniforms(int count)
+{
+    g_glstate.frame.skipped += count;
+}
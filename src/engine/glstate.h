@@ -0,0 +1,73 @@
+#ifndef __FORGE_GLSTATE_H__
+#define __FORGE_GLSTATE_H__
+
+#include <GL/glew.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// never a valid GL name or enum, so the next call after an invalidate always reaches GL
+#define GLSTATE_UNKNOWN 0xFFFFFFFFu
+
+typedef struct GLStateStats
+{
+    int program_changes;
+    int vao_changes;
+    int texture_changes;
+    int framebuffer_changes;
+    int viewport_changes;
+    int blend_changes;
+    int uniform_uploads;
+    int skipped;            // calls that matched the cached state and never reached GL
+} GLStateStats;
+
+// Shadow of the GL binding state the engine touches. Everything in the engine
+// binds through here so redundant binds are dropped; code that changes these
+// bindings behind its back must call GLState_Invalidate. Only texture unit 0
+// is used.
+typedef struct GLState
+{
+    GLuint program;
+    GLuint vao;
+    GLuint texture_2d;
+    GLuint texture_2d_array;
+    GLuint framebuffer;
+    GLint viewport[4];
+    GLenum blend_src;
+    GLenum blend_dst;
+
+    GLStateStats frame;
+    GLStateStats last_frame;
+} GLState;
+
+extern GLState g_glstate;
+
+void GLState_Invalidate(void);
+void GLState_EndFrame(void);
+const GLStateStats* GLState_GetFrameStats(void);
+
+void GLState_UseProgram(GLuint program);
+void GLState_BindVertexArray(GLuint vao);
+void GLState_BindTexture(GLenum target, GLuint texture);
+void GLState_BindFramebuffer(GLuint framebuffer);
+void GLState_Viewport(GLint x, GLint y, GLint width, GLint height);
+void GLState_BlendFunc(GLenum src, GLenum dst);
+
+// GL unbinds deleted objects, and a later object can reuse the name, so
+// deletes go through here as well.
+void GLState_DeleteProgram(GLuint program);
+void GLState_DeleteVertexArray(GLuint vao);
+void GLState_DeleteTexture(GLuint texture);
+void GLState_DeleteFramebuffer(GLuint framebuffer);
+
+// uniforms are cached by their owners, which only report uploads and skips
+void GLState_CountUniforms(int count);
+void GLState_SkipUniforms(int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FORGE_GLSTATE_H__
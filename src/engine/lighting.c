@@ -0,0 +1,251 @@
+#include "lighting.h"
+#include "renderer.h"
+#include "forgesystem.h"
+#include "glstate.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include <GL/glew.h>
+
+typedef struct LightVertex
+{
+    float x, y, radius, intensity;
+    unsigned char r, g, b, a;
+} LightVertex;
+
+static const char* LIGHT_VERT =
+    "#version 460 core\n"
+    "layout(location = 0) in vec2 corner;\n"
+    "layout(location = 1) in vec4 light;\n"
+    "layout(location = 2) in vec4 color;\n"
+    "out vec2 local;\n"
+    "out vec4 tint;\n"
+    "uniform vec2 screen;\n"
+    "void main() {\n"
+    "    local = corner * 2.0 - 1.0;\n"
+    "    vec2 p = light.xy + local * light.z;\n"
+    "    vec2 ndc = p / screen * 2.0 - 1.0;\n"
+    "    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+    "    tint = vec4(color.rgb * light.w, light.w);\n"
+    "}\n";
+
+static const char* LIGHT_FRAG =
+    "#version 460 core\n"
+    "in vec2 local;\n"
+    "in vec4 tint;\n"
+    "out vec4 FragColor;\n"
+    "void main() {\n"
+    "    float f = clamp(1.0 - length(local), 0.0, 1.0);\n"
+    "    f = f * f * (3.0 - 2.0 * f);\n"
+    "    FragColor = tint * f;\n"
+    "}\n";
+
+static const char* COMPOSITE_VERT =
+    "#version 460 core\n"
+    "void main() {\n"
+    "    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+    "    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+// premultiplied output: the warm light color is added where the fog thins out
+static const char* COMPOSITE_FRAG =
+    "#version 460 core\n"
+    "out vec4 FragColor;\n"
+    "uniform sampler2D light_buffer;\n"
+    "uniform vec2 screen;\n"
+    "uniform float darkness;\n"
+    "void main() {\n"
+    "    vec4 l = texture(light_buffer, gl_FragCoord.xy / screen);\n"
+    "    float cover = clamp(l.a, 0.0, 1.0);\n"
+    "    vec3 glow = min(l.rgb, vec3(1.0)) * darkness * 0.2;\n"
+    "    FragColor = vec4(glow, darkness * (1.0 - cover));\n"
+    "}\n";
+
+static unsigned char LightColorByte(float v)
+{
+    if (v <= 0.0f) return 0;
+    if (v >= 1.0f) return 255;
+    return (unsigned char)(v * 255.0f + 0.5f);
+}
+
+static void EnsureBuffer(Lighting* l, int width, int height)
+{
+    if (l->screen_width == width && l->screen_height == height && l->buffer.framebuffer != 0)
+    {
+        return;
+    }
+
+    if (l->buffer.framebuffer != 0)
+    {
+        UnloadRenderTexture(l->buffer);
+    }
+
+    int bw = width / l->downscale;
+    int bh = height / l->downscale;
+    l->buffer = LoadRenderTexture(bw > 0 ? bw : 1, bh > 0 ? bh : 1);
+    l->screen_width = width;
+    l->screen_height = height;
+}
+
+Lighting* LoadLighting(int downscale)
+{
+    Lighting* l = (Lighting*)calloc(1, sizeof(Lighting));
+    if (!l)
+    {
+        return NULL;
+    }
+    l->downscale = downscale > 0 ? downscale : 1;
+
+    if (!g_renderer || Renderer_GetBackend(g_renderer) != RENDERER_BACKEND_OPENGL)
+    {
+        return l;
+    }
+
+    l->light_shader = LoadShaderFromMemory(LIGHT_VERT, LIGHT_FRAG);
+    l->light_screen_uniform = glGetUniformLocation(l->light_shader.id, "screen");
+
+    l->composite_shader = LoadShaderFromMemory(COMPOSITE_VERT, COMPOSITE_FRAG);
+    GLState_UseProgram(l->composite_shader.id);
+    l->composite_screen_uniform = glGetUniformLocation(l->composite_shader.id, "screen");
+    l->composite_darkness_uniform = glGetUniformLocation(l->composite_shader.id, "darkness");
+    glUniform1i(glGetUniformLocation(l->composite_shader.id, "light_buffer"), 0);
+
+    const float corners[12] =
+    {
+        0.0f, 0.0f,  1.0f, 0.0f,  1.0f, 1.0f,
+        0.0f, 0.0f,  1.0f, 1.0f,  0.0f, 1.0f
+    };
+
+    glGenVertexArrays(1, &l->vao);
+    GLState_BindVertexArray(l->vao);
+    glGenBuffers(1, &l->quad_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, l->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    StreamBuffer_Init(&l->instance_stream, GL_ARRAY_BUFFER, LIGHTING_MAX_LIGHTS * sizeof(LightVertex));
+    glBindBuffer(GL_ARRAY_BUFFER, l->instance_stream.buffer);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(LightVertex), (void*)offsetof(LightVertex, x));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(LightVertex), (void*)offsetof(LightVertex, r));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    GLState_BindVertexArray(0);
+
+    EnsureBuffer(l, g_renderer->width, g_renderer->height);
+    return l;
+}
+
+void UnloadLighting(Lighting* l)
+{
+    if (!l)
+    {
+        return;
+    }
+
+    if (l->vao != 0)
+    {
+        if (l->buffer.framebuffer != 0)
+        {
+            UnloadRenderTexture(l->buffer);
+        }
+        StreamBuffer_Destroy(&l->instance_stream);
+        glDeleteBuffers(1, &l->quad_vbo);
+        GLState_DeleteVertexArray(l->vao);
+        UnloadShader(l->light_shader);
+        UnloadShader(l->composite_shader);
+    }
+    free(l);
+}
+
+void Lighting_Begin(Lighting* l)
+{
+    if (l)
+    {
+        l->light_count = 0;
+    }
+}
+
+void Lighting_AddLight(Lighting* l, Vec2 position, float radius, float intensity, Color color)
+{
+    if (!l || l->light_count >= LIGHTING_MAX_LIGHTS || radius <= 0.0f || intensity <= 0.0f)
+    {
+        return;
+    }
+
+    PointLight* light = &l->lights[l->light_count++];
+    light->position = position;
+    light->radius = radius;
+    light->intensity = intensity;
+    light->color = color;
+}
+
+void Lighting_Render(Lighting* l, Camera2D camera, float darkness)
+{
+    if (!l || !g_renderer || darkness <= 0.0f)
+    {
+        return;
+    }
+
+    Renderer* r = g_renderer;
+    if (Renderer_GetBackend(r) != RENDERER_BACKEND_OPENGL || l->vao == 0)
+    {
+        Renderer_DrawRectangle((Rect){ 0.0f, 0.0f, (float)r->width, (float)r->height }, (Color){ 0.0f, 0.0f, 0.0f, darkness });
+        return;
+    }
+
+    EnsureBuffer(l, r->width, r->height);
+
+    GLintptr offset = 0;
+    int count = l->light_count;
+    if (count > 0)
+    {
+        GLsizeiptr bytes = (GLsizeiptr)count * (GLsizeiptr)sizeof(LightVertex);
+        LightVertex* dst = (LightVertex*)StreamBuffer_Map(&l->instance_stream, bytes, sizeof(LightVertex), &offset);
+        if (dst)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                const PointLight* p = &l->lights[i];
+                dst[i].x = (p->position.x - camera.x) * camera.zoom;
+                dst[i].y = (p->position.y - camera.y) * camera.zoom;
+                dst[i].radius = p->radius * camera.zoom;
+                dst[i].intensity = p->intensity;
+                dst[i].r = LightColorByte(p->color.r);
+                dst[i].g = LightColorByte(p->color.g);
+                dst[i].b = LightColorByte(p->color.b);
+                dst[i].a = 255;
+            }
+            StreamBuffer_Unmap(&l->instance_stream, bytes);
+            r->upload_bytes += (size_t)bytes;
+        }
+        else
+        {
+            count = 0;
+        }
+    }
+
+    BeginTextureMode(l->buffer);
+    GLState_BindVertexArray(l->vao);
+    if (count > 0)
+    {
+        GLState_BlendFunc(GL_ONE, GL_ONE);
+        GLState_UseProgram(l->light_shader.id);
+        glUniform2f(l->light_screen_uniform, (float)r->width, (float)r->height);
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, count, (GLuint)(offset / (GLintptr)sizeof(LightVertex)));
+        r->draw_calls++;
+    }
+    EndTextureMode();
+
+    GLState_BlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    GLState_UseProgram(l->composite_shader.id);
+    glUniform2f(l->composite_screen_uniform, (float)r->width, (float)r->height);
+    glUniform1f(l->composite_darkness_uniform, darkness);
+    GLState_BindTexture(GL_TEXTURE_2D, l->buffer.texture.id);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    r->draw_calls++;
+
+    GLState_BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StreamBuffer_EndFrame(&l->instance_stream);
+}
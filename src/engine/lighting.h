@@ -0,0 +1,60 @@
+#ifndef __FORGE_LIGHTING_H__
+#define __FORGE_LIGHTING_H__
+
+#include "camera.h"
+#include "rendertexture.h"
+#include "shader.h"
+#include "streambuffer.h"
+#include "vmath.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define LIGHTING_MAX_LIGHTS 256
+
+typedef struct PointLight
+{
+    Vec2 position;
+    float radius;
+    float intensity;
+    Color color;
+} PointLight;
+
+// Night lighting: point lights are splatted additively into a reduced-size
+// light buffer in one instanced draw, then a fullscreen pass darkens the
+// scene everywhere the buffer is dark.
+typedef struct Lighting
+{
+    RenderTexture buffer;
+    int downscale;
+    int screen_width;
+    int screen_height;
+
+    PointLight lights[LIGHTING_MAX_LIGHTS];
+    int light_count;
+
+    Shader light_shader;
+    Shader composite_shader;
+    GLuint vao;
+    GLuint quad_vbo;
+    StreamBuffer instance_stream;
+    GLint light_screen_uniform;
+    GLint composite_screen_uniform;
+    GLint composite_darkness_uniform;
+} Lighting;
+
+Lighting* LoadLighting(int downscale);
+void UnloadLighting(Lighting* lighting);
+
+void Lighting_Begin(Lighting* lighting);
+void Lighting_AddLight(Lighting* lighting, Vec2 position, float radius, float intensity, Color color);
+// darkness is the fog alpha where no light reaches; positions are in world units
+void Lighting_Render(Lighting* lighting, Camera2D camera, float darkness);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FORGE_LIGHTING_H__
@@ -4,11 +4,18 @@
 #include <math.h>
 #include <stdlib.h>
 
-static int p[512];
+// Permutation table for one seed. Each caller owns its table, so generation
+// can run on several threads at once.
+typedef struct PerlinNoise
+{
+    int p[512];
+} PerlinNoise;
 
-static void Perlin_Init(int seed)
+// The shuffle uses its own LCG (the same sequence as the MSVC CRT rand()) so
+// it neither depends on nor disturbs the global rand() state.
+static void Perlin_Init(PerlinNoise* noise, int seed)
 {
-    srand(seed);
+    unsigned int state = (unsigned int)seed;
 
     int permutation[256];
     for (int i = 0; i < 256; i++)
@@ -16,7 +23,8 @@ static void Perlin_Init(int seed)
 
     for (int i = 255; i > 0; i--)
     {
-        int j = rand() % (i + 1);
+        state = state * 214013u + 2531011u;
+        int j = (int)((state >> 16) & 0x7FFF) % (i + 1);
         int tmp = permutation[i];
         permutation[i] = permutation[j];
         permutation[j] = tmp;
@@ -24,8 +32,8 @@ static void Perlin_Init(int seed)
 
     for (int i = 0; i < 256; i++)
     {
-        p[i] = permutation[i];
-        p[256 + i] = permutation[i];
+        noise->p[i] = permutation[i];
+        noise->p[256 + i] = permutation[i];
     }
 }
 
@@ -51,7 +59,7 @@ static float Grad(int hash, float x, float y)
     }
 }
 
-static float Perlin2D(float x, float y)
+static float Perlin2D(const PerlinNoise* noise, float x, float y)
 {
     int X = (int)floorf(x) & 255;
     int Y = (int)floorf(y) & 255;
@@ -62,6 +70,7 @@ static float Perlin2D(float x, float y)
     float u = Fade(x);
     float v = Fade(y);
 
+    const int* p = noise->p;
     int aa = p[p[X] + Y];
     int ab = p[p[X] + Y + 1];
     int ba = p[p[X + 1] + Y];
@@ -76,7 +85,7 @@ static float Perlin2D(float x, float y)
     return (res + 1.0f) * 0.5f; // 0..1
 }
 
-static inline float FractalPerlin2D(float x, float y, int octaves, float persistence)
+static inline float FractalPerlin2D(const PerlinNoise* noise, float x, float y, int octaves, float persistence)
 {
     float total = 0.0f;
     float frequency = 1.0f;
@@ -85,7 +94,7 @@ static inline float FractalPerlin2D(float x, float y, int octaves, float persist
 
     for (int i = 0; i < octaves; i++)
     {
-        total += Perlin2D(x * frequency, y * frequency) * amplitude;
+        total += Perlin2D(noise, x * frequency, y * frequency) * amplitude;
         maxValue += amplitude;
 
         amplitude *= persistence;
@@ -0,0 +1,526 @@
+#include "profiler.h"
+#include "renderer.h"
+#include "glstate.h"
+#include "forgesystem.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the graph tops out at two 60 Hz frames
+#define PROFILER_GRAPH_RANGE (1.0 / 30.0)
+#define PROFILER_GRAPH_BAR_WIDTH 2.0f
+#define PROFILER_LEGEND_SIZE 8
+#define PROFILER_AVERAGE_FRAMES 60
+
+// frame_index stays -1 until the first Profiler_BeginFrame, so scopes are no-ops before then
+Profiler g_profiler = { .frame_index = -1 };
+
+static const Color PROFILER_COLORS[PROFILER_LEGEND_SIZE] =
+{
+    {0.30f, 0.65f, 1.00f, 1.0f},
+    {1.00f, 0.60f, 0.20f, 1.0f},
+    {0.40f, 0.90f, 0.40f, 1.0f},
+    {0.95f, 0.35f, 0.45f, 1.0f},
+    {0.75f, 0.50f, 1.00f, 1.0f},
+    {1.00f, 0.90f, 0.30f, 1.0f},
+    {0.30f, 0.90f, 0.85f, 1.0f},
+    {0.95f, 0.55f, 0.85f, 1.0f}
+};
+
+static ProfilerFrame* CurrentFrame(Profiler* p)
+{
+    return &p->frames[p->frame_index % PROFILER_MAX_FRAMES];
+}
+
+static int GpuAvailable(const Profiler* p)
+{
+    return p->gpu_supported && g_renderer && Renderer_GetBackend(g_renderer) == RENDERER_BACKEND_OPENGL;
+}
+
+static void ResolveQueries(Profiler* p)
+{
+    if (!p->gpu_supported)
+    {
+        return;
+    }
+
+    for (int s = 0; s < PROFILER_QUERY_FRAMES; ++s)
+    {
+        ProfilerQuerySet* set = &p->query_sets[s];
+        if (set->frame < 0)
+        {
+            continue;
+        }
+        if (set->count == 0)
+        {
+            set->frame = -1;
+            continue;
+        }
+
+        GLint available = 0;
+        glGetQueryObjectiv(set->queries[set->count * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            continue;
+        }
+
+        ProfilerFrame* frame = NULL;
+        if (p->frame_index - set->frame < PROFILER_MAX_FRAMES)
+        {
+            frame = &p->frames[set->frame % PROFILER_MAX_FRAMES];
+        }
+        for (int i = 0; i < set->count; ++i)
+        {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(set->queries[i * 2], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(set->queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+            if (frame && i < frame->gpu_count)
+            {
+                frame->gpu[i].duration = (double)(end - begin) * 1e-9;
+            }
+        }
+        if (frame)
+        {
+            frame->gpu_resolved = 1;
+        }
+        set->frame = -1;
+        set->count = 0;
+    }
+}
+
+void Profiler_Init(void)
+{
+    memset(&g_profiler, 0, sizeof(g_profiler));
+    g_profiler.frame_index = -1;
+    for (int s = 0; s < PROFILER_QUERY_FRAMES; ++s)
+    {
+        g_profiler.query_sets[s].frame = -1;
+    }
+
+    if (!g_renderer || Renderer_GetBackend(g_renderer) != RENDERER_BACKEND_OPENGL ||
+        !(GLEW_VERSION_3_3 || GLEW_ARB_timer_query))
+    {
+        dbg_msg("Profiler", "GPU timer queries unavailable, recording CPU scopes only");
+        return;
+    }
+
+    for (int s = 0; s < PROFILER_QUERY_FRAMES; ++s)
+    {
+        glGenQueries(PROFILER_MAX_GPU_SCOPES * 2, g_profiler.query_sets[s].queries);
+    }
+    g_profiler.gpu_supported = 1;
+}
+
+void Profiler_Shutdown(void)
+{
+    if (!g_profiler.gpu_supported)
+    {
+        return;
+    }
+
+    for (int s = 0; s < PROFILER_QUERY_FRAMES; ++s)
+    {
+        glDeleteQueries(PROFILER_MAX_GPU_SCOPES * 2, g_profiler.query_sets[s].queries);
+    }
+    g_profiler.gpu_supported = 0;
+}
+
+void Profiler_BeginFrame(void)
+{
+    Profiler* p = &g_profiler;
+    if (p->frame_index >= 0)
+    {
+        if (p->gpu_open)
+        {
+            Profiler_EndGpuScope();
+        }
+        while (p->depth > 0)
+        {
+            Profiler_EndScope();
+        }
+        ProfilerFrame* prev = CurrentFrame(p);
+        prev->duration = GetTime() - prev->start;
+    }
+
+    ResolveQueries(p);
+
+    p->frame_index++;
+    if (p->frame_count < PROFILER_MAX_FRAMES)
+    {
+        p->frame_count++;
+    }
+
+    ProfilerFrame* frame = CurrentFrame(p);
+    frame->start = GetTime();
+    frame->duration = 0.0;
+    frame->cpu_count = 0;
+    frame->gpu_count = 0;
+    frame->gpu_resolved = 0;
+
+    // a set still pending after PROFILER_QUERY_FRAMES frames is dropped rather than waited on
+    ProfilerQuerySet* set = &p->query_sets[p->frame_index % PROFILER_QUERY_FRAMES];
+    set->frame = -1;
+    set->count = 0;
+}
+
+void Profiler_BeginScope(const char* name)
+{
+    Profiler* p = &g_profiler;
+    if (p->frame_index < 0)
+    {
+        return;
+    }
+
+    ProfilerFrame* frame = CurrentFrame(p);
+    int slot = -1;
+    if (frame->cpu_count < PROFILER_MAX_SCOPES && p->depth < PROFILER_MAX_DEPTH)
+    {
+        slot = frame->cpu_count++;
+        ProfilerScope* scope = &frame->cpu[slot];
+        scope->name = name;
+        scope->start = GetTime() - frame->start;
+        scope->duration = 0.0;
+        scope->depth = p->depth;
+    }
+
+    if (p->depth < PROFILER_MAX_DEPTH)
+    {
+        p->stack[p->depth] = slot;
+    }
+    p->depth++;
+}
+
+void Profiler_EndScope(void)
+{
+    Profiler* p = &g_profiler;
+    if (p->depth <= 0)
+    {
+        return;
+    }
+
+    p->depth--;
+    if (p->depth >= PROFILER_MAX_DEPTH || p->stack[p->depth] < 0)
+    {
+        return;
+    }
+
+    ProfilerFrame* frame = CurrentFrame(p);
+    ProfilerScope* scope = &frame->cpu[p->stack[p->depth]];
+    scope->duration = GetTime() - frame->start - scope->start;
+}
+
+void Profiler_SetGpuEnabled(int enabled)
+{
+    g_profiler.gpu_enabled = enabled;
+}
+
+void Profiler_BeginGpuScope(const char* name)
+{
+    Profiler* p = &g_profiler;
+    if (p->frame_index < 0 || !p->gpu_enabled || p->gpu_open || !GpuAvailable(p))
+    {
+        return;
+    }
+
+    ProfilerFrame* frame = CurrentFrame(p);
+    if (frame->gpu_count >= PROFILER_MAX_GPU_SCOPES)
+    {
+        return;
+    }
+
+    ProfilerQuerySet* set = &p->query_sets[p->frame_index % PROFILER_QUERY_FRAMES];
+    set->frame = p->frame_index;
+
+    Renderer_Flush();
+    glQueryCounter(set->queries[frame->gpu_count * 2], GL_TIMESTAMP);
+
+    ProfilerScope* scope = &frame->gpu[frame->gpu_count];
+    scope->name = name;
+    scope->start = GetTime() - frame->start;
+    scope->duration = 0.0;
+    scope->depth = 0;
+    p->gpu_open = 1;
+}
+
+void Profiler_EndGpuScope(void)
+{
+    Profiler* p = &g_profiler;
+    if (!p->gpu_open)
+    {
+        return;
+    }
+    p->gpu_open = 0;
+    if (!GpuAvailable(p))
+    {
+        return;
+    }
+
+    ProfilerFrame* frame = CurrentFrame(p);
+    ProfilerQuerySet* set = &p->query_sets[p->frame_index % PROFILER_QUERY_FRAMES];
+
+    Renderer_Flush();
+    glQueryCounter(set->queries[frame->gpu_count * 2 + 1], GL_TIMESTAMP);
+    frame->gpu_count++;
+    set->count = frame->gpu_count;
+}
+
+const ProfilerFrame* Profiler_GetFrame(int age)
+{
+    const Profiler* p = &g_profiler;
+    // age 0 is the last completed frame
+    if (age < 0 || age >= p->frame_count - 1)
+    {
+        return NULL;
+    }
+    return &p->frames[(p->frame_index - 1 - age) % PROFILER_MAX_FRAMES];
+}
+
+int Profiler_GetFrameCount(void)
+{
+    return g_profiler.frame_count > 0 ? g_profiler.frame_count - 1 : 0;
+}
+
+static int CompareDescending(const void* a, const void* b)
+{
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da < db) - (da > db);
+}
+
+double Profiler_GetLowFrameTime(double fraction)
+{
+    static double durations[PROFILER_MAX_FRAMES];
+    int count = Profiler_GetFrameCount();
+    if (count == 0)
+    {
+        return 0.0;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        durations[i] = Profiler_GetFrame(i)->duration;
+    }
+    qsort(durations, (size_t)count, sizeof(double), CompareDescending);
+
+    int worst = (int)((double)count * fraction);
+    if (worst < 1)
+    {
+        worst = 1;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < worst; ++i)
+    {
+        sum += durations[i];
+    }
+    return sum / (double)worst;
+}
+
+static int LegendIndex(const char** legend, int legend_count, const char* name)
+{
+    for (int i = 0; i < legend_count; ++i)
+    {
+        if (legend[i] == name || strcmp(legend[i], name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void Profiler_DrawOverlay(float x, float y, float width, float height)
+{
+    const ProfilerFrame* latest = Profiler_GetFrame(0);
+    if (!latest)
+    {
+        return;
+    }
+
+    // colors follow the top-level scopes of the latest frame
+    const char* legend[PROFILER_LEGEND_SIZE];
+    double legend_time[PROFILER_LEGEND_SIZE] = { 0.0 };
+    int legend_count = 0;
+    for (int i = 0; i < latest->cpu_count && legend_count < PROFILER_LEGEND_SIZE; ++i)
+    {
+        if (latest->cpu[i].depth == 0 && LegendIndex(legend, legend_count, latest->cpu[i].name) < 0)
+        {
+            legend[legend_count++] = latest->cpu[i].name;
+        }
+    }
+
+    float graph_h = height * 0.55f;
+    float graph_y = y + height - graph_h;
+    Renderer_DrawRectangle((Rect){ x, y, width, height }, (Color){ 0.0f, 0.0f, 0.0f, 0.65f });
+
+    int bars = (int)(width / PROFILER_GRAPH_BAR_WIDTH);
+    float scale = graph_h / (float)PROFILER_GRAPH_RANGE;
+    for (int age = 0; age < bars; ++age)
+    {
+        const ProfilerFrame* frame = Profiler_GetFrame(age);
+        if (!frame)
+        {
+            break;
+        }
+
+        float bx = x + width - (float)(age + 1) * PROFILER_GRAPH_BAR_WIDTH;
+        float bottom = graph_y + graph_h;
+        double stacked = 0.0;
+        for (int i = 0; i < frame->cpu_count; ++i)
+        {
+            const ProfilerScope* scope = &frame->cpu[i];
+            if (scope->depth != 0)
+            {
+                continue;
+            }
+            int index = LegendIndex(legend, legend_count, scope->name);
+            if (index < 0)
+            {
+                continue;
+            }
+            if (age < PROFILER_AVERAGE_FRAMES)
+            {
+                legend_time[index] += scope->duration;
+            }
+
+            float h = (float)scope->duration * scale;
+            if (bottom - h < graph_y)
+            {
+                h = bottom - graph_y;
+            }
+            Renderer_DrawRectangle((Rect){ bx, bottom - h, PROFILER_GRAPH_BAR_WIDTH, h }, PROFILER_COLORS[index]);
+            bottom -= h;
+            stacked += scope->duration;
+        }
+
+        // time outside any top-level scope
+        double rest = frame->duration - stacked;
+        if (rest > 0.0)
+        {
+            float h = (float)rest * scale;
+            if (bottom - h < graph_y)
+            {
+                h = bottom - graph_y;
+            }
+            Renderer_DrawRectangle((Rect){ bx, bottom - h, PROFILER_GRAPH_BAR_WIDTH, h }, (Color){ 0.5f, 0.5f, 0.5f, 1.0f });
+        }
+    }
+
+    float line_60 = graph_y + graph_h - (float)(1.0 / 60.0) * scale;
+    Renderer_DrawRectangle((Rect){ x, line_60, width, 1.0f }, (Color){ 1.0f, 1.0f, 1.0f, 0.5f });
+    Renderer_DrawRectangle((Rect){ x, graph_y, width, 1.0f }, (Color){ 1.0f, 0.3f, 0.3f, 0.5f });
+
+    int frames = Profiler_GetFrameCount();
+    int averaged = frames < PROFILER_AVERAGE_FRAMES ? frames : PROFILER_AVERAGE_FRAMES;
+    double average = 0.0;
+    for (int i = 0; i < averaged; ++i)
+    {
+        average += Profiler_GetFrame(i)->duration;
+    }
+    average = averaged > 0 ? average / (double)averaged : 0.0;
+    double low_1 = Profiler_GetLowFrameTime(0.01);
+    double low_01 = Profiler_GetLowFrameTime(0.001);
+
+    char text[256];
+    snprintf(text, sizeof(text), "Frame %.2f ms (%.0f fps)  1%% low %.0f fps  0.1%% low %.0f fps",
+             average * 1000.0, average > 0.0 ? 1.0 / average : 0.0,
+             low_1 > 0.0 ? 1.0 / low_1 : 0.0, low_01 > 0.0 ? 1.0 / low_01 : 0.0);
+    Renderer_DrawTextEx(text, x + 6.0f, y + 4.0f, 14.0f, (Color){ 1.0f, 1.0f, 1.0f, 1.0f }, TEXT_STYLE_SHADOW);
+
+    float column_w = width / 4.0f;
+    for (int i = 0; i < legend_count; ++i)
+    {
+        float lx = x + 6.0f + (float)(i % 4) * column_w;
+        float ly = y + 24.0f + (float)(i / 4) * 18.0f;
+        Renderer_DrawRectangle((Rect){ lx, ly + 3.0f, 10.0f, 10.0f }, PROFILER_COLORS[i]);
+        snprintf(text, sizeof(text), "%s %.2f", legend[i],
+                 averaged > 0 ? legend_time[i] * 1000.0 / (double)averaged : 0.0);
+        Renderer_DrawTextEx(text, lx + 14.0f, ly, 13.0f, (Color){ 1.0f, 1.0f, 1.0f, 1.0f }, TEXT_STYLE_SHADOW);
+    }
+
+    // GPU results lag behind, so show the newest frame that has resolved
+    const ProfilerFrame* gpu_frame = NULL;
+    for (int age = 0; age < PROFILER_QUERY_FRAMES * 2 && !gpu_frame; ++age)
+    {
+        const ProfilerFrame* frame = Profiler_GetFrame(age);
+        if (!frame)
+        {
+            break;
+        }
+        if (frame->gpu_resolved)
+        {
+            gpu_frame = frame;
+        }
+    }
+
+    int len = 0;
+    if (gpu_frame)
+    {
+        len = snprintf(text, sizeof(text), "GPU:");
+        for (int i = 0; i < gpu_frame->gpu_count && len < (int)sizeof(text); ++i)
+        {
+            len += snprintf(text + len, sizeof(text) - (size_t)len, "  %s %.2f",
+                            gpu_frame->gpu[i].name, gpu_frame->gpu[i].duration * 1000.0);
+        }
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%s", g_profiler.gpu_supported ? "GPU: waiting for queries" : "GPU: timer queries unavailable");
+    }
+    float line_y = y + 24.0f + (float)((legend_count + 3) / 4) * 18.0f;
+    Renderer_DrawTextEx(text, x + 6.0f, line_y, 13.0f, (Color){ 0.8f, 0.9f, 1.0f, 1.0f }, TEXT_STYLE_SHADOW);
+
+    const GLStateStats* gl = GLState_GetFrameStats();
+    snprintf(text, sizeof(text), "GL: prog %d  vao %d  tex %d  fbo %d  viewport %d  blend %d  uniforms %d  skipped %d",
+             gl->program_changes, gl->vao_changes, gl->texture_changes, gl->framebuffer_changes,
+             gl->viewport_changes, gl->blend_changes, gl->uniform_uploads, gl->skipped);
+    Renderer_DrawTextEx(text, x + 6.0f, line_y + 18.0f, 13.0f, (Color){ 0.8f, 0.9f, 1.0f, 1.0f }, TEXT_STYLE_SHADOW);
+}
+
+int Profiler_ExportTrace(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+    {
+        dbg_msg("Profiler", "Failed to open trace file: %s", path);
+        return 0;
+    }
+
+    // Chrome trace format: complete events in microseconds; GPU passes go on
+    // their own track at the time they were issued
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+    int frames = Profiler_GetFrameCount();
+    for (int age = frames - 1; age >= 0; --age)
+    {
+        const ProfilerFrame* frame = Profiler_GetFrame(age);
+        double base = frame->start * 1e6;
+        fprintf(file, ",\n{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                base, frame->duration * 1e6);
+        for (int i = 0; i < frame->cpu_count; ++i)
+        {
+            const ProfilerScope* scope = &frame->cpu[i];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                    scope->name, base + scope->start * 1e6, scope->duration * 1e6);
+        }
+        if (!frame->gpu_resolved)
+        {
+            continue;
+        }
+        for (int i = 0; i < frame->gpu_count; ++i)
+        {
+            const ProfilerScope* scope = &frame->gpu[i];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+                    scope->name, base + scope->start * 1e6, scope->duration * 1e6);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    dbg_msg("Profiler", "Trace written: %s (%d frames)", path, frames);
+    return 1;
+}
@@ -0,0 +1,91 @@
+#ifndef __FORGE_PROFILER_H__
+#define __FORGE_PROFILER_H__
+
+#include "vmath.h"
+#include <GL/glew.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PROFILER_MAX_FRAMES 1024
+#define PROFILER_MAX_SCOPES 24
+#define PROFILER_MAX_GPU_SCOPES 8
+#define PROFILER_MAX_DEPTH 8
+// GPU results are read back this many frames late so the CPU never waits on a query
+#define PROFILER_QUERY_FRAMES 4
+
+// Times are seconds; scope starts are relative to the frame start.
+typedef struct ProfilerScope
+{
+    const char* name;
+    double start;
+    double duration;
+    int depth;
+} ProfilerScope;
+
+typedef struct ProfilerFrame
+{
+    double start;
+    double duration;
+    ProfilerScope cpu[PROFILER_MAX_SCOPES];
+    int cpu_count;
+    ProfilerScope gpu[PROFILER_MAX_GPU_SCOPES];
+    int gpu_count;      // scopes issued; durations are filled once their queries resolve
+    int gpu_resolved;
+} ProfilerFrame;
+
+typedef struct ProfilerQuerySet
+{
+    GLuint queries[PROFILER_MAX_GPU_SCOPES * 2];
+    int frame;          // frame index the set was issued in, -1 when idle
+    int count;
+} ProfilerQuerySet;
+
+// Frame profiler: scoped CPU timers and GL timestamp queries recorded into a
+// ring of the last PROFILER_MAX_FRAMES frames.
+typedef struct Profiler
+{
+    ProfilerFrame frames[PROFILER_MAX_FRAMES];
+    int frame_index;    // absolute index of the frame being recorded
+    int frame_count;    // frames recorded since Profiler_Init
+
+    int stack[PROFILER_MAX_DEPTH];
+    int depth;
+    int gpu_open;
+
+    int gpu_supported;
+    int gpu_enabled;
+    ProfilerQuerySet query_sets[PROFILER_QUERY_FRAMES];
+} Profiler;
+
+extern Profiler g_profiler;
+
+void Profiler_Init(void);
+void Profiler_Shutdown(void);
+
+// Closes the previous frame and starts recording the next one.
+void Profiler_BeginFrame(void);
+void Profiler_BeginScope(const char* name);
+void Profiler_EndScope(void);
+
+// GPU scopes flush the renderer batch at both ends, so they only record while
+// GPU timing is enabled; they must not nest.
+void Profiler_SetGpuEnabled(int enabled);
+void Profiler_BeginGpuScope(const char* name);
+void Profiler_EndGpuScope(void);
+
+const ProfilerFrame* Profiler_GetFrame(int age);
+int  Profiler_GetFrameCount(void);
+// Average frame time of the slowest `fraction` of recorded frames (0.01 = 1% low).
+double Profiler_GetLowFrameTime(double fraction);
+
+void Profiler_DrawOverlay(float x, float y, float width, float height);
+int  Profiler_ExportTrace(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FORGE_PROFILER_H__
@@ -1,7 +1,9 @@
 #include "renderer.h"
 #include "forgesystem.h"
+#include "glstate.h"
 #include "renderer_d2d.h"
 #include <stdlib.h>
+#include <stddef.h>
 #include <GL/glew.h>
 #include <png.h>
 #include <stdio.h>
@@ -175,87 +177,160 @@ static Shader CreateShader(const char* vert_src, const char* frag_src)
     return shader;
 }
 
-const char* PRIMITIVE_VERT = 
+Shader LoadShaderFromMemory(const char* vert_src, const char* frag_src)
+{
+    return CreateShader(vert_src, frag_src);
+}
+
+void UnloadShader(Shader shader)
+{
+    if (shader.id != 0)
+    {
+        GLState_DeleteProgram(shader.id);
+    }
+}
+
+#define BATCH_MAX_VERTICES 8192
+#define BATCH_MAX_QUADS (BATCH_MAX_VERTICES / 4)
+#define INSTANCE_MAX_PER_DRAW 4096
+
+typedef struct InstanceVertex
+{
+    float x, y, w, h;
+    float rotation, layer;
+    unsigned char r, g, b, a;
+} InstanceVertex;
+
+const char* BATCH_VERT =
     "#version 460 core\n"
     "layout(location = 0) in vec2 position;\n"
-    "layout(location = 1) in vec4 color;\n"
+    "layout(location = 1) in vec2 texCoord;\n"
+    "layout(location = 2) in vec4 color;\n"
     "out VS_OUT {\n"
+    "    vec2 texCoord;\n"
     "    vec4 color;\n"
     "} vs_out;\n"
     "uniform mat4 projection;\n"
     "void main() {\n"
     "    gl_Position = projection * vec4(position, 0.0, 1.0);\n"
+    "    vs_out.texCoord = texCoord;\n"
     "    vs_out.color = color;\n"
     "}\n";
 
-const char* PRIMITIVE_FRAG = 
+const char* BATCH_FRAG =
     "#version 460 core\n"
     "in VS_OUT {\n"
+    "    vec2 texCoord;\n"
     "    vec4 color;\n"
     "} fs_in;\n"
     "out vec4 FragColor;\n"
+    "uniform sampler2D tex_sampler;\n"
     "void main() {\n"
-    "    FragColor = fs_in.color;\n"
+    "    FragColor = texture(tex_sampler, fs_in.texCoord) * fs_in.color;\n"
     "}\n";
 
-const char* TEXTURE_VERT = 
+// Glyphs are signed distance fields (0.5 on the edge). Outline and shadow are
+// resolved per fragment: the outline is a lower distance threshold, which
+// with the spread at size/8 and the outline at size/12 sits at 0.5 - 1/3, and
+// the shadow is one extra tap 'radius' atlas texels up and to the left.
+const char* TEXT_FRAG =
     "#version 460 core\n"
-    "layout(location = 0) in vec2 position;\n"
-    "layout(location = 1) in vec2 texCoord;\n"
-    "layout(location = 2) in vec4 color;\n"
-    "out VS_OUT {\n"
+    "in VS_OUT {\n"
     "    vec2 texCoord;\n"
     "    vec4 color;\n"
+    "} fs_in;\n"
+    "out vec4 FragColor;\n"
+    "uniform sampler2D tex_sampler;\n"
+    "uniform int style;\n"
+    "uniform float radius;\n"
+    "const float OUTLINE_EDGE = 0.5 - 1.0 / 3.0;\n"
+    "vec4 over(vec4 top, vec4 bottom) {\n"
+    "    float a = top.a + bottom.a * (1.0 - top.a);\n"
+    "    vec3 rgb = top.rgb * top.a + bottom.rgb * bottom.a * (1.0 - top.a);\n"
+    "    return vec4(a > 0.0 ? rgb / a : vec3(0.0), a);\n"
+    "}\n"
+    "void main() {\n"
+    "    float d = texture(tex_sampler, fs_in.texCoord).a;\n"
+    "    float w = max(fwidth(d) * 0.75, 0.001);\n"
+    "    float fill = smoothstep(0.5 - w, 0.5 + w, d);\n"
+    "    vec4 result = vec4(fs_in.color.rgb, fs_in.color.a * fill);\n"
+    "    if ((style & 2) != 0) {\n"
+    "        float edge = smoothstep(OUTLINE_EDGE - w, OUTLINE_EDGE + w, d);\n"
+    "        result = over(result, vec4(0.0, 0.0, 0.0, 0.75 * edge * fs_in.color.a));\n"
+    "    }\n"
+    "    if ((style & 1) != 0) {\n"
+    "        vec2 texel = radius / vec2(textureSize(tex_sampler, 0));\n"
+    "        float sd = texture(tex_sampler, fs_in.texCoord - texel).a;\n"
+    "        float shadow = smoothstep(0.5 - w, 0.5 + w, sd);\n"
+    "        result = over(result, vec4(0.0, 0.0, 0.0, 0.65 * shadow * fs_in.color.a));\n"
+    "    }\n"
+    "    FragColor = result;\n"
+    "}\n";
+
+const char* TILEMAP_VERT =
+    "#version 460 core\n"
+    "layout(location = 0) in vec2 corner;\n"
+    "out VS_OUT {\n"
+    "    vec2 tileCoord;\n"
     "} vs_out;\n"
     "uniform mat4 projection;\n"
-    "uniform mat4 transform;\n"
+    "uniform vec4 dest;\n"
+    "uniform vec2 map_size;\n"
     "void main() {\n"
-    "    gl_Position = projection * transform * vec4(position, 0.0, 1.0);\n"
-    "    vs_out.texCoord = texCoord;\n"
-    "    vs_out.color = color;\n"
+    "    gl_Position = projection * vec4(dest.xy + corner * dest.zw, 0.0, 1.0);\n"
+    "    vs_out.tileCoord = corner * map_size;\n"
     "}\n";
 
-const char* TEXTURE_FRAG = 
+const char* TILEMAP_FRAG =
     "#version 460 core\n"
     "in VS_OUT {\n"
-    "    vec2 texCoord;\n"
-    "    vec4 color;\n"
+    "    vec2 tileCoord;\n"
     "} fs_in;\n"
     "out vec4 FragColor;\n"
-    "uniform sampler2D tex_sampler;\n"
+    "uniform usampler2D tiles;\n"
+    "uniform vec4 palette[16];\n"
     "void main() {\n"
-    "    vec4 tex_color = texture(tex_sampler, fs_in.texCoord);\n"
-    "    FragColor = tex_color * fs_in.color;\n"
+    "    ivec2 size = textureSize(tiles, 0);\n"
+    "    ivec2 cell = clamp(ivec2(floor(fs_in.tileCoord)), ivec2(0), size - 1);\n"
+    "    uint id = texelFetch(tiles, cell, 0).r;\n"
+    "    vec4 color = palette[min(id, 15u)];\n"
+    "    if (color.a <= 0.0) discard;\n"
+    "    FragColor = color;\n"
     "}\n";
 
-const char* TEXT_VERT =
+const char* INSTANCE_VERT =
     "#version 460 core\n"
-    "layout(location = 0) in vec2 position;\n"
-    "layout(location = 1) in vec2 texCoord;\n"
-    "layout(location = 2) in vec4 color;\n"
+    "layout(location = 0) in vec2 corner;\n"
+    "layout(location = 1) in vec4 rect;\n"
+    "layout(location = 2) in vec2 params;\n"
+    "layout(location = 3) in vec4 color;\n"
     "out VS_OUT {\n"
-    "    vec2 texCoord;\n"
+    "    vec3 texCoord;\n"
     "    vec4 color;\n"
     "} vs_out;\n"
     "uniform mat4 projection;\n"
-    "uniform mat4 transform;\n"
     "void main() {\n"
-    "    gl_Position = projection * transform * vec4(position, 0.0, 1.0);\n"
-    "    vs_out.texCoord = texCoord;\n"
+    "    vec2 local = (corner - 0.5) * rect.zw;\n"
+    "    float c = cos(params.x);\n"
+    "    float s = sin(params.x);\n"
+    "    vec2 p = rect.xy + vec2(c * local.x - s * local.y, s * local.x + c * local.y);\n"
+    "    gl_Position = projection * vec4(p, 0.0, 1.0);\n"
+    "    vs_out.texCoord = vec3(corner, params.y);\n"
     "    vs_out.color = color;\n"
     "}\n";
 
-const char* TEXT_FRAG =
+const char* INSTANCE_FRAG =
     "#version 460 core\n"
     "in VS_OUT {\n"
-    "    vec2 texCoord;\n"
+    "    vec3 texCoord;\n"
     "    vec4 color;\n"
     "} fs_in;\n"
     "out vec4 FragColor;\n"
-    "uniform sampler2D tex_sampler;\n"
+    "uniform sampler2DArray layers;\n"
+    "uniform int textured;\n"
     "void main() {\n"
-    "    float a = texture(tex_sampler, fs_in.texCoord).a;\n"
-    "    FragColor = vec4(fs_in.color.rgb, fs_in.color.a * a);\n"
+    "    vec4 base = textured != 0 ? texture(layers, fs_in.texCoord) : vec4(1.0);\n"
+    "    FragColor = base * fs_in.color;\n"
     "}\n";
 
 static void OrthoMatrix(float left, float right, float bottom, float top, float* out)
@@ -269,13 +344,220 @@ static void OrthoMatrix(float left, float right, float bottom, float top, float*
     out[15] = 1.0f;
 }
 
-static void IdentityMatrix(float* out)
+// Binds a program and brings its projection up to date; programs that missed
+// projection changes upload only the latest matrix.
+static void UseProgramWithProjection(Renderer* r, GLuint program, GLint proj_uniform, unsigned int* version)
 {
-    memset(out, 0, 16 * sizeof(float));
-    out[0] = out[5] = out[10] = out[15] = 1.0f;
+    GLState_UseProgram(program);
+    if (*version == r->projection_version)
+    {
+        GLState_SkipUniforms(1);
+        return;
+    }
+    glUniformMatrix4fv(proj_uniform, 1, GL_FALSE, r->projection);
+    GLState_CountUniforms(1);
+    *version = r->projection_version;
 }
 
-Texture2D* LoadTexture(const char* path)
+// Every OpenGL draw lands in one interleaved RendererVertex stream. Triangle
+// geometry is stored as quads of 4 vertices drawn through a shared static index
+// buffer; a lone triangle repeats its last vertex. The batch is submitted when
+// the texture, primitive mode or line width changes, when it fills up, and
+// before anything that changes GL state behind its back.
+static void FlushBatch(Renderer* r)
+{
+    if (!r || r->batch_count == 0)
+    {
+        return;
+    }
+
+    GLsizeiptr stride = sizeof(RendererVertex);
+    GLsizeiptr bytes = (GLsizeiptr)r->batch_count * stride;
+    GLintptr offset = StreamBuffer_Upload(&r->batch_stream, r->batch_vertices, bytes, stride);
+    if (offset < 0)
+    {
+        r->batch_count = 0;
+        return;
+    }
+    r->upload_bytes += (size_t)bytes;
+    GLint first = (GLint)(offset / stride);
+
+    GLState_BindVertexArray(r->batch_vao);
+    if (r->batch_text_style >= 0)
+    {
+        UseProgramWithProjection(r, r->text_shader.id, r->text_proj_uniform, &r->text_proj_version);
+        if (r->text_style_value != r->batch_text_style)
+        {
+            glUniform1i(r->text_style_uniform, r->batch_text_style);
+            r->text_style_value = r->batch_text_style;
+            GLState_CountUniforms(1);
+        }
+        else
+        {
+            GLState_SkipUniforms(1);
+        }
+        if (r->text_radius_value != r->batch_text_radius)
+        {
+            glUniform1f(r->text_radius_uniform, r->batch_text_radius);
+            r->text_radius_value = r->batch_text_radius;
+            GLState_CountUniforms(1);
+        }
+        else
+        {
+            GLState_SkipUniforms(1);
+        }
+    }
+    else
+    {
+        UseProgramWithProjection(r, r->batch_shader.id, r->proj_uniform, &r->batch_proj_version);
+    }
+    GLState_BindTexture(GL_TEXTURE_2D, r->batch_texture);
+
+    r->draw_calls++;
+    if (r->batch_mode == GL_LINES)
+    {
+        glLineWidth(r->batch_line_width);
+        glDrawArrays(GL_LINES, first, r->batch_count);
+        glLineWidth(1.0f);
+    }
+    else
+    {
+        glDrawElementsBaseVertex(GL_TRIANGLES, (r->batch_count / 4) * 6, GL_UNSIGNED_SHORT, (void*)0, first);
+    }
+
+    r->batch_count = 0;
+}
+
+// text_style is -1 for regular geometry; text runs select the text shader
+static RendererVertex* BatchReserveStyled(GLenum mode, GLuint texture, float line_width, int text_style, float text_radius, int count)
+{
+    Renderer* r = g_renderer;
+    if (!r || !r->batch_vertices || count <= 0 || count > BATCH_MAX_VERTICES)
+    {
+        return NULL;
+    }
+
+    if (r->batch_count > 0 &&
+        (r->batch_mode != mode ||
+         r->batch_texture != texture ||
+         (mode == GL_LINES && r->batch_line_width != line_width) ||
+         r->batch_text_style != text_style ||
+         (text_style >= 0 && r->batch_text_radius != text_radius) ||
+         r->batch_count + count > BATCH_MAX_VERTICES))
+    {
+        FlushBatch(r);
+    }
+
+    r->batch_mode = mode;
+    r->batch_texture = texture;
+    r->batch_line_width = line_width;
+    r->batch_text_style = text_style;
+    r->batch_text_radius = text_radius;
+
+    RendererVertex* out = r->batch_vertices + r->batch_count;
+    r->batch_count += count;
+    return out;
+}
+
+static RendererVertex* BatchReserve(GLenum mode, GLuint texture, float line_width, int count)
+{
+    return BatchReserveStyled(mode, texture, line_width, -1, 0.0f, count);
+}
+
+static unsigned char ColorByte(float v)
+{
+    if (v <= 0.0f) return 0;
+    if (v >= 1.0f) return 255;
+    return (unsigned char)(v * 255.0f + 0.5f);
+}
+
+static RendererVertex* BatchVertex(RendererVertex* out, float x, float y, float u, float v, Color c)
+{
+    out->x = x;
+    out->y = y;
+    out->u = u;
+    out->v = v;
+    out->r = ColorByte(c.r);
+    out->g = ColorByte(c.g);
+    out->b = ColorByte(c.b);
+    out->a = ColorByte(c.a);
+    return out + 1;
+}
+
+// corners are top-left, top-right, bottom-right, bottom-left
+static void BatchQuad(GLuint texture, const Vec2* corners, float u1, float v1, float u2, float v2, Color c)
+{
+    RendererVertex* v = BatchReserve(GL_TRIANGLES, texture, 1.0f, 4);
+    if (!v)
+    {
+        return;
+    }
+    v = BatchVertex(v, corners[0].x, corners[0].y, u1, v1, c);
+    v = BatchVertex(v, corners[1].x, corners[1].y, u2, v1, c);
+    v = BatchVertex(v, corners[2].x, corners[2].y, u2, v2, c);
+    BatchVertex(v, corners[3].x, corners[3].y, u1, v2, c);
+}
+
+static void BatchRect(GLuint texture, Rect rect, float u1, float v1, float u2, float v2, Color c)
+{
+    Vec2 corners[4] =
+    {
+        { rect.x, rect.y },
+        { rect.x + rect.width, rect.y },
+        { rect.x + rect.width, rect.y + rect.height },
+        { rect.x, rect.y + rect.height }
+    };
+    BatchQuad(texture, corners, u1, v1, u2, v2, c);
+}
+
+static void RotateCorners(Vec2* corners, float cx, float cy, float rotation)
+{
+    float cos_a = cosf(rotation);
+    float sin_a = sinf(rotation);
+    for (int i = 0; i < 4; ++i)
+    {
+        float dx = corners[i].x - cx;
+        float dy = corners[i].y - cy;
+        corners[i].x = cx + cos_a * dx - sin_a * dy;
+        corners[i].y = cy + sin_a * dx + cos_a * dy;
+    }
+}
+
+void Renderer_Flush(void)
+{
+    if (!g_renderer || IsD2DBackend(g_renderer))
+    {
+        return;
+    }
+    FlushBatch(g_renderer);
+}
+
+size_t Renderer_GetFrameUploadBytes(void)
+{
+    return g_renderer ? g_renderer->upload_bytes_last_frame : 0;
+}
+
+int Renderer_GetFrameDrawCalls(void)
+{
+    return g_renderer ? g_renderer->draw_calls_last_frame : 0;
+}
+
+void Renderer_SetProjection(const float* projection)
+{
+    if (!g_renderer || !projection)
+    {
+        return;
+    }
+    if (memcmp(g_renderer->projection, projection, sizeof(g_renderer->projection)) == 0)
+    {
+        return;
+    }
+    FlushBatch(g_renderer);
+    memcpy(g_renderer->projection, projection, sizeof(g_renderer->projection));
+    g_renderer->projection_version++;
+}
+
+unsigned char* LoadPNGPixels(const char* path, int* out_width, int* out_height)
 {
     FILE* fp = fopen(path, "rb");
     if (fp == NULL)
@@ -308,10 +590,13 @@ Texture2D* LoadTexture(const char* path)
         return NULL;
     }
 
+    // volatile so the pointer survives the longjmp back here on a decode error
+    png_byte* volatile data = NULL;
     if (setjmp(png_jmpbuf(png_ptr)))
     {
         png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
         fclose(fp);
+        free(data);
         return NULL;
     }
 
@@ -357,45 +642,82 @@ Texture2D* LoadTexture(const char* path)
         png_set_gray_to_rgb(png_ptr);
     }
 
+    int passes = png_set_interlace_handling(png_ptr);
     png_read_update_info(png_ptr, info_ptr);
 
-    png_bytep* row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * height);
-    for (png_uint_32 y = 0; y < height; ++y)
+    // every transform above ends at 8-bit RGBA, so rows decode straight into
+    // the one output allocation
+    size_t stride = (size_t)width * 4;
+    if (png_get_rowbytes(png_ptr, info_ptr) != stride)
     {
-        row_pointers[y] = (png_byte*)malloc(png_get_rowbytes(png_ptr, info_ptr));
+        dbg_msg("Renderer", "Unsupported PNG layout: %s", path);
+        png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+        fclose(fp);
+        return NULL;
     }
 
-    png_read_image(png_ptr, row_pointers);
-    fclose(fp);
-
-    png_byte* data = (png_byte*)malloc(width * height * 4);
-    for (png_uint_32 y = 0; y < height; ++y)
+    data = (png_byte*)malloc(stride * height);
+    if (!data)
+    {
+        png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+        fclose(fp);
+        return NULL;
+    }
+    for (int pass = 0; pass < passes; ++pass)
     {
-        memcpy(data + y * width * 4, row_pointers[y], width * 4);
-        free(row_pointers[y]);
+        for (png_uint_32 y = 0; y < height; ++y)
+        {
+            png_read_row(png_ptr, data + y * stride, NULL);
+        }
     }
-    free(row_pointers);
+    png_read_end(png_ptr, NULL);
+    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+    fclose(fp);
+
+    if (out_width) *out_width = (int)width;
+    if (out_height) *out_height = (int)height;
+    return data;
+}
+
+void UnloadPNGPixels(unsigned char* pixels)
+{
+    free(pixels);
+}
 
+Texture2D* LoadTextureFromPixels(const unsigned char* pixels, int width, int height)
+{
     GLuint tex_id = 0;
     if (!g_renderer || Renderer_GetBackend(g_renderer) == RENDERER_BACKEND_OPENGL)
     {
         glGenTextures(1, &tex_id);
-        glBindTexture(GL_TEXTURE_2D, tex_id);
+        GLState_BindTexture(GL_TEXTURE_2D, tex_id);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
-                     GL_RGBA, GL_UNSIGNED_BYTE, data);
+                     GL_RGBA, GL_UNSIGNED_BYTE, pixels);
     }
-    free(data);
 
-    Texture2D* texture = (Texture2D*)malloc(sizeof(Texture2D));
+    Texture2D* texture = (Texture2D*)calloc(1, sizeof(Texture2D));
     texture->id = tex_id;
     texture->width  = width;
     texture->height = height;
-    texture->native_handle = NULL;
-    texture->path[0] = '\0';
+    return texture;
+}
+
+Texture2D* LoadTexture(const char* path)
+{
+    int width = 0;
+    int height = 0;
+    unsigned char* data = LoadPNGPixels(path, &width, &height);
+    if (!data)
+    {
+        return NULL;
+    }
+
+    Texture2D* texture = LoadTextureFromPixels(data, width, height);
+    UnloadPNGPixels(data);
     if (path)
     {
         strncpy(texture->path, path, sizeof(texture->path) - 1);
@@ -409,14 +731,64 @@ void UnloadTexture(Texture2D* texture)
 {
     if (texture)
     {
-        if (texture->id != 0)
+        // atlas sprites share their page, which the atlas owns
+        if (texture->id != 0 && texture->atlas_width == 0)
         {
-            glDeleteTextures(1, &texture->id);
+            if (g_renderer && g_renderer->batch_texture == texture->id)
+            {
+                FlushBatch(g_renderer);
+            }
+            GLState_DeleteTexture(texture->id);
         }
         free(texture);
     }
 }
 
+void UpdateTextureRec(Texture2D* texture, Rect rec, const unsigned char* pixels)
+{
+    if (!texture || !texture->id || texture->atlas_width != 0 || !pixels || !g_renderer || IsD2DBackend(g_renderer))
+    {
+        return;
+    }
+
+    int width = (int)rec.width;
+    int height = (int)rec.height;
+    // the batch may still hold draws that sample the old texels
+    if (g_renderer->batch_texture == texture->id)
+    {
+        FlushBatch(g_renderer);
+    }
+    GLState_BindTexture(GL_TEXTURE_2D, texture->id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (int)rec.x, (int)rec.y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    g_renderer->upload_bytes += (size_t)width * (size_t)height * 4;
+}
+
+void SetTextureFilter(Texture2D* texture, TextureFilter filter)
+{
+    if (!texture || !texture->id || texture->atlas_width != 0 || (g_renderer && IsD2DBackend(g_renderer)))
+    {
+        return;
+    }
+
+    GLint mode = filter == TEXTURE_FILTER_POINT ? GL_NEAREST : GL_LINEAR;
+    GLState_BindTexture(GL_TEXTURE_2D, texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mode);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mode);
+}
+
+void SetTextureWrap(Texture2D* texture, TextureWrap wrap)
+{
+    if (!texture || !texture->id || texture->atlas_width != 0 || (g_renderer && IsD2DBackend(g_renderer)))
+    {
+        return;
+    }
+
+    GLint mode = wrap == TEXTURE_WRAP_REPEAT ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+    GLState_BindTexture(GL_TEXTURE_2D, texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, mode);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, mode);
+}
+
 Renderer* Renderer_Create(Window* window)
 {
     Renderer* r = malloc(sizeof(Renderer));
@@ -430,82 +802,144 @@ Renderer* Renderer_Create(Window* window)
     r->camera_y = 0.0f;
     r->camera_zoom = 1.0f;
 
-    glViewport(0, 0, r->width, r->height);
+    GLState_Invalidate();
+    GLState_Viewport(0, 0, r->width, r->height);
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    r->primitive_shader = CreateShader(PRIMITIVE_VERT, PRIMITIVE_FRAG);
-    r->texture_shader = CreateShader(TEXTURE_VERT, TEXTURE_FRAG);
-    r->text_shader = CreateShader(TEXT_VERT, TEXT_FRAG);
-
-    float left = 0.0f;
-    float right = (float)r->width;
-    float bottom = (float)r->height;
-    float top = 0.0f;
-    
-    float projection[16] =
-    {
-        2.0f / (right - left), 0.0f, 0.0f, 0.0f,
-        0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
-        0.0f, 0.0f, -1.0f, 0.0f,
-        -(right + left) / (right - left), -(top + bottom) / (top - bottom), 0.0f, 1.0f
-    };
-
-    glUseProgram(r->primitive_shader.id);
-    r->proj_uniform = glGetUniformLocation(r->primitive_shader.id, "projection");
-    glUniformMatrix4fv(r->proj_uniform, 1, GL_FALSE, projection);
-    
-    glUseProgram(r->texture_shader.id);
-    r->proj_uniform = glGetUniformLocation(r->texture_shader.id, "projection");
+    GLState_BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    r->batch_shader = CreateShader(BATCH_VERT, BATCH_FRAG);
+
+    // every program gets the screen projection now, so they all start at version 1
+    OrthoMatrix(0.0f, (float)r->width, (float)r->height, 0.0f, r->projection);
+    r->projection_version = 1;
+    r->batch_proj_version = 1;
+    r->tilemap_proj_version = 1;
+    r->instance_proj_version = 1;
+    r->text_proj_version = 1;
+    const float* projection = r->projection;
+
+    GLState_UseProgram(r->batch_shader.id);
+    r->proj_uniform = glGetUniformLocation(r->batch_shader.id, "projection");
+    r->sampler_uniform = glGetUniformLocation(r->batch_shader.id, "tex_sampler");
     glUniformMatrix4fv(r->proj_uniform, 1, GL_FALSE, projection);
-    r->transform_uniform = glGetUniformLocation(r->texture_shader.id, "transform");
-
-    glUseProgram(r->text_shader.id);
+    glUniform1i(r->sampler_uniform, 0);
+
+    r->tilemap_shader = CreateShader(TILEMAP_VERT, TILEMAP_FRAG);
+    GLState_UseProgram(r->tilemap_shader.id);
+    r->tilemap_proj_uniform = glGetUniformLocation(r->tilemap_shader.id, "projection");
+    r->tilemap_dest_uniform = glGetUniformLocation(r->tilemap_shader.id, "dest");
+    r->tilemap_size_uniform = glGetUniformLocation(r->tilemap_shader.id, "map_size");
+    r->tilemap_palette_uniform = glGetUniformLocation(r->tilemap_shader.id, "palette");
+    glUniformMatrix4fv(r->tilemap_proj_uniform, 1, GL_FALSE, projection);
+    glUniform1i(glGetUniformLocation(r->tilemap_shader.id, "tiles"), 0);
+    memset(r->tile_palette, 0, sizeof(r->tile_palette));
+    r->tile_palette_dirty = 1;
+
+    r->instance_shader = CreateShader(INSTANCE_VERT, INSTANCE_FRAG);
+    GLState_UseProgram(r->instance_shader.id);
+    r->instance_proj_uniform = glGetUniformLocation(r->instance_shader.id, "projection");
+    r->instance_textured_uniform = glGetUniformLocation(r->instance_shader.id, "textured");
+    r->instance_textured_value = -1;
+    glUniformMatrix4fv(r->instance_proj_uniform, 1, GL_FALSE, projection);
+    glUniform1i(glGetUniformLocation(r->instance_shader.id, "layers"), 0);
+
+    r->text_shader = CreateShader(BATCH_VERT, TEXT_FRAG);
+    GLState_UseProgram(r->text_shader.id);
     r->text_proj_uniform = glGetUniformLocation(r->text_shader.id, "projection");
+    r->text_style_uniform = glGetUniformLocation(r->text_shader.id, "style");
+    r->text_radius_uniform = glGetUniformLocation(r->text_shader.id, "radius");
+    r->text_style_value = -1;
+    r->text_radius_value = -1.0f;
     glUniformMatrix4fv(r->text_proj_uniform, 1, GL_FALSE, projection);
-    r->text_transform_uniform = glGetUniformLocation(r->text_shader.id, "transform");
-    r->text_sampler_uniform = glGetUniformLocation(r->text_shader.id, "tex_sampler");
-
-    glGenVertexArrays(1, &r->primitive_vao);
-    glGenBuffers(1, &r->primitive_vbo);
-    glGenBuffers(1, &r->primitive_color_vbo);
-    glGenBuffers(1, &r->primitive_ibo);
-
-    glGenVertexArrays(1, &r->texture_vao);
-    glGenBuffers(1, &r->texture_vbo);
-    glGenBuffers(1, &r->texture_ibo);
-
-    glGenVertexArrays(1, &r->text_vao);
-    glGenBuffers(1, &r->text_vbo);
-
-    glBindVertexArray(r->primitive_vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, r->primitive_vbo);
-    glBufferData(GL_ARRAY_BUFFER, 4 * 2 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glUniform1i(glGetUniformLocation(r->text_shader.id, "tex_sampler"), 0);
+
+    r->batch_vertices = (RendererVertex*)malloc(BATCH_MAX_VERTICES * sizeof(RendererVertex));
+    r->batch_count = 0;
+    r->batch_mode = GL_TRIANGLES;
+    r->batch_texture = 0;
+    r->batch_line_width = 1.0f;
+    r->batch_text_style = -1;
+    r->batch_text_radius = 0.0f;
+
+    r->upload_bytes = 0;
+    r->upload_bytes_last_frame = 0;
+    r->draw_calls = 0;
+    r->draw_calls_last_frame = 0;
+
+    glGenVertexArrays(1, &r->batch_vao);
+    GLState_BindVertexArray(r->batch_vao);
+    StreamBuffer_Init(&r->batch_stream, GL_ARRAY_BUFFER, BATCH_MAX_VERTICES * sizeof(RendererVertex));
+    glBindBuffer(GL_ARRAY_BUFFER, r->batch_stream.buffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(RendererVertex), (void*)offsetof(RendererVertex, x));
     glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, r->primitive_color_vbo);
-    glBufferData(GL_ARRAY_BUFFER, 4 * 4 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(RendererVertex), (void*)offsetof(RendererVertex, u));
     glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(RendererVertex), (void*)offsetof(RendererVertex, r));
+    glEnableVertexAttribArray(2);
 
-    unsigned int quad_indices[] = { 0, 1, 2, 2, 3, 0 };
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, r->primitive_ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quad_indices), quad_indices, GL_STATIC_DRAW);
+    unsigned short* quad_indices = (unsigned short*)malloc(BATCH_MAX_QUADS * 6 * sizeof(unsigned short));
+    if (quad_indices)
+    {
+        for (int i = 0; i < BATCH_MAX_QUADS; ++i)
+        {
+            unsigned short base = (unsigned short)(i * 4);
+            quad_indices[i * 6 + 0] = base;
+            quad_indices[i * 6 + 1] = (unsigned short)(base + 1);
+            quad_indices[i * 6 + 2] = (unsigned short)(base + 2);
+            quad_indices[i * 6 + 3] = (unsigned short)(base + 2);
+            quad_indices[i * 6 + 4] = (unsigned short)(base + 3);
+            quad_indices[i * 6 + 5] = base;
+        }
+    }
+    glGenBuffers(1, &r->batch_ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, r->batch_ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, BATCH_MAX_QUADS * 6 * sizeof(unsigned short), quad_indices, GL_STATIC_DRAW);
+    free(quad_indices);
+    GLState_BindVertexArray(0);
 
-    glBindVertexArray(0);
+    float corners[] =
+    {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        1.0f, 1.0f,
+        1.0f, 1.0f,
+        0.0f, 1.0f,
+        0.0f, 0.0f
+    };
+    glGenVertexArrays(1, &r->tilemap_vao);
+    glGenBuffers(1, &r->quad_vbo);
+    GLState_BindVertexArray(r->tilemap_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, r->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    GLState_BindVertexArray(0);
 
-    glBindVertexArray(r->text_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, r->text_vbo);
-    glBufferData(GL_ARRAY_BUFFER, 0, NULL, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glGenVertexArrays(1, &r->instance_vao);
+    GLState_BindVertexArray(r->instance_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, r->quad_vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(2 * sizeof(float)));
+    StreamBuffer_Init(&r->instance_stream, GL_ARRAY_BUFFER, INSTANCE_MAX_PER_DRAW * sizeof(InstanceVertex));
+    glBindBuffer(GL_ARRAY_BUFFER, r->instance_stream.buffer);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceVertex), (void*)offsetof(InstanceVertex, x));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(4 * sizeof(float)));
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceVertex), (void*)offsetof(InstanceVertex, rotation));
     glEnableVertexAttribArray(2);
-    glBindVertexArray(0);
+    glVertexAttribDivisor(2, 1);
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceVertex), (void*)offsetof(InstanceVertex, r));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    GLState_BindVertexArray(0);
+
+    // untextured primitives sample this so they share the sprite shader and batch
+    unsigned char white[4] = { 255, 255, 255, 255 };
+    glGenTextures(1, &r->white_texture);
+    GLState_BindTexture(GL_TEXTURE_2D, r->white_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
 
     dbg_msg("Renderer", "Renderer created successfully");
 
@@ -526,6 +960,7 @@ int Renderer_SetBackend(Renderer* r, RendererBackend backend)
 
     if (backend == RENDERER_BACKEND_DIRECT2D)
     {
+        FlushBatch(r);
         ClearD2DTextureCache();
         D2DRenderer* d2d = D2DRenderer_Create(r->window->handle, r->width, r->height);
         if (!d2d)
@@ -551,6 +986,8 @@ int Renderer_SetBackend(Renderer* r, RendererBackend backend)
             ClearD2DTextureCache();
             r->backend_ctx = NULL;
         }
+        // the other backend may have touched GL behind the cache
+        GLState_Invalidate();
         r->backend = RENDERER_BACKEND_OPENGL;
         dbg_msg("Renderer", "Switched backend to OpenGL");
         return 1;
@@ -598,24 +1035,26 @@ void Renderer_Destroy(Renderer* r)
         g_default_font = NULL;
     }
 
-    glDeleteProgram(r->primitive_shader.id);
-    glDeleteProgram(r->texture_shader.id);
-    glDeleteProgram(r->text_shader.id);
-    
-    glDeleteBuffers(1, &r->primitive_vbo);
-    glDeleteBuffers(1, &r->primitive_color_vbo);
-    glDeleteBuffers(1, &r->primitive_ibo);
-    glDeleteVertexArrays(1, &r->primitive_vao);
-    
-    glDeleteBuffers(1, &r->texture_vbo);
-    glDeleteBuffers(1, &r->texture_ibo);
-    glDeleteVertexArrays(1, &r->texture_vao);
-
-    glDeleteBuffers(1, &r->text_vbo);
-    glDeleteVertexArrays(1, &r->text_vao);
+    GLState_DeleteProgram(r->batch_shader.id);
+    GLState_DeleteProgram(r->tilemap_shader.id);
+    GLState_DeleteProgram(r->instance_shader.id);
+    GLState_DeleteProgram(r->text_shader.id);
+    StreamBuffer_Destroy(&r->instance_stream);
+    GLState_DeleteVertexArray(r->instance_vao);
+    glDeleteBuffers(1, &r->quad_vbo);
+    GLState_DeleteVertexArray(r->tilemap_vao);
+    StreamBuffer_Destroy(&r->batch_stream);
+    glDeleteBuffers(1, &r->batch_ibo);
+    GLState_DeleteVertexArray(r->batch_vao);
+    GLState_DeleteTexture(r->white_texture);
+    free(r->batch_vertices);
     
     dbg_msg("Renderer", "Renderer destroyed");
 
+    if (g_renderer == r)
+    {
+        g_renderer = NULL;
+    }
     free(r);
 }
 
@@ -628,6 +1067,7 @@ void Renderer_BeginFrame(Renderer* r)
         return;
     }
 
+    FlushBatch(r);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
@@ -639,6 +1079,14 @@ void Renderer_EndFrame(Renderer* r)
         D2DRenderer_EndFrame((D2DRenderer*)r->backend_ctx);
         return;
     }
+    FlushBatch(r);
+    StreamBuffer_EndFrame(&r->batch_stream);
+    StreamBuffer_EndFrame(&r->instance_stream);
+    r->upload_bytes_last_frame = r->upload_bytes;
+    r->upload_bytes = 0;
+    r->draw_calls_last_frame = r->draw_calls;
+    r->draw_calls = 0;
+    GLState_EndFrame();
     SDL_GL_SwapWindow(r->window->handle);
 }
 
@@ -649,6 +1097,7 @@ void Renderer_Clear(Color color)
         D2DRenderer_Clear((D2DRenderer*)g_renderer->backend_ctx, color);
         return;
     }
+    FlushBatch(g_renderer);
     glClearColor(color.r, color.g, color.b, color.a);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
@@ -662,32 +1111,8 @@ void Renderer_DrawRectangle(Rect rect, Color color)
         return;
     }
 
-    float vertices[] =
-    {
-        rect.x, rect.y,
-        rect.x + rect.width, rect.y,
-        rect.x + rect.width, rect.y + rect.height,
-        rect.x, rect.y + rect.height
-    };
-    float colors[] =
-    {
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a
-    };
     if (!g_renderer) return;
-    glBindVertexArray(g_renderer->primitive_vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->primitive_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->primitive_color_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(colors), colors);
-
-    glUseProgram(g_renderer->primitive_shader.id);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    BatchRect(g_renderer->white_texture, rect, 0.0f, 0.0f, 1.0f, 1.0f, color);
 }
 
 void Renderer_DrawTrianglesColored(const float* positions, const float* colors, int vertexCount)
@@ -712,18 +1137,29 @@ void Renderer_DrawTrianglesColored(const float* positions, const float* colors,
     if (!g_renderer) return;
     if (!positions || !colors || vertexCount <= 0) return;
 
-    glBindVertexArray(g_renderer->primitive_vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->primitive_vbo);
-    glBufferData(GL_ARRAY_BUFFER, (size_t)vertexCount * 2 * sizeof(float), positions, GL_DYNAMIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->primitive_color_vbo);
-    glBufferData(GL_ARRAY_BUFFER, (size_t)vertexCount * 4 * sizeof(float), colors, GL_DYNAMIC_DRAW);
-
-    glUseProgram(g_renderer->primitive_shader.id);
-    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    int triangles = vertexCount / 3;
+    int done = 0;
+    while (done < triangles)
+    {
+        int count = triangles - done;
+        if (count > BATCH_MAX_QUADS)
+        {
+            count = BATCH_MAX_QUADS;
+        }
 
-    glBindVertexArray(0);
+        RendererVertex* v = BatchReserve(GL_TRIANGLES, g_renderer->white_texture, 1.0f, count * 4);
+        if (!v) return;
+        for (int t = done; t < done + count; ++t)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                int i = t * 3 + (k < 3 ? k : 2);
+                Color c = { colors[i * 4 + 0], colors[i * 4 + 1], colors[i * 4 + 2], colors[i * 4 + 3] };
+                v = BatchVertex(v, positions[i * 2 + 0], positions[i * 2 + 1], 0.0f, 0.0f, c);
+            }
+        }
+        done += count;
+    }
 }
 
 void Renderer_DrawRectangleLines(Rect rect, int line_thick, Color color)
@@ -736,47 +1172,26 @@ void Renderer_DrawRectangleLines(Rect rect, int line_thick, Color color)
         return;
     }
 
-    float vertices[] =
-    {
-        rect.x, rect.y,
-        rect.x + rect.width, rect.y,
-        rect.x + rect.width, rect.y + rect.height,
-        rect.x, rect.y + rect.height
-    };
-    float colors[] =
-    {
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a
-    };
-    unsigned int indices[] = { 0, 1, 1, 2, 2, 3, 3, 0 };
-    GLuint vao, vbo, vbo_color, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &vbo_color);
-    glGenBuffers(1, &ibo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glUseProgram(g_renderer->primitive_shader.id);
-    glLineWidth((float)line_thick);
-    glDrawElements(GL_LINES, 8, GL_UNSIGNED_INT, 0);
-    glLineWidth(1.0f);
-    glDeleteBuffers(1, &vbo);
-    glDeleteBuffers(1, &vbo_color);
-    glDeleteBuffers(1, &ibo);
-    glDeleteVertexArrays(1, &vao);
+    if (!g_renderer) return;
+    RendererVertex* v = BatchReserve(GL_LINES, g_renderer->white_texture, (float)line_thick, 8);
+    if (!v) return;
+
+    float x0 = rect.x;
+    float y0 = rect.y;
+    float x1 = rect.x + rect.width;
+    float y1 = rect.y + rect.height;
+    v = BatchVertex(v, x0, y0, 0.0f, 0.0f, color);
+    v = BatchVertex(v, x1, y0, 0.0f, 0.0f, color);
+    v = BatchVertex(v, x1, y0, 0.0f, 0.0f, color);
+    v = BatchVertex(v, x1, y1, 0.0f, 0.0f, color);
+    v = BatchVertex(v, x1, y1, 0.0f, 0.0f, color);
+    v = BatchVertex(v, x0, y1, 0.0f, 0.0f, color);
+    v = BatchVertex(v, x0, y1, 0.0f, 0.0f, color);
+    BatchVertex(v, x0, y0, 0.0f, 0.0f, color);
 }
 
+#define CIRCLE_SEGMENTS 32
+
 void Renderer_DrawCircle(Vec2 center, float radius, Color color)
 {
     if (IsD2DBackend(g_renderer))
@@ -787,62 +1202,28 @@ void Renderer_DrawCircle(Vec2 center, float radius, Color color)
         return;
     }
 
-    const int segments = 32;
-    float* vertices = (float*)malloc((segments + 2) * 2 * sizeof(float));
-    float* colors = (float*)malloc((segments + 2) * 4 * sizeof(float));
-    unsigned int* indices = (unsigned int*)malloc(segments * 3 * sizeof(unsigned int));
-    
-    vertices[0] = center.x;
-    vertices[1] = center.y;
-    colors[0] = color.r;
-    colors[1] = color.g;
-    colors[2] = color.b;
-    colors[3] = color.a;
-    
-    for (int i = 0; i <= segments; i++)
-    {
-        float angle = (2.0f * 3.14159f * i) / segments;
-        vertices[(i + 1) * 2] = center.x + radius * cosf(angle);
-        vertices[(i + 1) * 2 + 1] = center.y + radius * sinf(angle);
-        colors[(i + 1) * 4] = color.r;
-        colors[(i + 1) * 4 + 1] = color.g;
-        colors[(i + 1) * 4 + 2] = color.b;
-        colors[(i + 1) * 4 + 3] = color.a;
-    }
-    
-    for (int i = 0; i < segments; i++)
-    {
-        indices[i * 3] = 0;
-        indices[i * 3 + 1] = i + 1;
-        indices[i * 3 + 2] = i + 2;
+    if (!g_renderer) return;
+    RendererVertex* v = BatchReserve(GL_TRIANGLES, g_renderer->white_texture, 1.0f, CIRCLE_SEGMENTS * 2);
+    if (!v) return;
+
+    // each quad (center, p[i], p[i+1], p[i+2]) covers two fan segments
+    float prev_x = center.x + radius;
+    float prev_y = center.y;
+    for (int i = 1; i < CIRCLE_SEGMENTS; i += 2)
+    {
+        float a1 = (2.0f * 3.14159f * i) / CIRCLE_SEGMENTS;
+        float a2 = (2.0f * 3.14159f * (i + 1)) / CIRCLE_SEGMENTS;
+        float x1 = center.x + radius * cosf(a1);
+        float y1 = center.y + radius * sinf(a1);
+        float x2 = center.x + radius * cosf(a2);
+        float y2 = center.y + radius * sinf(a2);
+        v = BatchVertex(v, center.x, center.y, 0.0f, 0.0f, color);
+        v = BatchVertex(v, prev_x, prev_y, 0.0f, 0.0f, color);
+        v = BatchVertex(v, x1, y1, 0.0f, 0.0f, color);
+        v = BatchVertex(v, x2, y2, 0.0f, 0.0f, color);
+        prev_x = x2;
+        prev_y = y2;
     }
-    
-    GLuint vao, vbo, vbo_color, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &vbo_color);
-    glGenBuffers(1, &ibo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, (segments + 2) * 2 * sizeof(float), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
-    glBufferData(GL_ARRAY_BUFFER, (segments + 2) * 4 * sizeof(float), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, segments * 3 * sizeof(unsigned int), indices, GL_STATIC_DRAW);
-    glUseProgram(g_renderer->primitive_shader.id);
-    glDrawElements(GL_TRIANGLES, segments * 3, GL_UNSIGNED_INT, 0);
-    glDeleteBuffers(1, &vbo);
-    glDeleteBuffers(1, &vbo_color);
-    glDeleteBuffers(1, &ibo);
-    glDeleteVertexArrays(1, &vao);
-    
-    free(vertices);
-    free(colors);
-    free(indices);
 }
 
 void Renderer_DrawCircleLines(Vec2 center, float radius, Color color)
@@ -855,51 +1236,22 @@ void Renderer_DrawCircleLines(Vec2 center, float radius, Color color)
         return;
     }
 
-    const int segments = 32;
-    float* vertices = (float*)malloc(segments * 2 * sizeof(float));
-    float* colors = (float*)malloc(segments * 4 * sizeof(float));
-    unsigned int* indices = (unsigned int*)malloc(segments * 2 * sizeof(unsigned int));
-    
-    for (int i = 0; i < segments; i++)
-    {
-        float angle = (2.0f * 3.14159f * i) / segments;
-        vertices[i * 2] = center.x + radius * cosf(angle);
-        vertices[i * 2 + 1] = center.y + radius * sinf(angle);
-        colors[i * 4] = color.r;
-        colors[i * 4 + 1] = color.g;
-        colors[i * 4 + 2] = color.b;
-        colors[i * 4 + 3] = color.a;
-        indices[i * 2] = i;
-        indices[i * 2 + 1] = (i + 1) % segments;
+    if (!g_renderer) return;
+    RendererVertex* v = BatchReserve(GL_LINES, g_renderer->white_texture, 1.0f, CIRCLE_SEGMENTS * 2);
+    if (!v) return;
+
+    float prev_x = center.x + radius;
+    float prev_y = center.y;
+    for (int i = 1; i <= CIRCLE_SEGMENTS; i++)
+    {
+        float angle = (2.0f * 3.14159f * (i % CIRCLE_SEGMENTS)) / CIRCLE_SEGMENTS;
+        float x = center.x + radius * cosf(angle);
+        float y = center.y + radius * sinf(angle);
+        v = BatchVertex(v, prev_x, prev_y, 0.0f, 0.0f, color);
+        v = BatchVertex(v, x, y, 0.0f, 0.0f, color);
+        prev_x = x;
+        prev_y = y;
     }
-    
-    GLuint vao, vbo, vbo_color, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &vbo_color);
-    glGenBuffers(1, &ibo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, segments * 2 * sizeof(float), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
-    glBufferData(GL_ARRAY_BUFFER, segments * 4 * sizeof(float), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, segments * 2 * sizeof(unsigned int), indices, GL_STATIC_DRAW);
-    glUseProgram(g_renderer->primitive_shader.id);
-    glLineWidth(1.0f);
-    glDrawElements(GL_LINES, segments * 2, GL_UNSIGNED_INT, 0);
-    glDeleteBuffers(1, &vbo);
-    glDeleteBuffers(1, &vbo_color);
-    glDeleteBuffers(1, &ibo);
-    glDeleteVertexArrays(1, &vao);
-    
-    free(vertices);
-    free(colors);
-    free(indices);
 }
 
 void Renderer_DrawLine(Vec2 start, Vec2 end, Color color)
@@ -912,28 +1264,7 @@ void Renderer_DrawLine(Vec2 start, Vec2 end, Color color)
         return;
     }
 
-    float vertices[] =
-    {
-        start.x, start.y,
-        end.x, end.y
-    };
-    float colors[] =
-    {
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a
-    };
-    if (!g_renderer) return;
-    glBindVertexArray(g_renderer->primitive_vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->primitive_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->primitive_color_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(colors), colors);
-
-    glUseProgram(g_renderer->primitive_shader.id);
-    glDrawArrays(GL_LINES, 0, 2);
-    glBindVertexArray(0);
+    Renderer_DrawLineEx(start, end, 1.0f, color);
 }
 
 void Renderer_DrawLineEx(Vec2 start, Vec2 end, float thick, Color color)
@@ -946,30 +1277,11 @@ void Renderer_DrawLineEx(Vec2 start, Vec2 end, float thick, Color color)
         return;
     }
 
-    float vertices[] =
-    {
-        start.x, start.y,
-        end.x, end.y
-    };
-    float colors[] =
-    {
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a
-    };
     if (!g_renderer) return;
-    glBindVertexArray(g_renderer->primitive_vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->primitive_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->primitive_color_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(colors), colors);
-
-    glUseProgram(g_renderer->primitive_shader.id);
-    glLineWidth(thick);
-    glDrawArrays(GL_LINES, 0, 2);
-    glLineWidth(1.0f);
-    glBindVertexArray(0);
+    RendererVertex* v = BatchReserve(GL_LINES, g_renderer->white_texture, thick, 2);
+    if (!v) return;
+    v = BatchVertex(v, start.x, start.y, 0.0f, 0.0f, color);
+    BatchVertex(v, end.x, end.y, 0.0f, 0.0f, color);
 }
 
 void Renderer_DrawTriangle(Vec2 v1, Vec2 v2, Vec2 v3, Color color)
@@ -983,36 +1295,13 @@ void Renderer_DrawTriangle(Vec2 v1, Vec2 v2, Vec2 v3, Color color)
         return;
     }
 
-    float vertices[] =
-    {
-        v1.x, v1.y,
-        v2.x, v2.y,
-        v3.x, v3.y
-    };
-    float colors[] =
-    {
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a
-    };
-    GLuint vao, vbo, vbo_color;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &vbo_color);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glUseProgram(g_renderer->primitive_shader.id);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-    glDeleteBuffers(1, &vbo);
-    glDeleteBuffers(1, &vbo_color);
-    glDeleteVertexArrays(1, &vao);
+    if (!g_renderer) return;
+    RendererVertex* v = BatchReserve(GL_TRIANGLES, g_renderer->white_texture, 1.0f, 4);
+    if (!v) return;
+    v = BatchVertex(v, v1.x, v1.y, 0.0f, 0.0f, color);
+    v = BatchVertex(v, v2.x, v2.y, 0.0f, 0.0f, color);
+    v = BatchVertex(v, v3.x, v3.y, 0.0f, 0.0f, color);
+    BatchVertex(v, v3.x, v3.y, 0.0f, 0.0f, color);
 }
 
 void Renderer_DrawTriangleLines(Vec2 v1, Vec2 v2, Vec2 v3, Color color)
@@ -1026,45 +1315,49 @@ void Renderer_DrawTriangleLines(Vec2 v1, Vec2 v2, Vec2 v3, Color color)
         return;
     }
 
-    float vertices[] =
-    {
-        v1.x, v1.y,
-        v2.x, v2.y,
-        v3.x, v3.y
-    };
-    float colors[] =
-    {
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a,
-        color.r, color.g, color.b, color.a
-    };
-    unsigned int indices[] = { 0, 1, 1, 2, 2, 0 };
-    GLuint vao, vbo, vbo_color, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &vbo_color);
-    glGenBuffers(1, &ibo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_color);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glUseProgram(g_renderer->primitive_shader.id);
-    glDrawElements(GL_LINES, 6, GL_UNSIGNED_INT, 0);
-    glDeleteBuffers(1, &vbo);
-    glDeleteBuffers(1, &vbo_color);
-    glDeleteBuffers(1, &ibo);
-    glDeleteVertexArrays(1, &vao);
+    if (!g_renderer) return;
+    RendererVertex* v = BatchReserve(GL_LINES, g_renderer->white_texture, 1.0f, 6);
+    if (!v) return;
+    v = BatchVertex(v, v1.x, v1.y, 0.0f, 0.0f, color);
+    v = BatchVertex(v, v2.x, v2.y, 0.0f, 0.0f, color);
+    v = BatchVertex(v, v2.x, v2.y, 0.0f, 0.0f, color);
+    v = BatchVertex(v, v3.x, v3.y, 0.0f, 0.0f, color);
+    v = BatchVertex(v, v3.x, v3.y, 0.0f, 0.0f, color);
+    BatchVertex(v, v1.x, v1.y, 0.0f, 0.0f, color);
+}
+
+// asset handles stay 0x0 until uploaded and for good after a failed load;
+// those draw nothing rather than NaN UVs or a tinted rectangle
+static int TextureHasPixels(const Texture2D* texture)
+{
+    return texture->width > 0 && texture->height > 0;
+}
+
+// maps a source rect in texture pixels to UVs, offset into the atlas page for packed sprites
+static void TextureSourceUV(const Texture2D* texture, Rect source, float* u1, float* v1, float* u2, float* v2)
+{
+    float ox = 0.0f;
+    float oy = 0.0f;
+    float pw = (float)texture->width;
+    float ph = (float)texture->height;
+    if (texture->atlas_width > 0)
+    {
+        ox = (float)texture->atlas_x;
+        oy = (float)texture->atlas_y;
+        pw = (float)texture->atlas_width;
+        ph = (float)texture->atlas_height;
+    }
+
+    *u1 = (ox + source.x) / pw;
+    *v1 = (oy + source.y) / ph;
+    *u2 = (ox + source.x + source.width) / pw;
+    *v2 = (oy + source.y + source.height) / ph;
 }
 
 void Renderer_DrawTexture(Texture2D texture, Vec2 position, Color tint)
 {
+    if (!TextureHasPixels(&texture)) return;
+
     if (IsD2DBackend(g_renderer))
     {
         Rect src = { 0.0f, 0.0f, (float)texture.width, (float)texture.height };
@@ -1082,77 +1375,17 @@ void Renderer_DrawTexture(Texture2D texture, Vec2 position, Color tint)
         return;
     }
 
-    float vertices[] =
-    {
-        position.x, position.y,
-        position.x + texture.width, position.y,
-        position.x + texture.width, position.y + texture.height,
-        position.x, position.y + texture.height
-    };
-    
-    float texcoords[] =
-    {
-        0.0f, 0.0f,
-        1.0f, 0.0f,
-        1.0f, 1.0f,
-        0.0f, 1.0f
-    };
-    
-    float colors[] =
-    {
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a
-    };
-    
-    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
-    
-    GLuint vao, vbo_pos, vbo_tex, vbo_col, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo_pos);
-    glGenBuffers(1, &vbo_tex);
-    glGenBuffers(1, &vbo_col);
-    glGenBuffers(1, &ibo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tex);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_col);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
-    glUseProgram(g_renderer->texture_shader.id);
-    GLint tex_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "tex_sampler");
-    glUniform1i(tex_uniform, 0);
-    float identity[16] =
-    {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-    GLint transform_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "transform");
-    glUniformMatrix4fv(transform_uniform, 1, GL_FALSE, identity);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo_pos);
-    glDeleteBuffers(1, &vbo_tex);
-    glDeleteBuffers(1, &vbo_col);
-    glDeleteBuffers(1, &ibo);
+    if (!g_renderer) return;
+    float u1, v1, u2, v2;
+    TextureSourceUV(&texture, (Rect){ 0.0f, 0.0f, (float)texture.width, (float)texture.height }, &u1, &v1, &u2, &v2);
+    Rect dst = { position.x, position.y, (float)texture.width, (float)texture.height };
+    BatchRect(texture.id, dst, u1, v1, u2, v2, tint);
 }
 
 void Renderer_DrawTextureRec(Texture2D texture, Rect source, Vec2 position, Color tint)
 {
+    if (!TextureHasPixels(&texture)) return;
+
     if (IsD2DBackend(g_renderer))
     {
         Rect dst = { position.x, position.y, source.width, source.height };
@@ -1171,82 +1404,17 @@ void Renderer_DrawTextureRec(Texture2D texture, Rect source, Vec2 position, Colo
 
     if (!g_renderer) return;
     
-    float u1 = source.x / texture.width;
-    float v1 = source.y / texture.height;
-    float u2 = (source.x + source.width) / texture.width;
-    float v2 = (source.y + source.height) / texture.height;
-    
-    float vertices[] =
-    {
-        position.x, position.y,
-        position.x + source.width, position.y,
-        position.x + source.width, position.y + source.height,
-        position.x, position.y + source.height
-    };
-    
-    float texcoords[] =
-    {
-        u1, v1,
-        u2, v1,
-        u2, v2,
-        u1, v2
-    };
-    
-    float colors[] =
-    {
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a
-    };
-    
-    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
-    
-    GLuint vao, vbo_pos, vbo_tex, vbo_col, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo_pos);
-    glGenBuffers(1, &vbo_tex);
-    glGenBuffers(1, &vbo_col);
-    glGenBuffers(1, &ibo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tex);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_col);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
-    glUseProgram(g_renderer->texture_shader.id);
-    GLint tex_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "tex_sampler");
-    glUniform1i(tex_uniform, 0);
-    float identity[16] =
-    {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-    GLint transform_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "transform");
-    glUniformMatrix4fv(transform_uniform, 1, GL_FALSE, identity);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo_pos);
-    glDeleteBuffers(1, &vbo_tex);
-    glDeleteBuffers(1, &vbo_col);
-    glDeleteBuffers(1, &ibo);
+    float u1, v1, u2, v2;
+    TextureSourceUV(&texture, source, &u1, &v1, &u2, &v2);
+
+    Rect dst = { position.x, position.y, source.width, source.height };
+    BatchRect(texture.id, dst, u1, v1, u2, v2, tint);
 }
 
 void Renderer_DrawTextureEx(Texture2D texture, Vec2 position, float rotation, float scale, Color tint)
 {
+    if (!TextureHasPixels(&texture)) return;
+
     if (IsD2DBackend(g_renderer))
     {
         Rect src = { 0.0f, 0.0f, (float)texture.width, (float)texture.height };
@@ -1269,92 +1437,27 @@ void Renderer_DrawTextureEx(Texture2D texture, Vec2 position, float rotation, fl
     
     float width = texture.width * scale;
     float height = texture.height * scale;
-    
-    float vertices[] =
-    {
-        position.x, position.y,
-        position.x + width, position.y,
-        position.x + width, position.y + height,
-        position.x, position.y + height
-    };
-    
-    float texcoords[] =
+    Vec2 corners[4] =
     {
-        0.0f, 0.0f,
-        1.0f, 0.0f,
-        1.0f, 1.0f,
-        0.0f, 1.0f
-    };
-    
-    float colors[] =
-    {
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a
-    };
-    
-    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
-    
-    GLuint vao, vbo_pos, vbo_tex, vbo_col, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo_pos);
-    glGenBuffers(1, &vbo_tex);
-    glGenBuffers(1, &vbo_col);
-    glGenBuffers(1, &ibo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tex);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_col);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
-    glUseProgram(g_renderer->texture_shader.id);
-    GLint tex_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "tex_sampler");
-    glUniform1i(tex_uniform, 0);
-    float transform[16] =
-    {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
+        { position.x, position.y },
+        { position.x + width, position.y },
+        { position.x + width, position.y + height },
+        { position.x, position.y + height }
     };
+
     if (rotation != 0.0f)
     {
-        float cos_a = cosf(rotation);
-        float sin_a = sinf(rotation);
-        float cx = position.x + width / 2.0f;
-        float cy = position.y + height / 2.0f;
-        
-        transform[0] = cos_a;
-        transform[1] = sin_a;
-        transform[4] = -sin_a;
-        transform[5] = cos_a;
-        transform[12] = cx - (cos_a * cx - sin_a * cy);
-        transform[13] = cy - (sin_a * cx + cos_a * cy);
-    }
-    GLint transform_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "transform");
-    glUniformMatrix4fv(transform_uniform, 1, GL_FALSE, transform);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo_pos);
-    glDeleteBuffers(1, &vbo_tex);
-    glDeleteBuffers(1, &vbo_col);
-    glDeleteBuffers(1, &ibo);
+        RotateCorners(corners, position.x + width / 2.0f, position.y + height / 2.0f, rotation);
+    }
+    float u1, v1, u2, v2;
+    TextureSourceUV(&texture, (Rect){ 0.0f, 0.0f, (float)texture.width, (float)texture.height }, &u1, &v1, &u2, &v2);
+    BatchQuad(texture.id, corners, u1, v1, u2, v2, tint);
 }
 
 void Renderer_DrawTexturePro(Texture2D texture, Rect source, Rect dest, Vec2 origin, float rotation, Color tint)
 {
+    if (!TextureHasPixels(&texture)) return;
+
     if (IsD2DBackend(g_renderer))
     {
         Rect dst_t = TransformRectForBackend(dest);
@@ -1373,120 +1476,341 @@ void Renderer_DrawTexturePro(Texture2D texture, Rect source, Rect dest, Vec2 ori
 
     if (!g_renderer) return;
     
-    float u1 = source.x / texture.width;
-    float v1 = source.y / texture.height;
-    float u2 = (source.x + source.width) / texture.width;
-    float v2 = (source.y + source.height) / texture.height;
-    
-    float vertices[] =
+    float u1, v1, u2, v2;
+    TextureSourceUV(&texture, source, &u1, &v1, &u2, &v2);
+
+    if (rotation != 0.0f)
     {
-        dest.x, dest.y,
-        dest.x + dest.width, dest.y,
-        dest.x + dest.width, dest.y + dest.height,
-        dest.x, dest.y + dest.height
-    };
-    
-    float texcoords[] =
+        Vec2 corners[4] =
+        {
+            { dest.x, dest.y },
+            { dest.x + dest.width, dest.y },
+            { dest.x + dest.width, dest.y + dest.height },
+            { dest.x, dest.y + dest.height }
+        };
+        RotateCorners(corners, dest.x + origin.x, dest.y + origin.y, rotation);
+        BatchQuad(texture.id, corners, u1, v1, u2, v2, tint);
+        return;
+    }
+
+    dest.x -= origin.x;
+    dest.y -= origin.y;
+    BatchRect(texture.id, dest, u1, v1, u2, v2, tint);
+}
+
+TileMap LoadTileMap(int width, int height, const unsigned char* tiles)
+{
+    TileMap map = {0};
+    if (!g_renderer || IsD2DBackend(g_renderer) || width <= 0 || height <= 0)
     {
-        u1, v1,
-        u2, v1,
-        u2, v2,
-        u1, v2
-    };
-    
-    float colors[] =
+        return map;
+    }
+
+    map.width = width;
+    map.height = height;
+    glGenTextures(1, &map.texture);
+    GLState_BindTexture(GL_TEXTURE_2D, map.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, tiles);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (tiles)
     {
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a,
-        tint.r, tint.g, tint.b, tint.a
-    };
-    
-    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
-    
-    GLuint vao, vbo_pos, vbo_tex, vbo_col, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo_pos);
-    glGenBuffers(1, &vbo_tex);
-    glGenBuffers(1, &vbo_col);
-    glGenBuffers(1, &ibo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_pos);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_tex);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_col);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
-    glUseProgram(g_renderer->texture_shader.id);
-    GLint tex_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "tex_sampler");
-    glUniform1i(tex_uniform, 0);
-    float transform[16] =
-    {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-    if (rotation != 0.0f)
+        g_renderer->upload_bytes += (size_t)width * (size_t)height;
+    }
+    return map;
+}
+
+void UpdateTileMap(TileMap* map, const unsigned char* tiles)
+{
+    if (!map || !map->texture || !tiles || !g_renderer)
+    {
+        return;
+    }
+
+    GLState_BindTexture(GL_TEXTURE_2D, map->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, map->width, map->height, GL_RED_INTEGER, GL_UNSIGNED_BYTE, tiles);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    g_renderer->upload_bytes += (size_t)map->width * (size_t)map->height;
+}
+
+void UnloadTileMap(TileMap* map)
+{
+    if (!map)
     {
-        float cos_a = cosf(rotation);
-        float sin_a = sinf(rotation);
-        float cx = dest.x + origin.x;
-        float cy = dest.y + origin.y;
-        transform[0] = cos_a;
-        transform[1] = sin_a;
-        transform[4] = -sin_a;
-        transform[5] = cos_a;
-        transform[12] = cx - (cos_a * cx - sin_a * cy);
-        transform[13] = cy - (sin_a * cx + cos_a * cy);
+        return;
     }
-    else if (origin.x != 0.0f || origin.y != 0.0f)
+
+    if (map->texture)
     {
-        transform[12] = -origin.x;
-        transform[13] = -origin.y;
+        GLState_DeleteTexture(map->texture);
     }
-    GLint transform_uniform = glGetUniformLocation(g_renderer->texture_shader.id, "transform");
-    glUniformMatrix4fv(transform_uniform, 1, GL_FALSE, transform);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo_pos);
-    glDeleteBuffers(1, &vbo_tex);
-    glDeleteBuffers(1, &vbo_col);
-    glDeleteBuffers(1, &ibo);
+    map->texture = 0;
+    map->width = 0;
+    map->height = 0;
 }
 
-static void DrawTextBatch(Texture2D texture, const float* verts, int vertCount)
+TileColorArray LoadTileColorArray(int width, int height, int layers)
 {
-    if (!g_renderer) return;
+    TileColorArray array = {0};
+    if (!g_renderer || IsD2DBackend(g_renderer) || width <= 0 || height <= 0 || layers <= 0)
+    {
+        return array;
+    }
+
+    int levels = 1;
+    while ((width >> levels) > 0 || (height >> levels) > 0)
+    {
+        levels++;
+    }
+
+    glGenTextures(1, &array.texture);
+    GLState_BindTexture(GL_TEXTURE_2D_ARRAY, array.texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, width, height, layers);
+    // nearest when magnified so zoomed-in tiles keep hard edges like the tilemap shader
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    glBindVertexArray(g_renderer->text_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, g_renderer->text_vbo);
-    glBufferData(GL_ARRAY_BUFFER, (size_t)vertCount * 8 * sizeof(float), verts, GL_DYNAMIC_DRAW);
+    array.width = width;
+    array.height = height;
+    array.layers = layers;
+    array.levels = levels;
+    return array;
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture.id);
-    glUseProgram(g_renderer->text_shader.id);
-    glUniform1i(g_renderer->text_sampler_uniform, 0);
-    float identity[16] =
+// 2x2 box filter; color is weighted by alpha so empty tiles do not darken their neighbours
+static void DownsampleTileColors(const unsigned char* src, int src_w, int src_h, unsigned char* dst, int dst_w, int dst_h)
+{
+    for (int y = 0; y < dst_h; ++y)
     {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-    glUniformMatrix4fv(g_renderer->text_transform_uniform, 1, GL_FALSE, identity);
-    glDrawArrays(GL_TRIANGLES, 0, vertCount);
-    glBindVertexArray(0);
+        for (int x = 0; x < dst_w; ++x)
+        {
+            int sum[4] = { 0, 0, 0, 0 };
+            int taps = 0;
+            for (int dy = 0; dy < 2; ++dy)
+            {
+                for (int dx = 0; dx < 2; ++dx)
+                {
+                    int sx = x * 2 + dx < src_w ? x * 2 + dx : src_w - 1;
+                    int sy = y * 2 + dy < src_h ? y * 2 + dy : src_h - 1;
+                    const unsigned char* p = src + ((size_t)sy * src_w + sx) * 4;
+                    sum[0] += p[0] * p[3];
+                    sum[1] += p[1] * p[3];
+                    sum[2] += p[2] * p[3];
+                    sum[3] += p[3];
+                    taps++;
+                }
+            }
+            unsigned char* out = dst + ((size_t)y * dst_w + x) * 4;
+            for (int c = 0; c < 3; ++c)
+            {
+                out[c] = (unsigned char)(sum[3] > 0 ? sum[c] / sum[3] : 0);
+            }
+            out[3] = (unsigned char)(sum[3] / taps);
+        }
+    }
+}
+
+void UpdateTileColorLayer(TileColorArray* array, int layer, const unsigned char* tiles)
+{
+    if (!array || !array->texture || !tiles || !g_renderer || layer < 0 || layer >= array->layers)
+    {
+        return;
+    }
+
+    // each level is at most half the one above, so the chain fits in twice the base level
+    size_t base = (size_t)array->width * (size_t)array->height * 4;
+    unsigned char* pixels = (unsigned char*)malloc(base * 2);
+    if (!pixels)
+    {
+        return;
+    }
+
+    const float* palette = g_renderer->tile_palette;
+    for (int i = 0; i < array->width * array->height; ++i)
+    {
+        int id = tiles[i] < RENDERER_TILE_PALETTE_SIZE ? tiles[i] : RENDERER_TILE_PALETTE_SIZE - 1;
+        pixels[i * 4 + 0] = ColorByte(palette[id * 4 + 0]);
+        pixels[i * 4 + 1] = ColorByte(palette[id * 4 + 1]);
+        pixels[i * 4 + 2] = ColorByte(palette[id * 4 + 2]);
+        pixels[i * 4 + 3] = ColorByte(palette[id * 4 + 3]);
+    }
+
+    GLState_BindTexture(GL_TEXTURE_2D_ARRAY, array->texture);
+    unsigned char* level = pixels;
+    unsigned char* next = pixels + base;
+    int w = array->width;
+    int h = array->height;
+    for (int l = 0; l < array->levels; ++l)
+    {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, layer, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, level);
+        g_renderer->upload_bytes += (size_t)w * (size_t)h * 4;
+        if (l + 1 == array->levels)
+        {
+            break;
+        }
+
+        int nw = w > 1 ? w / 2 : 1;
+        int nh = h > 1 ? h / 2 : 1;
+        DownsampleTileColors(level, w, h, next, nw, nh);
+        level = next;
+        next += (size_t)nw * (size_t)nh * 4;
+        w = nw;
+        h = nh;
+    }
+    free(pixels);
+}
+
+void UnloadTileColorArray(TileColorArray* array)
+{
+    if (!array)
+    {
+        return;
+    }
+
+    if (array->texture)
+    {
+        GLState_DeleteTexture(array->texture);
+    }
+    memset(array, 0, sizeof(*array));
+}
+
+void Renderer_SetTilePalette(const Color* colors, int count)
+{
+    if (!g_renderer || !colors)
+    {
+        return;
+    }
+
+    float palette[RENDERER_TILE_PALETTE_SIZE * 4] = {0};
+    if (count > RENDERER_TILE_PALETTE_SIZE)
+    {
+        count = RENDERER_TILE_PALETTE_SIZE;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        palette[i * 4 + 0] = colors[i].r;
+        palette[i * 4 + 1] = colors[i].g;
+        palette[i * 4 + 2] = colors[i].b;
+        palette[i * 4 + 3] = colors[i].a;
+    }
+
+    if (memcmp(palette, g_renderer->tile_palette, sizeof(palette)) != 0)
+    {
+        memcpy(g_renderer->tile_palette, palette, sizeof(palette));
+        g_renderer->tile_palette_dirty = 1;
+    }
+}
+
+void Renderer_DrawTileMap(const TileMap* map, Rect dest)
+{
+    if (!g_renderer || IsD2DBackend(g_renderer) || !map || !map->texture)
+    {
+        return;
+    }
+
+    Renderer* r = g_renderer;
+    FlushBatch(r);
+    UseProgramWithProjection(r, r->tilemap_shader.id, r->tilemap_proj_uniform, &r->tilemap_proj_version);
+    if (r->tile_palette_dirty)
+    {
+        glUniform4fv(r->tilemap_palette_uniform, RENDERER_TILE_PALETTE_SIZE, r->tile_palette);
+        r->tile_palette_dirty = 0;
+        GLState_CountUniforms(1);
+    }
+    glUniform4f(r->tilemap_dest_uniform, dest.x, dest.y, dest.width, dest.height);
+    glUniform2f(r->tilemap_size_uniform, (float)map->width, (float)map->height);
+    GLState_CountUniforms(2);
+
+    GLState_BindTexture(GL_TEXTURE_2D, map->texture);
+    GLState_BindVertexArray(r->tilemap_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    r->draw_calls++;
+}
+
+void Renderer_DrawQuadsInstanced(const QuadInstance* instances, int count, unsigned int textureArray)
+{
+    if (!instances || count <= 0 || !g_renderer)
+    {
+        return;
+    }
+
+    if (IsD2DBackend(g_renderer))
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const QuadInstance* q = &instances[i];
+            Renderer_DrawRectangle((Rect){ q->x - q->width * 0.5f, q->y - q->height * 0.5f, q->width, q->height }, q->color);
+        }
+        return;
+    }
+
+    Renderer* r = g_renderer;
+    FlushBatch(r);
+
+    UseProgramWithProjection(r, r->instance_shader.id, r->instance_proj_uniform, &r->instance_proj_version);
+    int textured = textureArray != 0;
+    if (r->instance_textured_value != textured)
+    {
+        glUniform1i(r->instance_textured_uniform, textured);
+        r->instance_textured_value = textured;
+        GLState_CountUniforms(1);
+    }
+    else
+    {
+        GLState_SkipUniforms(1);
+    }
+    if (textured)
+    {
+        GLState_BindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+    }
+    GLState_BindVertexArray(r->instance_vao);
+
+    int done = 0;
+    while (done < count)
+    {
+        int n = count - done;
+        if (n > INSTANCE_MAX_PER_DRAW)
+        {
+            n = INSTANCE_MAX_PER_DRAW;
+        }
+
+        GLsizeiptr bytes = (GLsizeiptr)n * (GLsizeiptr)sizeof(InstanceVertex);
+        GLintptr offset = 0;
+        InstanceVertex* dst = (InstanceVertex*)StreamBuffer_Map(&r->instance_stream, bytes, sizeof(InstanceVertex), &offset);
+        if (!dst)
+        {
+            break;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            const QuadInstance* q = &instances[done + i];
+            dst[i].x = q->x;
+            dst[i].y = q->y;
+            dst[i].w = q->width;
+            dst[i].h = q->height;
+            dst[i].rotation = q->rotation;
+            dst[i].layer = q->layer;
+            dst[i].r = ColorByte(q->color.r);
+            dst[i].g = ColorByte(q->color.g);
+            dst[i].b = ColorByte(q->color.b);
+            dst[i].a = ColorByte(q->color.a);
+        }
+        StreamBuffer_Unmap(&r->instance_stream, bytes);
+        r->upload_bytes += (size_t)bytes;
+
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, n, (GLuint)(offset / (GLintptr)sizeof(InstanceVertex)));
+        r->draw_calls++;
+        done += n;
+    }
 }
 
 static bool EnsureFreeType(void)
@@ -1506,124 +1830,294 @@ static bool EnsureFreeType(void)
     return true;
 }
 
-static int NextPow2(int v)
+// outline width and shadow offset, in atlas texels, are the font size over this
+#define TEXT_EFFECT_DIVISOR 12.0f
+// distance field spread, in atlas texels, is the font size over this
+#define FONT_SDF_SPREAD_DIVISOR 8.0f
+#define FONT_ATLAS_SIZE 1024
+#define TEXT_CACHE_SIZE 256
+#define TEXT_CACHE_PROBE 8
+
+typedef struct TextQuad
+{
+    float x, y, w, h;
+    float u1, v1, u2, v2;
+} TextQuad;
+
+// Glyph quads of one string at one size, relative to the draw origin. Style is
+// not part of the key because outline and shadow are applied by the shader;
+// layouts from before a glyph eviction are rebuilt, so a cache hit marks its
+// glyphs as used to keep them out of the eviction order.
+typedef struct TextLayout
 {
-    int p = 1;
-    while (p < v)
+    unsigned int hash;
+    const Font* font;
+    float size;
+    char* text;
+    TextQuad* quads;
+    int count;
+    short* cells;       // atlas cell of every glyph the layout used, spaces included
+    int cell_count;
+    unsigned int generation;
+    unsigned int last_used;
+} TextLayout;
+
+static TextLayout g_text_cache[TEXT_CACHE_SIZE];
+static unsigned int g_text_cache_clock = 0;
+
+static void ReleaseTextLayout(TextLayout* layout)
+{
+    free(layout->text);
+    free(layout->quads);
+    free(layout->cells);
+    memset(layout, 0, sizeof(*layout));
+}
+
+static void ClearTextCache(const Font* font)
+{
+    for (int i = 0; i < TEXT_CACHE_SIZE; ++i)
     {
-        p <<= 1;
+        if (g_text_cache[i].text && (!font || g_text_cache[i].font == font))
+        {
+            ReleaseTextLayout(&g_text_cache[i]);
+        }
     }
-    return p;
 }
 
-Font* LoadFontTTF(const char* path, int pixel_size)
+static void BuildGlyphSDF(const FT_Bitmap* bitmap, unsigned char* out, int stride, int out_w, int out_h, int pad, float spread)
 {
-    if (!EnsureFreeType())
+    int w = (int)bitmap->width;
+    int h = (int)bitmap->rows;
+    int reach = (int)ceilf(spread);
+
+    for (int oy = 0; oy < out_h; ++oy)
     {
-        return NULL;
+        for (int ox = 0; ox < out_w; ++ox)
+        {
+            int gx = ox - pad;
+            int gy = oy - pad;
+            int inside = gx >= 0 && gy >= 0 && gx < w && gy < h &&
+                         bitmap->buffer[gy * bitmap->pitch + gx] >= 128;
+
+            int best = (reach + 1) * (reach + 1);
+            for (int dy = -reach; dy <= reach; ++dy)
+            {
+                int sy = gy + dy;
+                for (int dx = -reach; dx <= reach; ++dx)
+                {
+                    int d2 = dx * dx + dy * dy;
+                    if (d2 >= best)
+                    {
+                        continue;
+                    }
+                    int sx = gx + dx;
+                    int other = sx >= 0 && sy >= 0 && sx < w && sy < h &&
+                                bitmap->buffer[sy * bitmap->pitch + sx] >= 128;
+                    if (other != inside)
+                    {
+                        best = d2;
+                    }
+                }
+            }
+
+            float dist = sqrtf((float)best) - 0.5f;
+            if (dist > spread)
+            {
+                dist = spread;
+            }
+            float v = 0.5f + (inside ? dist : -dist) / (2.0f * spread);
+            out[oy * stride + ox] = ColorByte(v);
+        }
     }
+}
 
-    FT_Face face;
-    if (FT_New_Face(g_ft_lib, path, 0, &face))
+static void EvictGlyph(Font* font, Glyph* glyph)
+{
+    if (glyph->codepoint < 0)
     {
-        dbg_msg("Renderer", "Failed to load font: %s", path);
-        return NULL;
+        return;
     }
 
-    FT_Set_Pixel_Sizes(face, 0, pixel_size);
+    // quads already in the batch still point at this cell
+    if (g_renderer && g_renderer->batch_texture == font->atlas.id)
+    {
+        FlushBatch(g_renderer);
+    }
+    if (glyph->codepoint < 128)
+    {
+        font->ascii[glyph->codepoint] = -1;
+    }
+    glyph->codepoint = -1;
+    font->generation++;
+}
 
-    int max_h = 0;
-    int total_w = 0;
+static Glyph* RasterizeGlyph(Font* font, int codepoint)
+{
+    FT_Face face = (FT_Face)font->face;
+    FT_UInt index = FT_Get_Char_Index(face, (FT_ULong)codepoint);
+    if (index == 0 || FT_Load_Glyph(face, index, FT_LOAD_RENDER))
+    {
+        return NULL;
+    }
 
-    for (int c = 32; c < 127; ++c)
+    Glyph* slot = NULL;
+    for (int i = 0; i < font->glyph_capacity; ++i)
     {
-        if (FT_Load_Char(face, (FT_ULong)c, FT_LOAD_RENDER))
+        Glyph* g = &font->glyphs[i];
+        if (g->codepoint < 0)
         {
-            continue;
+            slot = g;
+            break;
         }
-        total_w += face->glyph->bitmap.width + 1;
-        if ((int)face->glyph->bitmap.rows > max_h)
+        if (g->last_used != font->clock && (!slot || g->last_used < slot->last_used))
         {
-            max_h = (int)face->glyph->bitmap.rows;
+            slot = g;
         }
     }
-
-    if (total_w <= 0 || max_h <= 0)
+    if (!slot)
     {
-        FT_Done_Face(face);
-        dbg_msg("Renderer", "Font has no renderable glyphs: %s", path);
         return NULL;
     }
+    EvictGlyph(font, slot);
+
+    FT_GlyphSlot ft = face->glyph;
+    int inner = font->cell_size - font->padding * 2;
+    FT_Bitmap bitmap = ft->bitmap;
+    if ((int)bitmap.width > inner) bitmap.width = (unsigned int)inner;
+    if ((int)bitmap.rows > inner) bitmap.rows = (unsigned int)inner;
 
-    int atlas_w = NextPow2(total_w);
-    int atlas_h = NextPow2(max_h);
-    size_t atlas_size = (size_t)atlas_w * (size_t)atlas_h * 4;
-    unsigned char* atlas = (unsigned char*)calloc(atlas_size, 1);
-    if (!atlas)
+    int out_w = (int)bitmap.width + font->padding * 2;
+    int out_h = (int)bitmap.rows + font->padding * 2;
+    // the whole cell is rewritten so nothing of an evicted glyph is left for the shadow tap
+    unsigned char* sdf = (unsigned char*)calloc((size_t)font->cell_size * (size_t)font->cell_size, 1);
+    if (!sdf)
     {
-        FT_Done_Face(face);
-        dbg_msg("Renderer", "Font atlas alloc failed: %s", path);
         return NULL;
     }
+    BuildGlyphSDF(&bitmap, sdf, font->cell_size, out_w, out_h, font->padding, font->spread);
 
-    Font* font = (Font*)calloc(1, sizeof(Font));
-    if (!font)
+    int cell = (int)(slot - font->glyphs);
+    int cell_x = (cell % font->columns) * font->cell_size;
+    int cell_y = (cell / font->columns) * font->cell_size;
+
+    GLState_BindTexture(GL_TEXTURE_2D, font->atlas.id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, cell_x, cell_y, font->cell_size, font->cell_size, GL_RED, GL_UNSIGNED_BYTE, sdf);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    free(sdf);
+
+    slot->codepoint = codepoint;
+    slot->x = cell_x + font->padding;
+    slot->y = cell_y + font->padding;
+    slot->width = (int)bitmap.width;
+    slot->height = (int)bitmap.rows;
+    slot->bearingX = ft->bitmap_left;
+    slot->bearingY = ft->bitmap_top;
+    slot->advance = (int)(ft->advance.x >> 6);
+    slot->last_used = font->clock;
+    if (codepoint < 128)
     {
-        free(atlas);
-        FT_Done_Face(face);
-        return NULL;
+        font->ascii[codepoint] = (short)cell;
     }
+    return slot;
+}
 
-    int x = 0;
-    for (int c = 32; c < 127; ++c)
+static Glyph* GetGlyph(Font* font, int codepoint)
+{
+    Glyph* glyph = NULL;
+    if (codepoint >= 0 && codepoint < 128)
     {
-        if (FT_Load_Char(face, (FT_ULong)c, FT_LOAD_RENDER))
+        if (font->ascii[codepoint] >= 0)
         {
-            continue;
+            glyph = &font->glyphs[font->ascii[codepoint]];
         }
-
-        FT_GlyphSlot g = face->glyph;
-        int w = (int)g->bitmap.width;
-        int h = (int)g->bitmap.rows;
-
-        Glyph* glyph = &font->glyphs[c];
-        glyph->x = x;
-        glyph->y = 0;
-        glyph->width = w;
-        glyph->height = h;
-        glyph->bearingX = g->bitmap_left;
-        glyph->bearingY = g->bitmap_top;
-        glyph->advance = (int)(g->advance.x >> 6);
-
-        for (int row = 0; row < h; ++row)
+    }
+    else
+    {
+        for (int i = 0; i < font->glyph_capacity; ++i)
         {
-            for (int col = 0; col < w; ++col)
+            if (font->glyphs[i].codepoint == codepoint)
             {
-                unsigned char alpha = g->bitmap.buffer[row * g->bitmap.pitch + col];
-                size_t idx = ((size_t)(glyph->y + row) * (size_t)atlas_w + (size_t)(glyph->x + col)) * 4;
-                atlas[idx + 0] = 255;
-                atlas[idx + 1] = 255;
-                atlas[idx + 2] = 255;
-                atlas[idx + 3] = alpha;
+                glyph = &font->glyphs[i];
+                break;
             }
         }
+    }
+
+    if (!glyph)
+    {
+        glyph = RasterizeGlyph(font, codepoint);
+    }
+    if (glyph)
+    {
+        glyph->last_used = font->clock;
+    }
+    return glyph;
+}
+
+Font* LoadFontTTF(const char* path, int pixel_size)
+{
+    if (!EnsureFreeType())
+    {
+        return NULL;
+    }
+
+    FT_Face face;
+    if (FT_New_Face(g_ft_lib, path, 0, &face))
+    {
+        dbg_msg("Renderer", "Failed to load font: %s", path);
+        return NULL;
+    }
+
+    FT_Set_Pixel_Sizes(face, 0, pixel_size);
+
+    Font* font = (Font*)calloc(1, sizeof(Font));
+    if (!font)
+    {
+        FT_Done_Face(face);
+        return NULL;
+    }
 
-        x += w + 1;
+    // the field must reach past the outline and the shadow tap
+    font->spread = (float)pixel_size / FONT_SDF_SPREAD_DIVISOR;
+    font->padding = (int)ceilf(font->spread + (float)pixel_size / TEXT_EFFECT_DIVISOR) + 1;
+    font->cell_size = (int)ceilf((float)pixel_size * 1.25f) + font->padding * 2;
+    font->columns = FONT_ATLAS_SIZE / font->cell_size;
+    font->glyph_capacity = font->columns * font->columns;
+    font->glyphs = (Glyph*)calloc((size_t)font->glyph_capacity, sizeof(Glyph));
+    if (font->columns <= 0 || !font->glyphs)
+    {
+        free(font->glyphs);
+        free(font);
+        FT_Done_Face(face);
+        dbg_msg("Renderer", "Font size %d too large for the glyph atlas: %s", pixel_size, path);
+        return NULL;
+    }
+    for (int i = 0; i < font->glyph_capacity; ++i)
+    {
+        font->glyphs[i].codepoint = -1;
+    }
+    for (int i = 0; i < 128; ++i)
+    {
+        font->ascii[i] = -1;
     }
 
+    // single channel distance field, read back as white with alpha = distance
+    GLint swizzle[4] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
     GLuint tex_id;
     glGenTextures(1, &tex_id);
-    glBindTexture(GL_TEXTURE_2D, tex_id);
+    GLState_BindTexture(GL_TEXTURE_2D, tex_id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas_w, atlas_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas);
-    free(atlas);
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, FONT_ATLAS_SIZE, FONT_ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
 
     font->atlas.id = tex_id;
-    font->atlas.width = atlas_w;
-    font->atlas.height = atlas_h;
+    font->atlas.width = FONT_ATLAS_SIZE;
+    font->atlas.height = FONT_ATLAS_SIZE;
+    font->face = face;
     font->size = pixel_size;
     font->ascent = (int)(face->size->metrics.ascender >> 6);
     font->descent = (int)(face->size->metrics.descender >> 6);
@@ -1633,7 +2127,10 @@ Font* LoadFontTTF(const char* path, int pixel_size)
         font->line_height = pixel_size;
     }
 
-    FT_Done_Face(face);
+    for (int c = 32; c < 127; ++c)
+    {
+        GetGlyph(font, c);
+    }
 
     return font;
 }
@@ -1645,11 +2142,22 @@ void UnloadFont(Font* font)
         return;
     }
 
+    ClearTextCache(font);
+
     if (font->atlas.id != 0)
     {
-        glDeleteTextures(1, &font->atlas.id);
+        if (g_renderer && g_renderer->batch_texture == font->atlas.id)
+        {
+            FlushBatch(g_renderer);
+        }
+        GLState_DeleteTexture(font->atlas.id);
     }
 
+    if (font->face)
+    {
+        FT_Done_Face((FT_Face)font->face);
+    }
+    free(font->glyphs);
     free(font);
 }
 
@@ -1667,7 +2175,7 @@ static Font* GetDefaultFont(void)
     if (!g_default_font && !g_default_font_attempted)
     {
         g_default_font_attempted = true;
-        g_default_font = LoadFontTTF("assets/arial.ttf", 56);
+        g_default_font = LoadFontTTF("assets/arial.ttf", 32);
         if (!g_default_font)
         {
             dbg_msg("Renderer", "Default font load failed (arial.ttf)");
@@ -1681,64 +2189,97 @@ void Renderer_DrawText(const char* text, float x, float y, float fontSize, Color
     Renderer_DrawTextEx(text, x, y, fontSize, color, TEXT_STYLE_NORMAL);
 }
 
-static void DrawTextPass(const char* text, float x, float y, float fontSize, Color color)
+static unsigned int HashText(const char* text, float size)
 {
-    if (!g_renderer || !text)
+    unsigned int h = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)text; *p; ++p)
     {
-        return;
+        h = (h ^ *p) * 16777619u;
     }
+    unsigned int bits;
+    memcpy(&bits, &size, sizeof(bits));
+    return (h ^ bits) * 16777619u;
+}
 
-    Font* font = GetDefaultFont();
-    if (!font)
+// decodes one UTF-8 sequence, returning U+FFFD for malformed input
+static int DecodeUTF8(const char** text)
+{
+    const unsigned char* p = (const unsigned char*)*text;
+    int cp = p[0];
+    int extra = 0;
+    if (cp < 0x80)
     {
-        return;
+        extra = 0;
+    }
+    else if ((cp & 0xE0) == 0xC0)
+    {
+        cp &= 0x1F;
+        extra = 1;
+    }
+    else if ((cp & 0xF0) == 0xE0)
+    {
+        cp &= 0x0F;
+        extra = 2;
+    }
+    else if ((cp & 0xF8) == 0xF0)
+    {
+        cp &= 0x07;
+        extra = 3;
+    }
+    else
+    {
+        *text += 1;
+        return 0xFFFD;
     }
 
-    float scale = fontSize / (float)font->size;
-    float pen_x = x;
-    float pen_y = y;
-    float baseline = floorf(pen_y + (float)font->ascent * scale + 0.5f);
-    float line_step = (float)font->line_height * scale;
-
-    int glyph_count = 0;
-    for (const char* p = text; *p; ++p)
+    for (int i = 1; i <= extra; ++i)
     {
-        unsigned char c = (unsigned char)(*p);
-        if (c == '\n' || c == '\t')
-        {
-            continue;
-        }
-        if (c < 32 || c >= 127)
+        if ((p[i] & 0xC0) != 0x80)
         {
-            continue;
-        }
-        Glyph* g = &font->glyphs[c];
-        if (g->width > 0 && g->height > 0)
-        {
-            glyph_count++;
+            *text += i;
+            return 0xFFFD;
         }
+        cp = (cp << 6) | (p[i] & 0x3F);
     }
+    *text += 1 + extra;
+    return cp;
+}
 
-    if (glyph_count == 0)
+static int BuildTextLayout(TextLayout* layout, Font* font, const char* text, float fontSize)
+{
+    size_t len = strlen(text);
+    layout->text = (char*)malloc(len + 1);
+    layout->quads = (TextQuad*)malloc(sizeof(TextQuad) * (len > 0 ? len : 1));
+    layout->cells = (short*)malloc(sizeof(short) * (len > 0 ? len : 1));
+    if (!layout->text || !layout->quads || !layout->cells)
     {
-        return;
+        ReleaseTextLayout(layout);
+        return 0;
     }
+    memcpy(layout->text, text, len + 1);
+    layout->font = font;
+    layout->size = fontSize;
+    layout->count = 0;
+    layout->cell_count = 0;
 
-    int vert_count = glyph_count * 6;
-    float* verts = (float*)malloc((size_t)vert_count * 8 * sizeof(float));
-    if (!verts)
-    {
-        return;
-    }
+    // glyphs stamped with this clock are never evicted while the string is laid out
+    font->clock++;
+
+    float scale = fontSize / (float)font->size;
+    float pad = (float)font->padding;
+    float pen_x = 0.0f;
+    float pen_y = 0.0f;
+    float baseline = floorf((float)font->ascent * scale + 0.5f);
+    float line_step = (float)font->line_height * scale;
 
-    int v = 0;
-    for (const char* p = text; *p; ++p)
+    const char* p = text;
+    while (*p)
     {
-        unsigned char c = (unsigned char)(*p);
+        int c = DecodeUTF8(&p);
 
         if (c == '\n')
         {
-            pen_x = x;
+            pen_x = 0.0f;
             pen_y += line_step;
             baseline = floorf(pen_y + (float)font->ascent * scale + 0.5f);
             continue;
@@ -1746,63 +2287,102 @@ static void DrawTextPass(const char* text, float x, float y, float fontSize, Col
 
         if (c == '\t')
         {
-            pen_x += (float)(font->glyphs[' '].advance * 4) * scale;
+            const Glyph* space = GetGlyph(font, ' ');
+            if (space)
+            {
+                layout->cells[layout->cell_count++] = (short)(space - font->glyphs);
+                pen_x += (float)(space->advance * 4) * scale;
+            }
             continue;
         }
 
-        if (c < 32 || c >= 127)
+        if (c < 32)
         {
             continue;
         }
 
-        Glyph* g = &font->glyphs[c];
-        if (g->width > 0 && g->height > 0)
+        const Glyph* g = GetGlyph(font, c);
+        if (!g)
         {
-            float xpos = pen_x + (float)g->bearingX * scale;
-            float ypos = baseline - (float)g->bearingY * scale;
-            xpos = floorf(xpos + 0.5f);
-            float w = (float)g->width * scale;
-            float h = (float)g->height * scale;
-
-            float u1 = (float)g->x / font->atlas.width;
-            float v1 = (float)g->y / font->atlas.height;
-            float u2 = (float)(g->x + g->width) / font->atlas.width;
-            float v2 = (float)(g->y + g->height) / font->atlas.height;
-
-            float x0 = xpos;
-            float y0 = ypos;
-            float x1 = xpos + w;
-            float y1 = ypos + h;
-
-            float r = color.r;
-            float gcol = color.g;
-            float b = color.b;
-            float a = color.a;
-
-            float quad[] =
+            g = GetGlyph(font, '?');
+            if (!g)
             {
-                x0, y0, u1, v1, r, gcol, b, a,
-                x1, y0, u2, v1, r, gcol, b, a,
-                x1, y1, u2, v2, r, gcol, b, a,
+                continue;
+            }
+        }
+        layout->cells[layout->cell_count++] = (short)(g - font->glyphs);
 
-                x1, y1, u2, v2, r, gcol, b, a,
-                x0, y1, u1, v2, r, gcol, b, a,
-                x0, y0, u1, v1, r, gcol, b, a
-            };
+        if (g->width > 0 && g->height > 0)
+        {
+            float xpos = floorf(pen_x + (float)g->bearingX * scale + 0.5f);
+            float ypos = baseline - (float)g->bearingY * scale;
 
-            memcpy(&verts[v * 8], quad, sizeof(quad));
-            v += 6;
+            TextQuad* q = &layout->quads[layout->count++];
+            q->x = xpos - pad * scale;
+            q->y = ypos - pad * scale;
+            q->w = ((float)g->width + pad * 2.0f) * scale;
+            q->h = ((float)g->height + pad * 2.0f) * scale;
+            q->u1 = ((float)g->x - pad) / font->atlas.width;
+            q->v1 = ((float)g->y - pad) / font->atlas.height;
+            q->u2 = ((float)(g->x + g->width) + pad) / font->atlas.width;
+            q->v2 = ((float)(g->y + g->height) + pad) / font->atlas.height;
         }
 
         pen_x += (float)g->advance * scale;
     }
 
-    if (v > 0)
+    layout->generation = font->generation;
+    return 1;
+}
+
+static const TextLayout* GetTextLayout(Font* font, const char* text, float fontSize)
+{
+    unsigned int hash = HashText(text, fontSize);
+    unsigned int clock = ++g_text_cache_clock;
+    TextLayout* victim = NULL;
+
+    for (int i = 0; i < TEXT_CACHE_PROBE; ++i)
     {
-        DrawTextBatch(font->atlas, verts, v);
+        TextLayout* e = &g_text_cache[(hash + (unsigned int)i) & (TEXT_CACHE_SIZE - 1)];
+        if (!e->text)
+        {
+            if (!victim || victim->text)
+            {
+                victim = e;
+            }
+            continue;
+        }
+        if (e->hash == hash && e->font == font && e->size == fontSize && strcmp(e->text, text) == 0)
+        {
+            if (e->generation == font->generation)
+            {
+                for (int c = 0; c < e->cell_count; ++c)
+                {
+                    font->glyphs[e->cells[c]].last_used = font->clock;
+                }
+                e->last_used = clock;
+                return e;
+            }
+            victim = e;
+            break;
+        }
+        if (!victim || (victim->text && e->last_used < victim->last_used))
+        {
+            victim = e;
+        }
     }
 
-    free(verts);
+    if (victim->text)
+    {
+        ReleaseTextLayout(victim);
+    }
+    if (!BuildTextLayout(victim, font, text, fontSize))
+    {
+        return NULL;
+    }
+    victim->hash = hash;
+    victim->last_used = clock;
+    return victim;
 }
 
 void Renderer_DrawTextEx(const char* text, float x, float y, float fontSize, Color color, TextStyle style)
@@ -1815,35 +2395,52 @@ void Renderer_DrawTextEx(const char* text, float x, float y, float fontSize, Col
         return;
     }
 
-    if (!text)
+    if (!g_renderer || !text)
     {
         return;
     }
 
-    int outline_px = (int)fmaxf(1.0f, floorf(fontSize / 12.0f));
-    Vec2 shadow_offset = { (float)outline_px, (float)outline_px };
-    Color shadow = { 0.0f, 0.0f, 0.0f, 0.65f };
-    Color outline = { 0.0f, 0.0f, 0.0f, 0.75f };
+    Font* font = GetDefaultFont();
+    if (!font)
+    {
+        return;
+    }
 
-    if (style == TEXT_STYLE_SHADOW || style == TEXT_STYLE_OUTLINE_SHADOW)
+    const TextLayout* layout = GetTextLayout(font, text, fontSize);
+    if (!layout)
     {
-        DrawTextPass(text, x + shadow_offset.x, y + shadow_offset.y, fontSize, shadow);
+        return;
     }
 
-    if (style == TEXT_STYLE_OUTLINE || style == TEXT_STYLE_OUTLINE_SHADOW)
+    float ox = floorf(x + 0.5f);
+    float oy = floorf(y + 0.5f);
+    float radius = (float)font->size / TEXT_EFFECT_DIVISOR;
+    int text_style = (int)style;
+
+    int done = 0;
+    while (done < layout->count)
     {
-        for (int oy = -outline_px; oy <= outline_px; ++oy)
+        int n = layout->count - done;
+        if (n > BATCH_MAX_QUADS)
         {
-            for (int ox = -outline_px; ox <= outline_px; ++ox)
-            {
-                if (ox == 0 && oy == 0)
-                {
-                    continue;
-                }
-                DrawTextPass(text, x + (float)ox, y + (float)oy, fontSize, outline);
-            }
+            n = BATCH_MAX_QUADS;
         }
-    }
 
-    DrawTextPass(text, x, y, fontSize, color);
+        RendererVertex* v = BatchReserveStyled(GL_TRIANGLES, font->atlas.id, 1.0f, text_style, radius, n * 4);
+        if (!v)
+        {
+            return;
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            const TextQuad* q = &layout->quads[done + i];
+            float x1 = ox + q->x;
+            float y1 = oy + q->y;
+            v = BatchVertex(v, x1, y1, q->u1, q->v1, color);
+            v = BatchVertex(v, x1 + q->w, y1, q->u2, q->v1, color);
+            v = BatchVertex(v, x1 + q->w, y1 + q->h, q->u2, q->v2, color);
+            v = BatchVertex(v, x1, y1 + q->h, q->u1, q->v2, color);
+        }
+        done += n;
+    }
 }
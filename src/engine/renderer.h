@@ -6,13 +6,24 @@
 #include "vmath.h"
 #include "window.h"
 #include "camera.h"
+#include "streambuffer.h"
 #include <GL/glew.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+#define RENDERER_TILE_PALETTE_SIZE 16
+
+typedef struct RendererVertex
+{
+    float x, y;
+    float u, v;
+    unsigned char r, g, b, a;
+} RendererVertex;
+
 typedef struct Renderer
 {
     Window* window;
@@ -25,33 +36,66 @@ typedef struct Renderer
     float camera_y;
     float camera_zoom;
     
-    Shader primitive_shader;
-    Shader texture_shader;
-    Shader text_shader;
-    
-    GLuint primitive_vao;
-    GLuint primitive_vbo;
-    GLuint primitive_color_vbo;
-    GLuint primitive_ibo;
-    
-    GLuint texture_vao;
-    GLuint texture_vbo;
-    GLuint texture_ibo;
+    Shader batch_shader;
+    GLuint batch_vao;
+    GLuint batch_ibo;
+    StreamBuffer batch_stream;
+    GLuint white_texture;
+
+    RendererVertex* batch_vertices;
+    int batch_count;
+    GLenum batch_mode;
+    GLuint batch_texture;
+    float batch_line_width;
+    int batch_text_style;
+    float batch_text_radius;
+
+    size_t upload_bytes;
+    size_t upload_bytes_last_frame;
+    int draw_calls;
+    int draw_calls_last_frame;
 
-    GLuint text_vao;
-    GLuint text_vbo;
-    
     GLint proj_uniform;
-    GLint transform_uniform;
+    GLint sampler_uniform;
+
+    // projection is uploaded lazily: each program remembers the version it last saw
+    float projection[16];
+    unsigned int projection_version;
+    unsigned int batch_proj_version;
+
+    Shader tilemap_shader;
+    GLuint tilemap_vao;
+    GLuint quad_vbo;
+    GLint tilemap_proj_uniform;
+    GLint tilemap_dest_uniform;
+    GLint tilemap_size_uniform;
+    GLint tilemap_palette_uniform;
+    unsigned int tilemap_proj_version;
+    float tile_palette[RENDERER_TILE_PALETTE_SIZE * 4];
+    int tile_palette_dirty;
+
+    Shader instance_shader;
+    GLuint instance_vao;
+    StreamBuffer instance_stream;
+    GLint instance_proj_uniform;
+    GLint instance_textured_uniform;
+    unsigned int instance_proj_version;
+    int instance_textured_value;
+
+    Shader text_shader;
     GLint text_proj_uniform;
-    GLint text_transform_uniform;
-    GLint text_sampler_uniform;
+    GLint text_style_uniform;
+    GLint text_radius_uniform;
+    unsigned int text_proj_version;
+    int text_style_value;
+    float text_radius_value;
 } Renderer;
 
 extern Renderer* g_renderer;
 
 typedef struct Glyph
 {
+    int codepoint;
     int x;
     int y;
     int width;
@@ -59,8 +103,12 @@ typedef struct Glyph
     int advance;
     int bearingX;
     int bearingY;
+    unsigned int last_used;
 } Glyph;
 
+// Glyphs are rasterized on demand as signed distance fields into fixed cells
+// of a single-channel atlas, so one font object serves every draw size. When
+// all cells are taken the least recently used glyph is evicted.
 typedef struct Font
 {
     Texture2D atlas;
@@ -68,9 +116,55 @@ typedef struct Font
     int ascent;
     int descent;
     int line_height;
-    Glyph glyphs[128];
+    int padding;
+    float spread;
+
+    void* face;
+    int cell_size;
+    int columns;
+    Glyph* glyphs;
+    int glyph_capacity;
+    short ascii[128];
+    unsigned int clock;
+    unsigned int generation;
 } Font;
 
+// Grid of tile ids kept in an R8UI texture; the tilemap shader maps each id
+// through the renderer's tile palette, so a whole grid is one quad.
+typedef struct TileMap
+{
+    GLuint texture;
+    int width;
+    int height;
+} TileMap;
+
+// Tile grids resolved through the tile palette to one RGBA texel per tile, each
+// in its own layer of a mip-mapped array texture. Drawn with
+// Renderer_DrawQuadsInstanced, so any number of grids is one draw call; the
+// mip chain keeps tiles smaller than a pixel from shimmering. Above one texel
+// per pixel the result matches Renderer_DrawTileMap exactly.
+typedef struct TileColorArray
+{
+    GLuint texture;
+    int width;
+    int height;
+    int layers;
+    int levels;
+} TileColorArray;
+
+// One quad of an instanced draw: center, size, rotation in radians and the
+// layer of the array texture it samples (ignored for untextured draws).
+typedef struct QuadInstance
+{
+    float x;
+    float y;
+    float width;
+    float height;
+    float rotation;
+    float layer;
+    Color color;
+} QuadInstance;
+
 typedef enum TextStyle
 {
     TEXT_STYLE_NORMAL = 0,
@@ -79,14 +173,36 @@ typedef enum TextStyle
     TEXT_STYLE_OUTLINE_SHADOW = 3
 } TextStyle;
 
+typedef enum TextureFilter
+{
+    TEXTURE_FILTER_POINT = 0,
+    TEXTURE_FILTER_BILINEAR = 1
+} TextureFilter;
+
+typedef enum TextureWrap
+{
+    TEXTURE_WRAP_CLAMP = 0,
+    TEXTURE_WRAP_REPEAT = 1
+} TextureWrap;
+
 typedef enum RendererBackend
 {
     RENDERER_BACKEND_OPENGL = 0,
     RENDERER_BACKEND_DIRECT2D = 1
 } RendererBackend;
 
+unsigned char* LoadPNGPixels(const char* path, int* width, int* height);
+void UnloadPNGPixels(unsigned char* pixels);
+Texture2D* LoadTextureFromPixels(const unsigned char* pixels, int width, int height);
 Texture2D* LoadTexture(const char* path);
 void UnloadTexture(Texture2D* texture);
+// Replaces an RGBA region of a standalone texture.
+void UpdateTextureRec(Texture2D* texture, Rect rec, const unsigned char* pixels);
+void SetTextureFilter(Texture2D* texture, TextureFilter filter);
+void SetTextureWrap(Texture2D* texture, TextureWrap wrap);
+
+Shader LoadShaderFromMemory(const char* vert_src, const char* frag_src);
+void UnloadShader(Shader shader);
 
 void SetGlobalRenderer(Renderer* r);
 Renderer* GetGlobalRenderer(void);
@@ -99,6 +215,10 @@ const char* Renderer_GetBackendName(RendererBackend backend);
 
 void Renderer_BeginFrame(Renderer* r);
 void Renderer_EndFrame(Renderer* r);
+void Renderer_Flush(void);
+void Renderer_SetProjection(const float* projection);
+size_t Renderer_GetFrameUploadBytes(void);
+int    Renderer_GetFrameDrawCalls(void);
 
 void Renderer_Clear(Color color);
 
@@ -121,6 +241,20 @@ void Renderer_DrawTextureRec(Texture2D texture, Rect source, Vec2 position, Colo
 void Renderer_DrawTextureEx(Texture2D texture, Vec2 position, float rotation, float scale, Color tint);
 void Renderer_DrawTexturePro(Texture2D texture, Rect source, Rect dest, Vec2 origin, float rotation, Color tint);
 
+
+TileMap LoadTileMap(int width, int height, const unsigned char* tiles);
+void UpdateTileMap(TileMap* map, const unsigned char* tiles);
+void UnloadTileMap(TileMap* map);
+void Renderer_SetTilePalette(const Color* colors, int count);
+void Renderer_DrawTileMap(const TileMap* map, Rect dest);
+
+TileColorArray LoadTileColorArray(int width, int height, int layers);
+// Colors `tiles` with the current tile palette and rebuilds the layer's mip chain.
+void UpdateTileColorLayer(TileColorArray* array, int layer, const unsigned char* tiles);
+void UnloadTileColorArray(TileColorArray* array);
+
+void Renderer_DrawQuadsInstanced(const QuadInstance* instances, int count, unsigned int textureArray);
+
 Font* LoadFontTTF(const char* path, int pixel_size);
 void  UnloadFont(Font* font);
 void  SetDefaultFont(Font* font);
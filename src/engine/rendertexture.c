@@ -1,10 +1,12 @@
 #include "rendertexture.h"
 #include "renderer.h"
 #include "forgesystem.h"
+#include "glstate.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
-static GLint g_default_framebuffer = 0;
+static GLuint g_default_framebuffer = 0;
 static GLint g_default_viewport[4];
 
 RenderTexture LoadRenderTexture(int width, int height)
@@ -18,7 +20,7 @@ RenderTexture LoadRenderTexture(int width, int height)
     }
 
     glGenTextures(1, &rt.texture.id);
-    glBindTexture(GL_TEXTURE_2D, rt.texture.id);
+    GLState_BindTexture(GL_TEXTURE_2D, rt.texture.id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -29,7 +31,7 @@ RenderTexture LoadRenderTexture(int width, int height)
     rt.texture.height = height;
 
     glGenFramebuffers(1, &rt.framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, rt.framebuffer);
+    GLState_BindFramebuffer(rt.framebuffer);
     
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rt.texture.id, 0);
 
@@ -45,8 +47,7 @@ RenderTexture LoadRenderTexture(int width, int height)
         UnloadRenderTexture(rt);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState_BindFramebuffer(0);
 
     dbg_msg("RenderTexture", "RenderTexture created: %dx%d", width, height);
 
@@ -60,9 +61,9 @@ void UnloadRenderTexture(RenderTexture rt)
         return;
     }
 
-    glDeleteFramebuffers(1, &rt.framebuffer);
+    GLState_DeleteFramebuffer(rt.framebuffer);
     glDeleteRenderbuffers(1, &rt.renderbuffer);
-    glDeleteTextures(1, &rt.texture.id);
+    GLState_DeleteTexture(rt.texture.id);
 
     dbg_msg("RenderTexture", "RenderTexture unloaded");
 }
@@ -74,11 +75,20 @@ void BeginTextureMode(RenderTexture rt)
         return;
     }
 
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &g_default_framebuffer);
-    glGetIntegerv(GL_VIEWPORT, g_default_viewport);
+    Renderer_Flush();
+    // the state cache already knows what to restore; querying GL would stall the pipeline
+    if (g_glstate.framebuffer == GLSTATE_UNKNOWN || g_glstate.viewport[2] < 0)
+    {
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+        glGetIntegerv(GL_VIEWPORT, g_glstate.viewport);
+        g_glstate.framebuffer = (GLuint)framebuffer;
+    }
+    g_default_framebuffer = g_glstate.framebuffer;
+    memcpy(g_default_viewport, g_glstate.viewport, sizeof(g_default_viewport));
 
-    glBindFramebuffer(GL_FRAMEBUFFER, rt.framebuffer);
-    glViewport(0, 0, rt.width, rt.height);
+    GLState_BindFramebuffer(rt.framebuffer);
+    GLState_Viewport(0, 0, rt.width, rt.height);
 
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -91,6 +101,7 @@ void EndTextureMode(void)
         return;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, g_default_framebuffer);
-    glViewport(g_default_viewport[0], g_default_viewport[1], g_default_viewport[2], g_default_viewport[3]);
+    Renderer_Flush();
+    GLState_BindFramebuffer(g_default_framebuffer);
+    GLState_Viewport(g_default_viewport[0], g_default_viewport[1], g_default_viewport[2], g_default_viewport[3]);
 }
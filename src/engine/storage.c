@@ -72,6 +72,8 @@ static int Storage_InsertChunkWithMode(ForgeWorld* world, int mode, Chunk* chunk
             world->chunkMap[dst].key = key;
             world->chunkMap[dst].chunk = chunk;
             world->chunkMap[dst].state = 1;
+            world->chunkMap[dst].modified = 1;
+            world->chunkMap[dst].revision = ++world->chunkRevision;
             world->chunkCount++;
             return 1;
         }
@@ -0,0 +1,206 @@
+#include "streambuffer.h"
+#include "forgesystem.h"
+#include <string.h>
+
+static int HasBufferStorage(void)
+{
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+static void NextSegment(StreamBuffer* sb)
+{
+    if (sb->fences[sb->segment])
+    {
+        glDeleteSync(sb->fences[sb->segment]);
+    }
+    sb->fences[sb->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    sb->segment = (sb->segment + 1) % STREAM_BUFFER_SEGMENTS;
+    sb->offset = 0;
+
+    GLsync fence = sb->fences[sb->segment];
+    if (!fence)
+    {
+        return;
+    }
+
+    // only blocks when the GPU is more than two segments behind
+    for (;;)
+    {
+        GLenum res = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        if (res != GL_TIMEOUT_EXPIRED)
+        {
+            break;
+        }
+    }
+    glDeleteSync(fence);
+    sb->fences[sb->segment] = NULL;
+}
+
+int StreamBuffer_Init(StreamBuffer* sb, GLenum target, GLsizeiptr size)
+{
+    if (!sb || size <= 0)
+    {
+        return 0;
+    }
+
+    memset(sb, 0, sizeof(*sb));
+    sb->target = target;
+    sb->segment_size = size;
+
+    glGenBuffers(1, &sb->buffer);
+    if (!sb->buffer)
+    {
+        return 0;
+    }
+    glBindBuffer(target, sb->buffer);
+
+    if (HasBufferStorage())
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, size * STREAM_BUFFER_SEGMENTS, NULL, flags);
+        sb->mapped = (unsigned char*)glMapBufferRange(target, 0, size * STREAM_BUFFER_SEGMENTS, flags);
+        if (sb->mapped)
+        {
+            sb->persistent = 1;
+        }
+        else
+        {
+            // immutable storage cannot be respecified, start over with a plain buffer
+            glDeleteBuffers(1, &sb->buffer);
+            glGenBuffers(1, &sb->buffer);
+            glBindBuffer(target, sb->buffer);
+        }
+    }
+
+    if (!sb->persistent)
+    {
+        glBufferData(target, size, NULL, GL_STREAM_DRAW);
+    }
+
+    dbg_msg("StreamBuffer", "%s stream buffer, %d KB",
+        sb->persistent ? "Persistent ring" : "Orphaning",
+        (int)((sb->persistent ? size * STREAM_BUFFER_SEGMENTS : size) / 1024));
+    return 1;
+}
+
+void StreamBuffer_Destroy(StreamBuffer* sb)
+{
+    if (!sb || !sb->buffer)
+    {
+        return;
+    }
+
+    for (int i = 0; i < STREAM_BUFFER_SEGMENTS; ++i)
+    {
+        if (sb->fences[i])
+        {
+            glDeleteSync(sb->fences[i]);
+            sb->fences[i] = NULL;
+        }
+    }
+
+    if (sb->persistent)
+    {
+        glBindBuffer(sb->target, sb->buffer);
+        glUnmapBuffer(sb->target);
+        sb->mapped = NULL;
+    }
+
+    glDeleteBuffers(1, &sb->buffer);
+    sb->buffer = 0;
+}
+
+void* StreamBuffer_Map(StreamBuffer* sb, GLsizeiptr bytes, GLsizeiptr align, GLintptr* out_offset)
+{
+    if (!sb || !sb->buffer || bytes <= 0 || bytes > sb->segment_size)
+    {
+        return NULL;
+    }
+    if (align < 1)
+    {
+        align = 1;
+    }
+
+    if (sb->persistent)
+    {
+        GLintptr base = (GLintptr)sb->segment * sb->segment_size;
+        GLintptr start = (base + sb->offset + align - 1) / align * align;
+        if (start + bytes > base + sb->segment_size)
+        {
+            NextSegment(sb);
+            base = (GLintptr)sb->segment * sb->segment_size;
+            start = (base + align - 1) / align * align;
+            if (start + bytes > base + sb->segment_size)
+            {
+                return NULL;
+            }
+        }
+        sb->offset = start - base;
+        if (out_offset) *out_offset = start;
+        return sb->mapped + start;
+    }
+
+    GLintptr start = (sb->offset + align - 1) / align * align;
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+
+    glBindBuffer(sb->target, sb->buffer);
+    if (start + bytes > sb->segment_size)
+    {
+        // orphan: the driver hands out fresh storage while the GPU drains the old one
+        glBufferData(sb->target, sb->segment_size, NULL, GL_STREAM_DRAW);
+        start = 0;
+        access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+    }
+
+    void* ptr = glMapBufferRange(sb->target, start, bytes, access);
+    if (!ptr)
+    {
+        return NULL;
+    }
+    sb->offset = start;
+    if (out_offset) *out_offset = start;
+    return ptr;
+}
+
+void StreamBuffer_Unmap(StreamBuffer* sb, GLsizeiptr bytes)
+{
+    if (!sb || !sb->buffer)
+    {
+        return;
+    }
+
+    if (!sb->persistent)
+    {
+        glBindBuffer(sb->target, sb->buffer);
+        glUnmapBuffer(sb->target);
+    }
+    sb->offset += bytes;
+}
+
+GLintptr StreamBuffer_Upload(StreamBuffer* sb, const void* data, GLsizeiptr bytes, GLsizeiptr align)
+{
+    GLintptr offset = 0;
+    void* dst = StreamBuffer_Map(sb, bytes, align, &offset);
+    if (!dst)
+    {
+        return -1;
+    }
+    memcpy(dst, data, (size_t)bytes);
+    StreamBuffer_Unmap(sb, bytes);
+    return offset;
+}
+
+void StreamBuffer_EndFrame(StreamBuffer* sb)
+{
+    if (!sb || !sb->buffer)
+    {
+        return;
+    }
+
+    // each frame writes its own segment, so the CPU never waits on the frame the GPU is drawing
+    if (sb->persistent && sb->offset > 0)
+    {
+        NextSegment(sb);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef __FORGE_STREAMBUFFER_H__
+#define __FORGE_STREAMBUFFER_H__
+
+#include <GL/glew.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define STREAM_BUFFER_SEGMENTS 3
+
+// Write-once-per-draw GPU buffer for dynamic geometry. With GL 4.4 or
+// ARB_buffer_storage it is a persistently mapped ring of fenced segments,
+// otherwise it maps unsynchronized ranges and orphans the storage when full.
+typedef struct StreamBuffer
+{
+    GLuint buffer;
+    GLenum target;
+    GLsizeiptr segment_size;
+    int persistent;
+    int segment;
+    GLsizeiptr offset;
+    GLsync fences[STREAM_BUFFER_SEGMENTS];
+    unsigned char* mapped;
+} StreamBuffer;
+
+int   StreamBuffer_Init(StreamBuffer* sb, GLenum target, GLsizeiptr size);
+void  StreamBuffer_Destroy(StreamBuffer* sb);
+
+// returns a pointer to write 'bytes' into and the buffer offset of that range,
+// aligned to 'align' so callers can draw from offset / stride
+void* StreamBuffer_Map(StreamBuffer* sb, GLsizeiptr bytes, GLsizeiptr align, GLintptr* out_offset);
+void  StreamBuffer_Unmap(StreamBuffer* sb, GLsizeiptr bytes);
+GLintptr StreamBuffer_Upload(StreamBuffer* sb, const void* data, GLsizeiptr bytes, GLsizeiptr align);
+
+void  StreamBuffer_EndFrame(StreamBuffer* sb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FORGE_STREAMBUFFER_H__
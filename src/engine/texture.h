@@ -13,6 +13,12 @@ typedef struct Texture2D
     int height;
     void* native_handle;
     char path[260];
+
+    // sub-rect inside a shared atlas page; atlas_width is 0 for standalone textures
+    int atlas_x;
+    int atlas_y;
+    int atlas_width;
+    int atlas_height;
 } Texture2D;
 
 #ifdef __cplusplus
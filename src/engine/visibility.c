@@ -0,0 +1,184 @@
+#include "visibility.h"
+#include "forgesystem.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+Rect Visibility_GetCameraRect(Camera2D camera, int screen_width, int screen_height)
+{
+    float zoom = camera.zoom > 0.0f ? camera.zoom : 1.0f;
+    return (Rect){ camera.x, camera.y, (float)screen_width / zoom, (float)screen_height / zoom };
+}
+
+Rect Visibility_ExpandRect(Rect rect, float margin)
+{
+    return (Rect){ rect.x - margin, rect.y - margin, rect.width + margin * 2.0f, rect.height + margin * 2.0f };
+}
+
+int Visibility_RectOverlaps(Rect view, Rect bounds)
+{
+    return bounds.x < view.x + view.width && bounds.x + bounds.width > view.x &&
+           bounds.y < view.y + view.height && bounds.y + bounds.height > view.y;
+}
+
+int Visibility_PointVisible(Rect view, float x, float y, float radius)
+{
+    return x + radius > view.x && x - radius < view.x + view.width &&
+           y + radius > view.y && y - radius < view.y + view.height;
+}
+
+VisibilityRange Visibility_GetCellRange(Rect view, float cell_size)
+{
+    VisibilityRange range;
+    range.x0 = (int)floorf(view.x / cell_size);
+    range.y0 = (int)floorf(view.y / cell_size);
+    range.x1 = (int)floorf((view.x + view.width) / cell_size) + 1;
+    range.y1 = (int)floorf((view.y + view.height) / cell_size) + 1;
+    return range;
+}
+
+int Visibility_IsTooSmall(Camera2D camera, float world_size)
+{
+    return world_size * camera.zoom < VISIBILITY_MIN_PIXELS;
+}
+
+static int CellBucket(const VisibilityGrid* grid, int cell_x, int cell_y)
+{
+    unsigned int h = (unsigned int)cell_x * 73856093u ^ (unsigned int)cell_y * 19349663u;
+    return (int)(h & (unsigned int)grid->bucket_mask);
+}
+
+int Visibility_InitGrid(VisibilityGrid* grid, float cell_size, int bucket_count)
+{
+    if (!grid || cell_size <= 0.0f || bucket_count <= 0)
+    {
+        return 0;
+    }
+
+    memset(grid, 0, sizeof(*grid));
+    int buckets = 1;
+    while (buckets < bucket_count)
+    {
+        buckets <<= 1;
+    }
+
+    grid->buckets = (int*)malloc(sizeof(int) * (size_t)buckets);
+    if (!grid->buckets)
+    {
+        dbg_msg("Visibility", "Failed to allocate %d grid buckets", buckets);
+        return 0;
+    }
+    grid->cell_size = cell_size;
+    grid->bucket_mask = buckets - 1;
+    Visibility_ClearGrid(grid);
+    return 1;
+}
+
+void Visibility_FreeGrid(VisibilityGrid* grid)
+{
+    if (!grid)
+    {
+        return;
+    }
+    free(grid->buckets);
+    free(grid->entries);
+    memset(grid, 0, sizeof(*grid));
+}
+
+void Visibility_ClearGrid(VisibilityGrid* grid)
+{
+    if (!grid || !grid->buckets)
+    {
+        return;
+    }
+    memset(grid->buckets, 0xFF, sizeof(int) * (size_t)(grid->bucket_mask + 1));
+    grid->count = 0;
+    grid->max_radius = 0.0f;
+}
+
+int Visibility_Insert(VisibilityGrid* grid, int id, float x, float y, float radius)
+{
+    if (!grid || !grid->buckets)
+    {
+        return 0;
+    }
+
+    if (grid->count == grid->capacity)
+    {
+        int capacity = grid->capacity ? grid->capacity * 2 : 256;
+        VisibilityEntry* entries = (VisibilityEntry*)realloc(grid->entries, sizeof(VisibilityEntry) * (size_t)capacity);
+        if (!entries)
+        {
+            return 0;
+        }
+        grid->entries = entries;
+        grid->capacity = capacity;
+    }
+
+    VisibilityEntry* e = &grid->entries[grid->count];
+    e->id = id;
+    e->cell_x = (int)floorf(x / grid->cell_size);
+    e->cell_y = (int)floorf(y / grid->cell_size);
+    e->x = x;
+    e->y = y;
+    e->radius = radius;
+
+    int bucket = CellBucket(grid, e->cell_x, e->cell_y);
+    e->next = grid->buckets[bucket];
+    grid->buckets[bucket] = grid->count;
+    grid->count++;
+
+    if (radius > grid->max_radius)
+    {
+        grid->max_radius = radius;
+    }
+    return 1;
+}
+
+int Visibility_Query(const VisibilityGrid* grid, Rect view, int* out_ids, int max_ids)
+{
+    if (!grid || !grid->buckets || !out_ids || max_ids <= 0 || grid->count == 0)
+    {
+        return 0;
+    }
+
+    // an entity is filed under its center, so look that much further out
+    VisibilityRange range = Visibility_GetCellRange(Visibility_ExpandRect(view, grid->max_radius), grid->cell_size);
+    long long cells = (long long)(range.x1 - range.x0) * (long long)(range.y1 - range.y0);
+    int found = 0;
+
+    // a view wider than the table would revisit buckets; scanning everything is cheaper
+    if (cells > (long long)grid->bucket_mask + 1)
+    {
+        for (int i = 0; i < grid->count && found < max_ids; ++i)
+        {
+            const VisibilityEntry* e = &grid->entries[i];
+            if (Visibility_PointVisible(view, e->x, e->y, e->radius))
+            {
+                out_ids[found++] = e->id;
+            }
+        }
+        return found;
+    }
+
+    for (int cy = range.y0; cy < range.y1; ++cy)
+    {
+        for (int cx = range.x0; cx < range.x1; ++cx)
+        {
+            for (int i = grid->buckets[CellBucket(grid, cx, cy)]; i >= 0; i = grid->entries[i].next)
+            {
+                const VisibilityEntry* e = &grid->entries[i];
+                if (e->cell_x != cx || e->cell_y != cy || !Visibility_PointVisible(view, e->x, e->y, e->radius))
+                {
+                    continue;
+                }
+                out_ids[found++] = e->id;
+                if (found == max_ids)
+                {
+                    return found;
+                }
+            }
+        }
+    }
+    return found;
+}
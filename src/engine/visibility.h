@@ -0,0 +1,66 @@
+#ifndef __FORGE_VISIBILITY_H__
+#define __FORGE_VISIBILITY_H__
+
+#include "vmath.h"
+#include "camera.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// entities smaller than this on screen are not drawn
+#define VISIBILITY_MIN_PIXELS 0.5f
+
+// Cell range, start inclusive and end exclusive.
+typedef struct VisibilityRange
+{
+    int x0, y0;
+    int x1, y1;
+} VisibilityRange;
+
+// World-space rectangle the camera shows on a screen of the given size.
+Rect Visibility_GetCameraRect(Camera2D camera, int screen_width, int screen_height);
+Rect Visibility_ExpandRect(Rect rect, float margin);
+int  Visibility_RectOverlaps(Rect view, Rect bounds);
+int  Visibility_PointVisible(Rect view, float x, float y, float radius);
+// Cells of `cell_size` world units that overlap the view.
+VisibilityRange Visibility_GetCellRange(Rect view, float cell_size);
+// Screen-space size culling: is `world_size` smaller than VISIBILITY_MIN_PIXELS at this zoom?
+int  Visibility_IsTooSmall(Camera2D camera, float world_size);
+
+typedef struct VisibilityEntry
+{
+    int id;
+    int cell_x, cell_y;
+    float x, y;
+    float radius;
+    int next;
+} VisibilityEntry;
+
+// Hashed uniform grid of entity points. Rebuilt with Clear + Insert whenever
+// the entities move; queries visit only the cells under the view.
+typedef struct VisibilityGrid
+{
+    float cell_size;
+    float max_radius;   // largest radius inserted since the last clear
+    int* buckets;       // first entry per bucket, -1 when empty
+    int bucket_mask;
+    VisibilityEntry* entries;
+    int count;
+    int capacity;
+} VisibilityGrid;
+
+int  Visibility_InitGrid(VisibilityGrid* grid, float cell_size, int bucket_count);
+void Visibility_FreeGrid(VisibilityGrid* grid);
+void Visibility_ClearGrid(VisibilityGrid* grid);
+int  Visibility_Insert(VisibilityGrid* grid, int id, float x, float y, float radius);
+// Writes ids of entities whose point plus radius may overlap `view`; returns how
+// many were written, at most `max_ids`.
+int  Visibility_Query(const VisibilityGrid* grid, Rect view, int* out_ids, int max_ids);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FORGE_VISIBILITY_H__
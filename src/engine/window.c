@@ -2,21 +2,41 @@
 #include "input.h"
 #include "timer.h"
 #include <GL/glew.h>
+#include <stdlib.h>
 
-Window* Window_Create(int w, int h, const char* title)
+static Window* CreateGLWindow(int w, int h, const char* title, Uint32 flags)
 {
-    Window* win = malloc(sizeof(Window));
+    Window* win = calloc(1, sizeof(Window));
+    if (!win)
+    {
+        return NULL;
+    }
 
     win->handle = SDL_CreateWindow(
         title,
         SDL_WINDOWPOS_CENTERED,
         SDL_WINDOWPOS_CENTERED,
         w, h,
-        SDL_WINDOW_OPENGL
+        SDL_WINDOW_OPENGL | flags
     );
+    if (!win->handle)
+    {
+        dbg_msg("Window", "Failed to create window: %s", SDL_GetError());
+        free(win);
+        return NULL;
+    }
 
     win->gl = SDL_GL_CreateContext(win->handle);
+    if (!win->gl)
+    {
+        dbg_msg("Window", "Failed to create GL context: %s", SDL_GetError());
+        SDL_DestroyWindow(win->handle);
+        free(win);
+        return NULL;
+    }
 
+    // under EGL (SDL's offscreen driver) glewInit reports a missing GLX display
+    // even though every entry point loaded, so its result is not checked
     glewExperimental = GL_TRUE;
     glewInit();
 
@@ -26,8 +46,28 @@ Window* Window_Create(int w, int h, const char* title)
 
     Input_Init();
 
-    dbg_msg("Window", "Window created: %s (%dx%d)", title, w, h);
+    return win;
+}
 
+Window* Window_Create(int w, int h, const char* title)
+{
+    Window* win = CreateGLWindow(w, h, title, 0);
+    if (win)
+    {
+        dbg_msg("Window", "Window created: %s (%dx%d)", title, w, h);
+    }
+    return win;
+}
+
+Window* Window_CreateOffscreen(int w, int h)
+{
+    Window* win = CreateGLWindow(w, h, "offscreen", SDL_WINDOW_HIDDEN);
+    if (win)
+    {
+        win->offscreen = 1;
+        dbg_msg("Window", "Offscreen window created (%dx%d) on video driver %s: %s",
+            w, h, SDL_GetCurrentVideoDriver(), (const char*)glGetString(GL_RENDERER));
+    }
     return win;
 }
 
@@ -63,4 +103,33 @@ int Window_ShouldClose(Window* w)
 void Window_SetTitle(Window* w, const char* title)
 {
     SDL_SetWindowTitle(w->handle, title);
-}
\ No newline at end of file
+}
+
+int Window_SetSwapInterval(Window* w, int interval)
+{
+    (void)w;
+    if (SDL_GL_SetSwapInterval(interval) == 0)
+    {
+        return interval;
+    }
+
+    if (interval == -1 && SDL_GL_SetSwapInterval(1) == 0)
+    {
+        dbg_msg("Window", "Adaptive vsync not supported, using vsync");
+        return 1;
+    }
+
+    dbg_msg("Window", "Failed to set swap interval %d: %s", interval, SDL_GetError());
+    return SDL_GL_GetSwapInterval();
+}
+
+int Window_GetRefreshRate(Window* w)
+{
+    SDL_DisplayMode mode;
+    int display = SDL_GetWindowDisplayIndex(w->handle);
+    if (display < 0 || SDL_GetCurrentDisplayMode(display, &mode) != 0 || mode.refresh_rate <= 0)
+    {
+        return 60;
+    }
+    return mode.refresh_rate;
+}
@@ -16,9 +16,14 @@ typedef struct Window
     int width;
     int height;
     int should_close;
+    int offscreen;
 } Window;
 
 Window* Window_Create(int w, int h, const char* title);
+// Hidden window with a full GL context, for benchmarks and headless runs.
+// With SDL_VIDEODRIVER=offscreen no display is needed (EGL pbuffer), and
+// LIBGL_ALWAYS_SOFTWARE=1 selects Mesa llvmpipe. Returns NULL on failure.
+Window* Window_CreateOffscreen(int w, int h);
 void    Window_Destroy(Window* w);
 
 void    Window_PollEvents(Window* w);
@@ -26,6 +31,11 @@ int     Window_ShouldClose(Window* w);
 
 void    Window_SetTitle(Window* w, const char* title);
 
+// interval: 1 = vsync, -1 = adaptive (late frames tear instead of waiting), 0 = off.
+// Returns the interval that was actually applied.
+int     Window_SetSwapInterval(Window* w, int interval);
+int     Window_GetRefreshRate(Window* w);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,7 +36,7 @@ static unsigned int World_Hash3(int a, int b, int c)
     return h;
 }
 
-static Chunk* World_GetChunk(ForgeWorld* world, int cx, int cy, int mode)
+static ChunkSlot* World_FindSlot(ForgeWorld* world, int cx, int cy, int mode)
 {
     long long key = ChunkKey(cx, cy, mode);
     unsigned int idx = ChunkHash(key, (unsigned int)world->chunkCapacity);
@@ -46,11 +46,17 @@ static Chunk* World_GetChunk(ForgeWorld* world, int cx, int cy, int mode)
         if (world->chunkMap[i].state == 0)
             return NULL;
         if (world->chunkMap[i].state == 1 && world->chunkMap[i].key == key)
-            return world->chunkMap[i].chunk;
+            return &world->chunkMap[i];
     }
     return NULL;
 }
 
+static Chunk* World_GetChunk(ForgeWorld* world, int cx, int cy, int mode)
+{
+    ChunkSlot* slot = World_FindSlot(world, cx, cy, mode);
+    return slot ? slot->chunk : NULL;
+}
+
 static int World_InsertChunk(ForgeWorld* world, int cx, int cy, int mode, Chunk* chunk)
 {
     if (world->chunkCount >= world->chunkCapacity)
@@ -58,6 +64,7 @@ static int World_InsertChunk(ForgeWorld* world, int cx, int cy, int mode, Chunk*
     long long key = ChunkKey(cx, cy, mode);
     unsigned int idx = ChunkHash(key, (unsigned int)world->chunkCapacity);
     unsigned int tombstone = (unsigned int)(-1);
+    unsigned int dst = (unsigned int)(-1);
     for (unsigned int n = 0; n < (unsigned int)world->chunkCapacity; n++)
     {
         unsigned int i = (idx + n) % (unsigned int)world->chunkCapacity;
@@ -69,15 +76,23 @@ static int World_InsertChunk(ForgeWorld* world, int cx, int cy, int mode, Chunk*
 
         if (world->chunkMap[i].state == 0)
         {
-            unsigned int dst = (tombstone != (unsigned int)(-1)) ? tombstone : i;
-            world->chunkMap[dst].key = key;
-            world->chunkMap[dst].chunk = chunk;
-            world->chunkMap[dst].state = 1;
-            world->chunkCount++;
-            return 1;
+            dst = i;
+            break;
         }
     }
-    return 0;
+    /* a full map has no empty slot left, only the ones World_EvictFarChunk freed */
+    if (tombstone != (unsigned int)(-1))
+        dst = tombstone;
+    if (dst == (unsigned int)(-1))
+        return 0;
+
+    world->chunkMap[dst].key = key;
+    world->chunkMap[dst].chunk = chunk;
+    world->chunkMap[dst].state = 1;
+    world->chunkMap[dst].modified = 0;
+    world->chunkMap[dst].revision = ++world->chunkRevision;
+    world->chunkCount++;
+    return 1;
 }
 
 static unsigned int World_Rand(ForgeWorld* world)
@@ -177,6 +192,21 @@ int World_SpawnMob(ForgeWorld* world, int type, float x, float y)
     return 1;
 }
 
+int World_SetMobCapacity(ForgeWorld* world, int capacity)
+{
+    if (!world || capacity < world->mobCount)
+        return 0;
+    if (capacity == world->mobCapacity)
+        return 1;
+
+    Mob* mobs = realloc(world->mobs, (size_t)(capacity > 0 ? capacity : 1) * sizeof(*mobs));
+    if (!mobs)
+        return 0;
+    world->mobs = mobs;
+    world->mobCapacity = capacity;
+    return 1;
+}
+
 void World_UpdateMobs(ForgeWorld* world, float dt, int isNight, float playerX, float playerY, float playerRadius, float* ioPlayerHP)
 {
     float px = playerX;
@@ -377,7 +407,8 @@ int World_PlayerAttack(ForgeWorld* world, float originX, float originY, float di
 
 static void GetBiomeData(int seed, float wx, float wy, float* out_height, float* out_temp, float* out_moisture)
 {
-    Perlin_Init(seed);
+    PerlinNoise noise;
+    Perlin_Init(&noise, seed);
 
     float scale = 70.0f;
     float invScale = 1.0f / scale;
@@ -385,20 +416,20 @@ static void GetBiomeData(int seed, float wx, float wy, float* out_height, float*
     float nx = wx * invScale;
     float ny = wy * invScale;
 
-    float h = FractalPerlin2D(nx, ny, 4, 0.5f);
-    float d = Perlin2D(nx * 2.2f, ny * 2.2f);
+    float h = FractalPerlin2D(&noise, nx, ny, 4, 0.5f);
+    float d = Perlin2D(&noise, nx * 2.2f, ny * 2.2f);
     float v = h * 0.8f + d * 0.2f;
 
-    float continent = FractalPerlin2D(nx * 0.15f, ny * 0.15f, 2, 0.5f);
+    float continent = FractalPerlin2D(&noise, nx * 0.15f, ny * 0.15f, 2, 0.5f);
     float oceanBias = (0.5f - continent) * 0.25f;
     float height = v + oceanBias;
 
-    float temp = FractalPerlin2D(nx * 0.08f, ny * 0.08f, 2, 0.5f);
+    float temp = FractalPerlin2D(&noise, nx * 0.08f, ny * 0.08f, 2, 0.5f);
     temp -= (height - 0.5f) * 0.6f;
     if (temp < 0.0f) temp = 0.0f;
     if (temp > 1.0f) temp = 1.0f;
 
-    float moisture = FractalPerlin2D(nx * 0.12f, ny * 0.12f, 3, 0.5f);
+    float moisture = FractalPerlin2D(&noise, nx * 0.12f, ny * 0.12f, 3, 0.5f);
 
     if (out_height) *out_height = height;
     if (out_temp) *out_temp = temp;
@@ -441,9 +472,10 @@ const char* World_GetBiomeName(ForgeWorld* world, int x, int y)
     }
 }
 
-void Chunk_Generate(Chunk* chunk, int seed, bool isCave, float waterAmount, float stoneAmount, float caveAmount)
+void Chunk_Generate(Chunk* chunk, int seed, int isCave, float waterAmount, float stoneAmount, float caveAmount)
 {
-    Perlin_Init(seed);
+    PerlinNoise noise;
+    Perlin_Init(&noise, seed);
 
     float scale = 70.0f;
     float invScale = 1.0f / scale;
@@ -476,33 +508,33 @@ void Chunk_Generate(Chunk* chunk, int seed, bool isCave, float waterAmount, floa
             float nx = wx * invScale;
             float ny = wy * invScale;
 
-            float h = FractalPerlin2D(nx, ny, 4, 0.5f);
-            float d = Perlin2D(nx * 2.2f, ny * 2.2f);
+            float h = FractalPerlin2D(&noise, nx, ny, 4, 0.5f);
+            float d = Perlin2D(&noise, nx * 2.2f, ny * 2.2f);
             float v = h * 0.8f + d * 0.2f;
 
-            float continent = FractalPerlin2D(nx * 0.15f, ny * 0.15f, 2, 0.5f);
+            float continent = FractalPerlin2D(&noise, nx * 0.15f, ny * 0.15f, 2, 0.5f);
             float oceanBias = (0.5f - continent) * 0.25f;
             float height = v + oceanBias;
 
-            float temp = FractalPerlin2D(nx * 0.08f, ny * 0.08f, 2, 0.5f);
+            float temp = FractalPerlin2D(&noise, nx * 0.08f, ny * 0.08f, 2, 0.5f);
             temp -= (height - 0.5f) * 0.6f;
             if (temp < 0.0f) temp = 0.0f;
             if (temp > 1.0f) temp = 1.0f;
 
-            float moisture = FractalPerlin2D(nx * 0.12f, ny * 0.12f, 3, 0.5f);
+            float moisture = FractalPerlin2D(&noise, nx * 0.12f, ny * 0.12f, 3, 0.5f);
 
             Tile* tile = &chunk->tiles[y * CHUNK_SIZE + x];
 
             if (isCave)
             {
-                float tunnel = FractalPerlin2D(nx * 0.26f + 100.0f, ny * 0.26f - 73.0f, 3, 0.55f);
-                float chamber = FractalPerlin2D(nx * 0.06f - 41.0f, ny * 0.06f + 59.0f, 2, 0.5f);
+                float tunnel = FractalPerlin2D(&noise, nx * 0.26f + 100.0f, ny * 0.26f - 73.0f, 3, 0.55f);
+                float chamber = FractalPerlin2D(&noise, nx * 0.06f - 41.0f, ny * 0.06f + 59.0f, 2, 0.5f);
                 float openValue = tunnel * 0.85f + chamber * 0.15f;
                 float openThreshold = 0.67f - caveAmount * 0.07f;
 
                 if (openValue > openThreshold)
                 {
-                    float puddle = FractalPerlin2D(nx * 0.33f + 17.0f, ny * 0.33f - 12.0f, 1, 0.5f);
+                    float puddle = FractalPerlin2D(&noise, nx * 0.33f + 17.0f, ny * 0.33f - 12.0f, 1, 0.5f);
                     tile->type = (puddle < 0.10f) ? TILE_WATER : TILE_DIRT;
                 }
                 else
@@ -526,7 +558,7 @@ void Chunk_Generate(Chunk* chunk, int seed, bool isCave, float waterAmount, floa
             }
             else if (height > mountainLevel)
             {
-                float stoneProb = FractalPerlin2D(nx * 0.06f, ny * 0.06f, 1, 0.5f);
+                float stoneProb = FractalPerlin2D(&noise, nx * 0.06f, ny * 0.06f, 1, 0.5f);
                 float stoneThreshold = 0.3f + stoneAmount * 0.3f;
                 if (stoneProb > stoneThreshold)
                 {
@@ -539,7 +571,7 @@ void Chunk_Generate(Chunk* chunk, int seed, bool isCave, float waterAmount, floa
             }
             else if (height > hillLevel)
             {
-                float stoneProb = FractalPerlin2D(nx * 0.06f, ny * 0.06f, 1, 0.5f);
+                float stoneProb = FractalPerlin2D(&noise, nx * 0.06f, ny * 0.06f, 1, 0.5f);
                 float stoneThreshold = 0.5f + stoneAmount * 0.2f;
                 if (stoneProb > stoneThreshold)
                 {
@@ -609,6 +641,7 @@ ForgeWorld* World_Create(int loadRadiusChunks, int seed)
     world->loadRadiusChunks = loadRadiusChunks > 0 ? loadRadiusChunks : WORLD_LOAD_RADIUS_CHUNKS;
     world->chunkCapacity = WORLD_CHUNK_CAPACITY;
     world->chunkCount = 0;
+    world->chunkRevision = 0;
     world->chunkMap = calloc(world->chunkCapacity, sizeof(*world->chunkMap));
     world->rngState = (unsigned int)(seed * 747796405u + 2891336453u);
     world->mobTypes = calloc(WORLD_MAX_MOB_TYPES, sizeof(*world->mobTypes));
@@ -631,6 +664,9 @@ ForgeWorld* World_Create(int loadRadiusChunks, int seed)
     world->waterAmount = 0.5f;
     world->stoneAmount = 0.5f;
     world->caveAmount = 0.5f;
+    world->edits = NULL;
+    world->editCount = 0;
+    world->editsDropped = 0;
 
     MobArchetype orange = {0};
     strncpy(orange.name, "orange_rect", sizeof(orange.name) - 1);
@@ -662,6 +698,7 @@ void World_Destroy(ForgeWorld* world)
             }
             free(world->chunkMap);
         }
+        free(world->edits);
         free(world->mobs);
         free(world->mobTypes);
         free(world);
@@ -830,88 +867,274 @@ void World_UpdateChunks(ForgeWorld* world, int centerChunkX, int centerChunkY)
     }
 }
 
-TileType World_GetTile(ForgeWorld* world, int x, int y)
+static void World_TileToChunk(int x, int y, int* outCx, int* outCy, int* outLx, int* outLy)
 {
     int cx = (int)(x < 0 ? (x - CHUNK_SIZE + 1) / CHUNK_SIZE : x / CHUNK_SIZE);
     int cy = (int)(y < 0 ? (y - CHUNK_SIZE + 1) / CHUNK_SIZE : y / CHUNK_SIZE);
+    int lx = x - cx * CHUNK_SIZE;
+    int ly = y - cy * CHUNK_SIZE;
+    if (lx < 0) lx += CHUNK_SIZE;
+    if (ly < 0) ly += CHUNK_SIZE;
+    *outCx = cx;
+    *outCy = cy;
+    *outLx = lx;
+    *outLy = ly;
+}
 
-    Chunk* chunk = World_GetChunk(world, cx, cy, world->isCave);
-    if (!chunk)
+static ChunkSlot* World_GetOrCreateSlot(ForgeWorld* world, int cx, int cy, int mode)
+{
+    ChunkSlot* slot = World_FindSlot(world, cx, cy, mode);
+    if (!slot)
     {
         if (world->chunkCount >= world->chunkCapacity)
-            return TILE_EMPTY;
+            return NULL;
 
         Chunk* newChunk = malloc(sizeof(Chunk));
         if (!newChunk)
-            return TILE_EMPTY;
+            return NULL;
 
         newChunk->cx = cx;
         newChunk->cy = cy;
         newChunk->generated = 0;
-        Chunk_Generate(newChunk, world->seed, world->isCave, world->waterAmount, world->stoneAmount, world->caveAmount);
+        Chunk_Generate(newChunk, world->seed, mode, world->waterAmount, world->stoneAmount, world->caveAmount);
 
-        if (!World_InsertChunk(world, cx, cy, world->isCave, newChunk))
+        if (!World_InsertChunk(world, cx, cy, mode, newChunk))
         {
             free(newChunk);
-            return TILE_EMPTY;
+            return NULL;
         }
 
-        chunk = newChunk;
+        slot = World_FindSlot(world, cx, cy, mode);
     }
 
-    if (!chunk->generated)
-        Chunk_Generate(chunk, world->seed, world->isCave, world->waterAmount, world->stoneAmount, world->caveAmount);
+    if (slot && !slot->chunk->generated)
+    {
+        Chunk_Generate(slot->chunk, world->seed, mode, world->waterAmount, world->stoneAmount, world->caveAmount);
+        slot->revision = ++world->chunkRevision;
+    }
 
-    int lx = x - cx * CHUNK_SIZE;
-    int ly = y - cy * CHUNK_SIZE;
-    if (lx < 0) lx += CHUNK_SIZE;
-    if (ly < 0) ly += CHUNK_SIZE;
+    return slot;
+}
 
-    return chunk->tiles[ly * CHUNK_SIZE + lx].type;
+TileType World_GetTile(ForgeWorld* world, int x, int y)
+{
+    int cx, cy, lx, ly;
+    World_TileToChunk(x, y, &cx, &cy, &lx, &ly);
+
+    ChunkSlot* slot = World_GetOrCreateSlot(world, cx, cy, world->isCave);
+    if (!slot)
+        return TILE_EMPTY;
+
+    return slot->chunk->tiles[ly * CHUNK_SIZE + lx].type;
+}
+
+static int World_SetTileInMode(ForgeWorld* world, int x, int y, int mode, TileType type, int logEdit)
+{
+    int cx, cy, lx, ly;
+    World_TileToChunk(x, y, &cx, &cy, &lx, &ly);
+
+    ChunkSlot* slot = World_GetOrCreateSlot(world, cx, cy, mode);
+    if (!slot)
+        return 0;
+
+    Tile* tile = &slot->chunk->tiles[ly * CHUNK_SIZE + lx];
+    if (tile->type == type)
+        return 1;
+
+    tile->type = type;
+    slot->modified = 1;
+    slot->revision = ++world->chunkRevision;
+
+    if (logEdit && world->edits)
+    {
+        if (world->editCount < WORLD_EDIT_LOG_CAPACITY)
+        {
+            TileEdit* e = &world->edits[world->editCount++];
+            e->x = x;
+            e->y = y;
+            e->mode = (unsigned char)(mode ? 1 : 0);
+            e->type = (unsigned char)type;
+        }
+        else
+        {
+            world->editsDropped++;
+        }
+    }
+    return 1;
 }
 
 int World_SetTile(ForgeWorld* world, int x, int y, TileType type)
 {
     if (!world) return 0;
-    
-    int cx = (int)(x < 0 ? (x - CHUNK_SIZE + 1) / CHUNK_SIZE : x / CHUNK_SIZE);
-    int cy = (int)(y < 0 ? (y - CHUNK_SIZE + 1) / CHUNK_SIZE : y / CHUNK_SIZE);
+    return World_SetTileInMode(world, x, y, world->isCave, type, 1);
+}
 
-    Chunk* chunk = World_GetChunk(world, cx, cy, world->isCave);
-    if (!chunk)
+void World_EnableEditLog(ForgeWorld* world, int enable)
+{
+    if (!world) return;
+
+    if (enable && !world->edits)
     {
-        if (world->chunkCount >= world->chunkCapacity)
-            return 0;
+        world->edits = malloc(sizeof(TileEdit) * WORLD_EDIT_LOG_CAPACITY);
+        world->editCount = 0;
+    }
+    else if (!enable && world->edits)
+    {
+        free(world->edits);
+        world->edits = NULL;
+        world->editCount = 0;
+    }
+}
 
-        Chunk* newChunk = malloc(sizeof(Chunk));
-        if (!newChunk)
-            return 0;
+int World_PopEdits(ForgeWorld* world, TileEdit* outEdits, int maxEdits)
+{
+    if (!world || !world->edits || !outEdits || maxEdits <= 0) return 0;
 
-        newChunk->cx = cx;
-        newChunk->cy = cy;
-        newChunk->generated = 0;
-        Chunk_Generate(newChunk, world->seed, world->isCave, world->waterAmount, world->stoneAmount, world->caveAmount);
+    if (world->editsDropped > 0)
+    {
+        dbg_msg("World", "Edit log overflowed, %d edits dropped", world->editsDropped);
+        world->editsDropped = 0;
+    }
+
+    int count = world->editCount < maxEdits ? world->editCount : maxEdits;
+    memcpy(outEdits, world->edits, sizeof(TileEdit) * (size_t)count);
+    world->editCount -= count;
+    if (world->editCount > 0)
+        memmove(world->edits, world->edits + count, sizeof(TileEdit) * (size_t)world->editCount);
+    return count;
+}
+
+int World_ApplyEdit(ForgeWorld* world, const TileEdit* edit, int logEdit)
+{
+    if (!world || !edit) return 0;
+    if (edit->type > TILE_CAVE_ENTRANCE) return 0;
+    return World_SetTileInMode(world, edit->x, edit->y, edit->mode, (TileType)edit->type, logEdit);
+}
+
+int World_GetChunkTiles(ForgeWorld* world, int cx, int cy, int mode, unsigned char* outTypes)
+{
+    if (!world || !outTypes) return 0;
+
+    ChunkSlot* slot = World_GetOrCreateSlot(world, cx, cy, mode ? 1 : 0);
+    if (!slot)
+        return 0;
+
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++)
+        outTypes[i] = (unsigned char)slot->chunk->tiles[i].type;
+    return 1;
+}
+
+int World_SetChunkTiles(ForgeWorld* world, int cx, int cy, int mode, const unsigned char* types)
+{
+    if (!world || !types) return 0;
+
+    ChunkSlot* slot = World_GetOrCreateSlot(world, cx, cy, mode ? 1 : 0);
+    if (!slot)
+        return 0;
+
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++)
+    {
+        unsigned char t = types[i];
+        slot->chunk->tiles[i].type = t <= TILE_CAVE_ENTRANCE ? (TileType)t : TILE_EMPTY;
+    }
+    slot->chunk->generated = 1;
+    slot->modified = 1;
+    slot->revision = ++world->chunkRevision;
+    return 1;
+}
+
+int World_EvictFarChunk(ForgeWorld* world, int cx, int cy, int mode, int* outCx, int* outCy, int* outMode, int* outModified)
+{
+    if (!world) return 0;
+
+    int best = -1;
+    long long bestScore = -1;
+    for (int i = 0; i < world->chunkCapacity; i++)
+    {
+        ChunkSlot* slot = &world->chunkMap[i];
+        if (slot->state != 1 || !slot->chunk)
+            continue;
 
-        if (!World_InsertChunk(world, cx, cy, world->isCave, newChunk))
+        long long dx = (long long)slot->chunk->cx - cx;
+        long long dy = (long long)slot->chunk->cy - cy;
+        long long score = dx * dx + dy * dy;
+        /* chunks of the other mode are not on screen, modified ones would have to be sent again */
+        if ((int)(slot->key & 1) != (mode ? 1 : 0))
+            score += 1LL << 40;
+        if (!slot->modified)
+            score += 1LL << 50;
+        if (score > bestScore)
         {
-            free(newChunk);
-            return 0;
+            bestScore = score;
+            best = i;
         }
-
-        chunk = newChunk;
     }
+    if (best < 0)
+        return 0;
 
-    int lx = x - cx * CHUNK_SIZE;
-    int ly = y - cy * CHUNK_SIZE;
-    if (lx < 0) lx += CHUNK_SIZE;
-    if (ly < 0) ly += CHUNK_SIZE;
+    ChunkSlot* slot = &world->chunkMap[best];
+    if (outCx) *outCx = slot->chunk->cx;
+    if (outCy) *outCy = slot->chunk->cy;
+    if (outMode) *outMode = (int)(slot->key & 1);
+    if (outModified) *outModified = slot->modified;
+
+    free(slot->chunk);
+    slot->chunk = NULL;
+    slot->state = 2;
+    slot->modified = 0;
+    world->chunkCount--;
+    return 1;
+}
 
-    if (lx >= 0 && lx < CHUNK_SIZE && ly >= 0 && ly < CHUNK_SIZE)
+int World_IsChunkModified(ForgeWorld* world, int cx, int cy, int mode)
+{
+    if (!world) return 0;
+    ChunkSlot* slot = World_FindSlot(world, cx, cy, mode ? 1 : 0);
+    return slot && slot->modified;
+}
+
+unsigned int World_GetChunkRevision(ForgeWorld* world, int cx, int cy, int mode)
+{
+    if (!world) return 0;
+    ChunkSlot* slot = World_GetOrCreateSlot(world, cx, cy, mode ? 1 : 0);
+    return slot ? slot->revision : 0;
+}
+
+unsigned int World_PeekChunkRevision(ForgeWorld* world, int cx, int cy, int mode)
+{
+    if (!world) return 0;
+    ChunkSlot* slot = World_FindSlot(world, cx, cy, mode ? 1 : 0);
+    return (slot && slot->chunk->generated) ? slot->revision : 0;
+}
+
+void World_DetectModifiedChunks(ForgeWorld* world)
+{
+    if (!world) return;
+
+    Chunk* generated = malloc(sizeof(Chunk));
+    if (!generated)
+        return;
+
+    int modifiedCount = 0;
+    for (int i = 0; i < world->chunkCapacity; i++)
     {
-        chunk->tiles[ly * CHUNK_SIZE + lx].type = type;
-        return 1;
+        ChunkSlot* slot = &world->chunkMap[i];
+        if (slot->state != 1 || !slot->chunk)
+            continue;
+
+        int mode = (int)(slot->key & 1LL);
+        generated->cx = slot->chunk->cx;
+        generated->cy = slot->chunk->cy;
+        generated->generated = 0;
+        Chunk_Generate(generated, world->seed, mode, world->waterAmount, world->stoneAmount, world->caveAmount);
+
+        slot->modified = memcmp(generated->tiles, slot->chunk->tiles, sizeof(generated->tiles)) != 0;
+        if (slot->modified)
+            modifiedCount++;
     }
-    return 0;
+
+    free(generated);
+    dbg_msg("World", "%d of %d chunks differ from generated terrain", modifiedCount, world->chunkCount);
 }
 
 Vec4 World_GetTileColor(TileType type)
@@ -46,8 +46,19 @@ typedef struct ChunkSlot
     long long key;
     Chunk* chunk;
     unsigned char state; /* 0=empty, 1=filled, 2=tombstone */
+    unsigned char modified; /* differs from what Chunk_Generate produces */
+    unsigned int revision; /* bumped from ForgeWorld.chunkRevision whenever the tiles change */
 } ChunkSlot;
 
+#define WORLD_EDIT_LOG_CAPACITY 4096
+
+typedef struct TileEdit
+{
+    int x, y;
+    unsigned char mode;
+    unsigned char type;
+} TileEdit;
+
 typedef struct MobArchetype MobArchetype;
 typedef struct Mob Mob;
 
@@ -60,6 +71,7 @@ typedef struct
     int chunkCapacity;
     int chunkCount;
     ChunkSlot* chunkMap;
+    unsigned int chunkRevision;
 
     unsigned int rngState;
 
@@ -77,6 +89,10 @@ typedef struct
     float waterAmount;
     float stoneAmount;
     float caveAmount;
+
+    TileEdit* edits;
+    int editCount;
+    int editsDropped;
 } ForgeWorld;
 
 void Chunk_Generate(Chunk* chunk, int seed, int isCave, float waterAmount, float stoneAmount, float caveAmount);
@@ -96,6 +112,20 @@ int  World_SetTile(ForgeWorld* world, int x, int y, TileType type);
 Vec4 World_GetTileColor(TileType type);
 int  World_IsTileSolid(TileType type);
 const char* World_GetBiomeName(ForgeWorld* world, int x, int y);
+
+void World_EnableEditLog(ForgeWorld* world, int enable);
+int  World_PopEdits(ForgeWorld* world, TileEdit* outEdits, int maxEdits);
+int  World_ApplyEdit(ForgeWorld* world, const TileEdit* edit, int logEdit);
+int  World_GetChunkTiles(ForgeWorld* world, int cx, int cy, int mode, unsigned char* outTypes);
+int  World_SetChunkTiles(ForgeWorld* world, int cx, int cy, int mode, const unsigned char* types);
+/* frees the loaded chunk farthest from (cx, cy) in `mode`, preferring chunks Chunk_Generate can
+   rebuild; reports which one went and whether it was modified, returns 0 if nothing is loaded */
+int  World_EvictFarChunk(ForgeWorld* world, int cx, int cy, int mode, int* outCx, int* outCy, int* outMode, int* outModified);
+int  World_IsChunkModified(ForgeWorld* world, int cx, int cy, int mode);
+unsigned int World_GetChunkRevision(ForgeWorld* world, int cx, int cy, int mode);
+/* like World_GetChunkRevision, but 0 for chunks that are not loaded instead of generating them */
+unsigned int World_PeekChunkRevision(ForgeWorld* world, int cx, int cy, int mode);
+void World_DetectModifiedChunks(ForgeWorld* world);
 void World_MoveWithCollision(ForgeWorld* world, float tileSize, float radius, float* ioX, float* ioY, float dx, float dy);
 
 #define WORLD_MAX_MOB_TYPES 16
@@ -125,6 +155,8 @@ typedef struct Mob
 
 int  World_RegisterMobType(ForgeWorld* world, const MobArchetype* archetype);
 int  World_SpawnMob(ForgeWorld* world, int type, float x, float y);
+// fails when fewer than the live mobs would fit
+int  World_SetMobCapacity(ForgeWorld* world, int capacity);
 void World_UpdateMobs(ForgeWorld* world, float dt, int isNight, float playerX, float playerY, float playerRadius, float* ioPlayerHP);
 void World_UpdateMobsMulti(ForgeWorld* world, float dt, int isNight, const float* playerX, const float* playerY, int playerCount, float playerRadius, float* ioPlayerHP);
 int  World_PlayerAttack(ForgeWorld* world, float originX, float originY, float dirX, float dirY, float range, float arcCos, float damage);
@@ -24,9 +24,9 @@ void HandleBlockPlacement(const Player& player, const Camera2D& camera,
 }
 
 void HandlePlayerAttack(Player& player, const Camera2D& camera, 
-                       World* world, Texture2D* weaponSprite, bool uiBlockInput)
+                       World* world, Texture2D* weaponSprite, bool attackPressed)
 {
-    if (weaponSprite && !uiBlockInput && Input_IsMousePressed(MOUSE_LEFT))
+    if (weaponSprite && weaponSprite->width > 0 && attackPressed)
     {
         Vec2 mouse = { (float)Input_GetMouseX(), (float)Input_GetMouseY() };
         Vec2 worldMouse = { camera.x + mouse.x / camera.zoom, camera.y + mouse.y / camera.zoom };
@@ -12,7 +12,7 @@ void HandleBlockPlacement(const Player& player, const Camera2D& camera,
                          World* world, Inventory& inventory, bool uiBlockInput);
 
 void HandlePlayerAttack(Player& player, const Camera2D& camera, 
-                       World* world, Texture2D* weaponSprite, bool uiBlockInput);
+                       World* world, Texture2D* weaponSprite, bool attackPressed);
 
 NetInputState GetNetInput();
 
@@ -4,13 +4,13 @@
 #include <cmath>
 
 void UpdateSingleplayerGame(Player& player, World* world, const Camera2D& camera,
-                           Inventory& inventory, Texture2D* weaponSprite, bool uiBlockInput, float dt)
+                           Inventory& inventory, Texture2D* weaponSprite, bool attackPressed, float dt)
 {
     (void)camera;
     (void)inventory;
     NetInputState netInput = GetNetInput();
     player.Update(dt, Vec2{ netInput.moveX, netInput.moveY }, world->GetRaw(), world->GetTileSize());
-    HandlePlayerAttack(player, camera, world, weaponSprite, uiBlockInput);
+    HandlePlayerAttack(player, camera, world, weaponSprite, attackPressed);
 }
 
 void UpdateCaveState(Player& player, World* world, bool& inCave,
@@ -9,7 +9,7 @@
 #include "game_input.h"
 
 void UpdateSingleplayerGame(Player& player, World* world, const Camera2D& camera,
-                           Inventory& inventory, Texture2D* weaponSprite, bool uiBlockInput, float dt);
+                           Inventory& inventory, Texture2D* weaponSprite, bool attackPressed, float dt);
 
 void UpdateCaveState(Player& player, World* world, bool& inCave,
                     Vec2& caveEntrance, bool multiplayerActive);
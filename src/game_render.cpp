@@ -37,7 +37,8 @@ void DrawDebugInfo(const Player& player, World* world, const Renderer* renderer,
         "Zoom: %.2f\n"
         "Time: %s\n"
         "Cycle: %.2f / %.2f\n"
-        "Night Fog: %.2f",
+        "Night Fog: %.2f\n"
+        "GPU Upload: %.1f KB/frame",
         GetFPS(),
         playerPos.x, playerPos.y,
         tileX, tileY, tileId,
@@ -48,11 +49,12 @@ void DrawDebugInfo(const Player& player, World* world, const Renderer* renderer,
         camera.zoom,
         isNight ? "Night" : "Day",
         cycleTimer, isNight ? NIGHT_DURATION : DAY_DURATION,
-        fogStrength
+        fogStrength,
+        (double)Renderer_GetFrameUploadBytes() / 1024.0
     );
 
     Renderer_DrawTextEx(dbg, 10, 10, 16, Color{1, 1, 0, 1}, TEXT_STYLE_OUTLINE_SHADOW);
-    Renderer_DrawTextEx(" WASD - move\n LMB - attack(sword)\n 1-5 - select hotbar\n Tab - toggle inventory\n Esc - pause menu\n Q/E - zoom\n F3 - debug info",
+    Renderer_DrawTextEx(" WASD - move\n LMB - attack(sword)\n 1-5 - select hotbar\n Tab - toggle inventory\n Esc - pause menu\n Q/E - zoom\n F3 - debug info\n F4 - profiler\n F6 - save trace\n F7 - frame pacing\n M - minimap",
                        (float)renderer->width - 140, 10, 14, Color{1, 1, 1, 1}, TEXT_STYLE_OUTLINE_SHADOW);
 }
 
@@ -61,25 +63,13 @@ void DrawChunkDebugLines(const Camera2D& camera, const Renderer* renderer)
     const float tileSize = 16.0f;
     const float chunkWorldSize = CHUNK_SIZE * tileSize;
 
-    auto floorDiv = [](int v, int d) -> int
-    {
-        return v >= 0 ? v / d : (v - d + 1) / d;
-    };
-
-    int tilesXStart = (int)floorf(camera.x / tileSize);
-    int tilesYStart = (int)floorf(camera.y / tileSize);
-    int tilesXEnd = tilesXStart + (int)ceilf(800 / tileSize / camera.zoom) + 2;
-    int tilesYEnd = tilesYStart + (int)ceilf(600 / tileSize / camera.zoom) + 2;
-
-    int chunkXStart = floorDiv(tilesXStart, CHUNK_SIZE);
-    int chunkYStart = floorDiv(tilesYStart, CHUNK_SIZE);
-    int chunkXEnd = floorDiv(tilesXEnd - 1, CHUNK_SIZE);
-    int chunkYEnd = floorDiv(tilesYEnd - 1, CHUNK_SIZE);
+    Rect view = Visibility_GetCameraRect(camera, renderer->width, renderer->height);
+    VisibilityRange chunks = Visibility_GetCellRange(view, chunkWorldSize);
 
     Color chunkColor = {1.0f, 0.2f, 0.2f, 0.6f};
-    for (int cy = chunkYStart; cy <= chunkYEnd; cy++)
+    for (int cy = chunks.y0; cy < chunks.y1; cy++)
     {
-        for (int cx = chunkXStart; cx <= chunkXEnd; cx++)
+        for (int cx = chunks.x0; cx < chunks.x1; cx++)
         {
             float x0 = cx * chunkWorldSize;
             float y0 = cy * chunkWorldSize;
@@ -1,4 +1,4 @@
-#include "Inventory.h"
+#include "inventory.h"
 #include <cstdio>
 #include <algorithm>
 
@@ -90,7 +90,7 @@ void Inventory::Draw(float startX, float startY, float slotSize)
         if (slots[i].used)
         {
             Rect itemRect = { slotRect.x + 4, slotRect.y + 4, slotSize - 8, slotSize - 8 };
-            if (slots[i].sprite)
+            if (slots[i].sprite && slots[i].sprite->width > 0)
             {
                 Rect src = { 0, 0, (float)slots[i].sprite->width, (float)slots[i].sprite->height };
                 Renderer_DrawTexturePro(*slots[i].sprite, src, itemRect, Vec2{0, 0}, 0.0f, Color{1, 1, 1, 1});
@@ -126,7 +126,7 @@ void Inventory::Draw(float startX, float startY, float slotSize)
         int mx = Input_GetMouseX();
         int my = Input_GetMouseY();
         Rect heldRect = { (float)mx - slotSize * 0.5f + 4.0f, (float)my - slotSize * 0.5f + 4.0f, slotSize - 8, slotSize - 8 };
-        if (heldItem.sprite)
+        if (heldItem.sprite && heldItem.sprite->width > 0)
         {
             Rect src = { 0, 0, (float)heldItem.sprite->width, (float)heldItem.sprite->height };
             Renderer_DrawTexturePro(*heldItem.sprite, src, heldRect, Vec2{0, 0}, 0.0f, Color{1, 1, 1, 1});
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "net/client.h"
+
+static const float INPUT_RATE = 60.0f;
+static const float ATTACK_INTERVAL = 0.5f;
+static const float PING_INTERVAL = 0.25f;
+static const float EXPECTED_SNAPSHOT_MS = NET_SNAPSHOT_INTERVAL * 1000.0f;
+
+struct Bot
+{
+    ClientState client;
+    bool everConnected;
+    bool lost;
+    uint16_t seq;
+    float phase;
+    float inputTimer;
+    float attackTimer;
+    float pingTimer;
+    uint32_t lastPongCount;
+
+    uint32_t lastSnapshotCount;
+    double lastSnapshotAt;
+
+    std::vector<float> intervalsMs;
+    std::vector<float> rttMs;
+    std::vector<float> serverTickMs;
+};
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+static float Percentile(std::vector<float>& v, float p)
+{
+    if (v.empty()) return 0.0f;
+    size_t idx = (size_t)(p * (float)(v.size() - 1) + 0.5f);
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return v[idx];
+}
+
+static void PrintRow(const char* name, std::vector<float>& v)
+{
+    if (v.empty())
+    {
+        printf("  %-22s no samples\n", name);
+        return;
+    }
+    float p50 = Percentile(v, 0.50f);
+    float p90 = Percentile(v, 0.90f);
+    float p99 = Percentile(v, 0.99f);
+    float max = *std::max_element(v.begin(), v.end());
+    printf("  %-22s p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f  (n=%zu)\n", name, p50, p90, p99, max, v.size());
+}
+
+static void SendBotInput(Bot& b, float t)
+{
+    float angle = b.phase + t * 0.8f;
+    NetInputState in = {};
+    in.seq = ++b.seq;
+    in.moveX = cosf(angle);
+    in.moveY = sinf(angle);
+    in.attackDirX = in.moveX;
+    in.attackDirY = in.moveY;
+    if (b.attackTimer <= 0.0f)
+    {
+        in.attack = 1;
+        b.attackTimer = ATTACK_INTERVAL;
+    }
+
+    Client_SendInput(&b.client, &in);
+}
+
+static void SampleSnapshot(Bot& b, double now)
+{
+    if (b.client.snapshotsReceived == b.lastSnapshotCount)
+        return;
+
+    if (b.lastSnapshotCount > 0)
+        b.intervalsMs.push_back((float)((now - b.lastSnapshotAt) * 1000.0));
+    b.lastSnapshotCount = b.client.snapshotsReceived;
+    b.lastSnapshotAt = now;
+    b.serverTickMs.push_back(b.client.serverTickMs);
+}
+
+// pongs are timed as Client_Update reads them, so RTT is not tied to the snapshot rate
+static void SamplePong(Bot& b)
+{
+    if (b.client.pongsReceived == b.lastPongCount)
+        return;
+    b.lastPongCount = b.client.pongsReceived;
+    b.rttMs.push_back(b.client.rttMs);
+}
+
+int main(int argc, char** argv)
+{
+    int botCount = 8;
+    float duration = 30.0f;
+    uint16_t port = 7777;
+    const char* host = "127.0.0.1";
+
+    if (argc > 1) botCount = std::max(1, atoi(argv[1]));
+    if (argc > 2) duration = std::max(1.0f, (float)atof(argv[2]));
+    if (argc > 3)
+    {
+        int p = atoi(argv[3]);
+        if (p > 0 && p <= 65535) port = (uint16_t)p;
+    }
+    if (argc > 4) host = argv[4];
+
+    if (botCount > NET_MAX_PLAYERS)
+        printf("warning: %d bots requested, server accepts %d; extra bots will be rejected\n", botCount, NET_MAX_PLAYERS);
+
+    std::vector<Bot> bots(botCount);
+    for (int i = 0; i < botCount; ++i)
+    {
+        Bot& b = bots[i];
+        b.everConnected = false;
+        b.lost = false;
+        b.seq = 0;
+        b.phase = (float)i * 2.39996f;
+        b.inputTimer = 0.0f;
+        b.attackTimer = (float)i * ATTACK_INTERVAL / (float)botCount;
+        b.pingTimer = 0.0f;
+        b.lastPongCount = 0;
+        b.lastSnapshotCount = 0;
+        b.lastSnapshotAt = 0.0;
+
+        if (!Client_Init(&b.client) || !Client_Connect(&b.client, host, port))
+        {
+            printf("bot %d: connect to %s:%u failed\n", i, host, port);
+            continue;
+        }
+        b.everConnected = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    printf("running %d bots against %s:%u for %.0f s\n", botCount, host, port, duration);
+
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    double t = 0.0;
+    while (t < duration)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<float> elapsed = now - last;
+        last = now;
+        float dt = std::clamp(elapsed.count(), 0.0f, 0.1f);
+        t = Seconds(start);
+
+        for (Bot& b : bots)
+        {
+            if (!b.everConnected || b.lost)
+                continue;
+
+            b.attackTimer -= dt;
+            b.inputTimer -= dt;
+            if (b.inputTimer <= 0.0f)
+            {
+                b.inputTimer += 1.0f / INPUT_RATE;
+                SendBotInput(b, (float)t);
+            }
+            b.pingTimer -= dt;
+            if (b.pingTimer <= 0.0f)
+            {
+                b.pingTimer += PING_INTERVAL;
+                Client_SendPing(&b.client);
+            }
+
+            Client_Update(&b.client, dt);
+            if (!Client_IsConnected(&b.client))
+            {
+                b.lost = true;
+                printf("bot %d: disconnected at %.2f s\n", (int)(&b - bots.data()), t);
+                continue;
+            }
+
+            SampleSnapshot(b, Seconds(start));
+            SamplePong(b);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::vector<float> intervals;
+    std::vector<float> jitter;
+    std::vector<float> rtt;
+    std::vector<float> tick;
+    std::vector<float> inRate;
+    std::vector<float> outRate;
+    int lostCount = 0;
+    int failedCount = 0;
+
+    printf("\nper-bot:\n");
+    for (int i = 0; i < botCount; ++i)
+    {
+        Bot& b = bots[i];
+        if (!b.everConnected)
+        {
+            failedCount++;
+            continue;
+        }
+        if (b.lost)
+            lostCount++;
+
+        float in = (float)b.client.bytesReceived / duration;
+        float out = (float)b.client.bytesSent / duration;
+        if (!b.lost)
+        {
+            inRate.push_back(in);
+            outRate.push_back(out);
+        }
+        printf("  bot %2d  id %u  snapshots %5u  in %8.0f B/s  out %8.0f B/s%s\n",
+            i, b.client.playerId, b.client.snapshotsReceived, in, out, b.lost ? "  (disconnected)" : "");
+
+        for (float v : b.intervalsMs)
+        {
+            intervals.push_back(v);
+            jitter.push_back(fabsf(v - EXPECTED_SNAPSHOT_MS));
+        }
+        rtt.insert(rtt.end(), b.rttMs.begin(), b.rttMs.end());
+        tick.insert(tick.end(), b.serverTickMs.begin(), b.serverTickMs.end());
+
+        Client_Disconnect(&b.client);
+    }
+
+    printf("\naggregate (ms unless noted):\n");
+    PrintRow("snapshot interval", intervals);
+    PrintRow("snapshot jitter", jitter);
+    PrintRow("ping rtt", rtt);
+    PrintRow("server tick", tick);
+    PrintRow("recv B/s per client", inRate);
+    PrintRow("send B/s per client", outRate);
+    printf("\nconnect failures %d, disconnects %d\n", failedCount, lostCount);
+
+    Net_Shutdown();
+    return (failedCount > 0 || lostCount > 0) ? 1 : 0;
+}
@@ -6,6 +6,7 @@
 #include <vector>
 #include "engine/forge.h"
 #include "inventory.h"
+#include "minimap.h"
 #include "net/client.h"
 #include "net/server.h"
 #include "player.h"
@@ -62,6 +63,21 @@ int main(int argc, char** argv)
     Renderer* renderer = Renderer_Create(window);
     SetGlobalRenderer(renderer);
 
+    Lighting* lighting = LoadLighting(2);
+
+    const double SIMULATION_HZ = 60.0;
+    const double FRAME_CAP_FPS = 144.0;
+    const double ASSET_UPLOAD_BUDGET = 0.002;
+    FramePacingMode pacingMode = FRAME_PACING_VSYNC;
+    FramePacer pacer;
+    FramePacer_Init(&pacer, SIMULATION_HZ, FRAME_CAP_FPS);
+    FramePacer_SetMode(&pacer, window, pacingMode);
+
+    Profiler_Init();
+    bool showProfiler = false;
+
+    Assets_Init();
+
     MainMenu mainMenu;
     GameState currentGameState = STATE_MENU;
     World* world = nullptr;
@@ -70,8 +86,11 @@ int main(int argc, char** argv)
     Player player(0.0f, 0.0f);
 
     Inventory inventory;
-    Texture2D* itemSprite = LoadTexture("assets/test.png");
-    Texture2D* swordSprite = LoadTexture("assets/kuzne4ik_sword.png");
+    Minimap minimap;
+    bool showMinimap = true;
+    TextureAtlas* spriteAtlas = LoadTextureAtlas(1024);
+    Texture2D* itemSprite = Assets_LoadTexture(spriteAtlas, "assets/test.png");
+    Texture2D* swordSprite = Assets_LoadTexture(spriteAtlas, "assets/kuzne4ik_sword.png");
     inventory.AddItem("fimoz", Color{1,0,0,1}, itemSprite, ITEM_MISC);
     inventory.AddItem("giga fimoz", Color{0,1,0,1}, itemSprite, ITEM_MISC);
     inventory.AddItem("kuzne4ik sword", Color{1,1,1,1}, swordSprite, ITEM_WEAPON);
@@ -92,6 +111,7 @@ int main(int argc, char** argv)
     std::vector<RemotePlayer> remotePlayers;
     float mobSyncTimer = 0.0f;
     std::vector<PendingInput> pendingInputs;
+    std::vector<QuadInstance> instances;
     uint16_t inputSeq = 0;
     float attackBufferTimer = 0.0f;
     Vec2 lastAttackDir = { 1.0f, 0.0f };
@@ -111,9 +131,16 @@ int main(int argc, char** argv)
     const float DAY_DURATION = 300.0f;
     const float NIGHT_DURATION = 180.0f;
     const float NIGHT_FADE = 10.0f;
+    const float PLAYER_LIGHT_RADIUS = 220.0f;
+    const Color playerLightColor = {1.0f, 0.85f, 0.6f, 1.0f};
     bool isNight = false;
     float cycleTimer = 0.0f;
     float autoSaveTimer = 0.0f;
+    const float AUTOSAVE_INTERVAL = 8.0f;
+    const float AUTOSAVE_MAX_DELAY = 4.0f;
+    const double AUTOSAVE_BUDGET = 0.004;
+    const int CHUNK_UPLOADS_PER_FRAME = 8;
+    bool attackQueued = false;
     bool pauseMenuOpen = false;
     bool pendingRendererSwitch = false;
     RendererBackend pendingBackend = Renderer_GetBackend(renderer);
@@ -127,13 +154,26 @@ int main(int argc, char** argv)
 
     while (!Window_ShouldClose(window))
     {
+        Profiler_BeginFrame();
+        Profiler_BeginScope("Pacing");
+        FramePacer_BeginFrame(&pacer);
+        Profiler_EndScope();
+
+        Profiler_BeginScope("Input");
         Window_PollEvents(window);
         float dt = (float)GetDeltaTime();
 
         ImGuiLite_BeginFrame(&ui);
+        Profiler_EndScope();
+
+        Profiler_BeginScope("Assets");
+        Assets_Update(ASSET_UPLOAD_BUDGET);
+        Profiler_EndScope();
 
         if (currentGameState == STATE_MENU || currentGameState == STATE_NEW_GAME || currentGameState == STATE_LOAD_GAME)
         {
+            Profiler_BeginScope("Menu");
+            FramePacer_Suspend(&pacer);
             Renderer_BeginFrame(renderer);
             mainMenu.Update();
             GameState newState = mainMenu.GetGameState();
@@ -144,6 +184,7 @@ int main(int argc, char** argv)
                 if (world)
                     delete world;
                 world = new World(WORLD_LOAD_RADIUS_CHUNKS, cfg.seed);
+                minimap.Reset();
                 ForgeWorld* raw = world->GetRaw();
                 raw->waterAmount = cfg.waterAmount;
                 raw->stoneAmount = cfg.stoneAmount;
@@ -151,6 +192,7 @@ int main(int argc, char** argv)
                 World_ReloadChunks(raw);
                 currentGameState = STATE_PLAYING;
                 player.SetPosition(Vec2{ 0.0f, 0.0f });
+                player.BeginStep();
                 player.SetHP(100.0f);
                 singleplayerDead = false;
                 singleplayerRespawnTimer = 0.0f;
@@ -168,11 +210,13 @@ int main(int argc, char** argv)
                 if (world)
                     delete world;
                 world = new World(WORLD_LOAD_RADIUS_CHUNKS, 0);
+                minimap.Reset();
 
                 GameSaveState loaded = {};
                 if (Storage_LoadGame(world->GetRaw(), &loaded))
                 {
                     player.SetPosition(Vec2{ loaded.playerX, loaded.playerY });
+                    player.BeginStep();
                     player.SetHP(loaded.playerHP);
                     inCave = loaded.inCave != 0;
                     isNight = loaded.isNight != 0;
@@ -196,8 +240,11 @@ int main(int argc, char** argv)
                 break;
             else
                 currentGameState = newState;
-            
+            Profiler_EndScope();
+
+            Profiler_BeginScope("Swap");
             Renderer_EndFrame(renderer);
+            Profiler_EndScope();
             continue;
         }
         else if (currentGameState == STATE_EXITING)
@@ -205,6 +252,7 @@ int main(int argc, char** argv)
         
         if (!world) continue;
 
+        Profiler_BeginScope("Input");
         bool multiplayerActive = (mpMode != MpMode::None);
         if (Input_IsKeyPressed(KEY_ESCAPE))
             pauseMenuOpen = !pauseMenuOpen;
@@ -214,28 +262,21 @@ int main(int argc, char** argv)
             pendingBackend = (current == RENDERER_BACKEND_OPENGL) ? RENDERER_BACKEND_DIRECT2D : RENDERER_BACKEND_OPENGL;
             pendingRendererSwitch = true;
         }
-        bool singleplayerPaused = pauseMenuOpen && !multiplayerActive;
-
-        if (currentGameState == STATE_PLAYING && mpMode == MpMode::None)
+        if (Input_IsKeyPressed(KEY_F7))
         {
-            autoSaveTimer += dt;
-            if (autoSaveTimer >= 8.0f)
-            {
-                GameSaveState state = {};
-                Vec2 playerPos = player.GetPosition();
-                state.playerX = playerPos.x;
-                state.playerY = playerPos.y;
-                state.playerHP = player.GetHP();
-                state.inCave = inCave ? 1 : 0;
-                state.isNight = isNight ? 1 : 0;
-                state.cycleTimer = cycleTimer;
-                state.fogStrength = fogStrength;
-                state.caveEntranceX = caveEntrance.x;
-                state.caveEntranceY = caveEntrance.y;
-                Storage_SaveGame(world->GetRaw(), &state);
-                autoSaveTimer = 0.0f;
-            }
+            pacingMode = (FramePacingMode)((pacingMode + 1) % FRAME_PACING_MODE_COUNT);
+            FramePacer_SetMode(&pacer, window, pacingMode);
         }
+        if (Input_IsKeyPressed(KEY_F4))
+        {
+            showProfiler = !showProfiler;
+            Profiler_SetGpuEnabled(showProfiler ? 1 : 0);
+        }
+        if (Input_IsKeyPressed(KEY_F6))
+            Profiler_ExportTrace("profile_trace.json");
+        if (Input_IsKeyPressed(KEY_M))
+            showMinimap = !showMinimap;
+        bool singleplayerPaused = pauseMenuOpen && !multiplayerActive;
 
         if (!pauseMenuOpen)
             inventory.Update();
@@ -255,6 +296,11 @@ int main(int argc, char** argv)
             HandleBlockPlacement(player, camera, world, inventory, uiBlockInput);
 
         NetInputState netInput = blockGameplayInput ? NetInputState{} : GetNetInput();
+        // clicks wait for the next simulation step instead of being lost on frames that run none
+        if (blockGameplayInput)
+            attackQueued = false;
+        else if (!uiBlockInput && Input_IsMousePressed(MOUSE_LEFT))
+            attackQueued = true;
 
         float halfW = (float)renderer->width * 0.5f;
         float halfH = (float)renderer->height * 0.5f;
@@ -263,114 +309,149 @@ int main(int argc, char** argv)
         camera.y = playerPos.y - halfH / camera.zoom;
 
         UpdateCameraZoom(camera, dt);
+        Profiler_EndScope();
 
+        Profiler_BeginScope("Update");
         if (!singleplayerPaused)
         {
-            if (!multiplayerActive)
-            {
-                if (!singleplayerDead)
-                    UpdateSingleplayerGame(player, world, camera, inventory, weaponSprite, uiBlockInput, dt);
-            }
-            else
+            const float step = FramePacer_GetStep(&pacer);
+            while (FramePacer_Step(&pacer))
             {
-                if (!localDead)
-                {
-                    UpdateMultiplayerInput(player, world, netInput, weaponSprite, uiBlockInput,
-                                          attackBufferTimer, lastAttackDir, camera, dt);
-                }
+                player.BeginStep();
+                for (auto& rp : remotePlayers)
+                    rp.player.BeginStep();
 
-                if (mpMode == MpMode::Client && clientReady && !localDead)
-                    UpdateClientMovement(player, world, netInput, inputSeq, pendingInputs, dt);
+                bool attackPressed = attackQueued;
+                attackQueued = false;
+                NetInputState stepInput = netInput;
+                multiplayerActive = (mpMode != MpMode::None);
 
-                if (mpMode == MpMode::Host && serverReady)
+                if (!multiplayerActive)
                 {
-                    Server_Update(&server, dt);
+                    if (!singleplayerDead)
+                        UpdateSingleplayerGame(player, world, camera, inventory, weaponSprite, attackPressed, step);
                 }
-                else if (mpMode == MpMode::Client && clientReady)
+                else
                 {
-                    Client_SendInput(&client, &netInput);
-                    Client_Update(&client, dt);
-                    if (!Client_IsConnected(&client))
+                    Profiler_BeginScope("Net");
+                    if (!localDead)
                     {
-                        mpMode = MpMode::None;
-                        remotePlayers.clear();
-                        clientReady = false;
-                        pendingInputs.clear();
-                        inputSeq = 0;
+                        UpdateMultiplayerInput(player, world, stepInput, weaponSprite, attackPressed,
+                                              attackBufferTimer, lastAttackDir, camera, step);
                     }
-                }
 
-                NetPlayerState snap[NET_MAX_PLAYERS];
-                int snapCount = 0;
-                uint8_t localId = 0;
-                bool snapNight = isNight;
-                float snapCycle = cycleTimer;
+                    if (mpMode == MpMode::Client && clientReady && !localDead)
+                        UpdateClientMovement(player, world, stepInput, inputSeq, pendingInputs, step);
 
-                if (mpMode == MpMode::Host && serverReady)
-                {
-                    localId = 0;
-                    snapCount = Server_GetSnapshot(&server, snap, NET_MAX_PLAYERS, &snapNight, &snapCycle);
-                }
-                else if (mpMode == MpMode::Client && clientReady)
-                {
-                    localId = client.playerId;
-                    snapCount = Client_GetSnapshot(&client, snap, NET_MAX_PLAYERS, &snapNight, &snapCycle);
-                }
+                    if (mpMode == MpMode::Host && serverReady)
+                    {
+                        Server_Update(&server, step);
+                    }
+                    else if (mpMode == MpMode::Client && clientReady)
+                    {
+                        Client_SendInput(&client, &stepInput);
+                        Client_Update(&client, step);
+                        if (!Client_IsConnected(&client))
+                        {
+                            mpMode = MpMode::None;
+                            remotePlayers.clear();
+                            clientReady = false;
+                            pendingInputs.clear();
+                            inputSeq = 0;
+                        }
+                    }
 
-                ProcessNetworkSnapshot(snap, snapCount, localId, player, remotePlayers,
-                                      pendingInputs, world, swordSprite, mpMode, dt,
-                                      localDead, localRespawnTimer);
+                    NetPlayerState snap[NET_MAX_PLAYERS];
+                    int snapCount = 0;
+                    uint8_t localId = 0;
+                    bool snapNight = isNight;
+                    float snapCycle = cycleTimer;
 
-                isNight = snapNight;
-                cycleTimer = snapCycle;
-            }
+                    if (mpMode == MpMode::Host && serverReady)
+                    {
+                        localId = 0;
+                        snapCount = Server_GetSnapshot(&server, snap, NET_MAX_PLAYERS, &snapNight, &snapCycle);
+                    }
+                    else if (mpMode == MpMode::Client && clientReady)
+                    {
+                        localId = client.playerId;
+                        snapCount = Client_GetSnapshot(&client, snap, NET_MAX_PLAYERS, &snapNight, &snapCycle);
+                    }
 
-            playerPos = player.GetPosition();
-            camera.x = playerPos.x - halfW / camera.zoom;
-            camera.y = playerPos.y - halfH / camera.zoom;
+                    ProcessNetworkSnapshot(snap, snapCount, localId, player, remotePlayers,
+                                          pendingInputs, world, swordSprite, mpMode, step,
+                                          localDead, localRespawnTimer);
 
-            float playerHP = player.GetHP();
-            if (multiplayerActive)
-            {
-                float dummyHP = playerHP;
-                world->Update(dt, isNight ? 1 : 0, playerPos, playerPos, player.GetSize(), &dummyHP, false);
-            }
-            else
-            {
-                if (!singleplayerDead && playerHP <= 0.0f)
+                    isNight = snapNight;
+                    cycleTimer = snapCycle;
+                    Profiler_EndScope();
+                }
+
+                playerPos = player.GetPosition();
+                camera.x = playerPos.x - halfW / camera.zoom;
+                camera.y = playerPos.y - halfH / camera.zoom;
+
+                float playerHP = player.GetHP();
+                if (multiplayerActive)
                 {
-                    singleplayerDead = true;
-                    singleplayerRespawnTimer = RESPAWN_TIME_SECONDS;
-                    playerHP = 0.0f;
-                    player.SetHP(0.0f);
+                    float dummyHP = playerHP;
+                    world->Update(step, isNight ? 1 : 0, playerPos, playerPos, player.GetSize(), &dummyHP, false);
                 }
-                if (singleplayerDead)
+                else
                 {
-                    singleplayerRespawnTimer -= dt;
-                    if (singleplayerRespawnTimer <= 0.0f)
+                    if (!singleplayerDead && playerHP <= 0.0f)
                     {
-                        singleplayerRespawnTimer = 0.0f;
-                        singleplayerDead = false;
-                        player.SetPosition(0.0f, 0.0f);
-                        playerHP = 100.0f;
+                        singleplayerDead = true;
+                        singleplayerRespawnTimer = RESPAWN_TIME_SECONDS;
+                        playerHP = 0.0f;
+                        player.SetHP(0.0f);
+                    }
+                    if (singleplayerDead)
+                    {
+                        singleplayerRespawnTimer -= step;
+                        if (singleplayerRespawnTimer <= 0.0f)
+                        {
+                            singleplayerRespawnTimer = 0.0f;
+                            singleplayerDead = false;
+                            player.SetPosition(0.0f, 0.0f);
+                            player.BeginStep();
+                            playerHP = 100.0f;
+                        }
                     }
-                }
 
-                playerPos = player.GetPosition();
-                world->Update(dt, isNight ? 1 : 0, playerPos, playerPos, player.GetSize(), &playerHP, !singleplayerDead);
-                player.SetHP(playerHP);
-                localDead = singleplayerDead;
-                localRespawnTimer = singleplayerRespawnTimer;
-            }
+                    playerPos = player.GetPosition();
+                    world->Update(step, isNight ? 1 : 0, playerPos, playerPos, player.GetSize(), &playerHP, !singleplayerDead);
+                    player.SetHP(playerHP);
+                    localDead = singleplayerDead;
+                    localRespawnTimer = singleplayerRespawnTimer;
+                }
 
-            UpdateCaveState(player, world, inCave, caveEntrance, multiplayerActive);
+                bool wasInCave = inCave;
+                UpdateCaveState(player, world, inCave, caveEntrance, multiplayerActive);
+                if (inCave != wasInCave)
+                    player.BeginStep();
 
-            if (mpMode == MpMode::Host && serverReady)
-                UpdateHostMobs(player, world, server, mobSyncTimer, isNight, dt);
+                if (mpMode == MpMode::Host && serverReady)
+                {
+                    UpdateHostMobs(player, world, server, mobSyncTimer, isNight, step);
+                    Server_Flush(&server);
+                }
 
-            if (!multiplayerActive)
-                UpdateDayNightCycle(isNight, cycleTimer, DAY_DURATION, NIGHT_DURATION, NIGHT_FADE, fogStrength, dt);
+                if (!multiplayerActive)
+                    UpdateDayNightCycle(isNight, cycleTimer, DAY_DURATION, NIGHT_DURATION, NIGHT_FADE, fogStrength, step);
+            }
         }
+        else
+        {
+            FramePacer_Suspend(&pacer);
+        }
+        Profiler_EndScope();
+
+        // the camera follows the interpolated player so it never judders against the render rate
+        float alpha = FramePacer_GetAlpha(&pacer);
+        playerPos = player.GetRenderPosition(alpha);
+        camera.x = playerPos.x - halfW / camera.zoom;
+        camera.y = playerPos.y - halfH / camera.zoom;
 
         bool f3 = Input_IsKeyDown(KEY_F3);
         if (f3 && !prevF3)
@@ -415,23 +496,50 @@ int main(int argc, char** argv)
             return pressed;
         };
 
+        Profiler_BeginScope("World Draw");
         Renderer_BeginFrame(renderer);
         if (inCave)
             Renderer_Clear(Color{0.18f, 0.18f, 0.18f, 1.0f});
         else
             Renderer_Clear(Color{0.5f, 0.8f, 1.0f, 1.0f});
+        Profiler_BeginGpuScope("World");
 
         BeginCameraMode(camera);
-        world->Draw(camera, 800, 600, mpMode != MpMode::Client);
+        // chunk texture uploads beyond the first wait for a frame that has time to spare
+        world->SetTileUploadBudget(FramePacer_HasBudget(&pacer, pacer.frame_budget * 0.5) ? CHUNK_UPLOADS_PER_FRAME : 1);
+        world->Draw(camera, renderer->width, renderer->height, mpMode != MpMode::Client, alpha);
         
         if (showDebug)
             DrawChunkDebugLines(camera, renderer);
 
-        player.Draw();
+        Rect view = Visibility_GetCameraRect(camera, renderer->width, renderer->height);
+        // a remote player's swing reaches past its body
+        auto remoteVisible = [&](const RemotePlayer& rp)
+        {
+            Vec2 p = rp.player.GetRenderPosition(alpha);
+            return Visibility_PointVisible(view, p.x, p.y, rp.player.GetSize() * 0.5f + rp.player.GetAttackRange());
+        };
+
+        instances.clear();
+        instances.push_back(player.GetBodyInstance(alpha));
         if (multiplayerActive)
         {
             for (const auto& rp : remotePlayers)
-                rp.player.Draw();
+            {
+                if (remoteVisible(rp))
+                    instances.push_back(rp.player.GetBodyInstance(alpha));
+            }
+        }
+        Renderer_DrawQuadsInstanced(instances.data(), (int)instances.size(), 0);
+
+        player.DrawWeapon(alpha);
+        if (multiplayerActive)
+        {
+            for (const auto& rp : remotePlayers)
+            {
+                if (remoteVisible(rp))
+                    rp.player.DrawWeapon(alpha);
+            }
         }
         
         if (mpMode == MpMode::Client && clientReady)
@@ -440,28 +548,50 @@ int main(int argc, char** argv)
             const MobArchetype* types = World_GetMobArchetypes(world->GetRaw(), &typeCount);
             if (types)
             {
+                instances.clear();
                 for (int i = 0; i < client.mobCount; ++i)
                 {
                     const NetMobState& m = client.mobs[i];
                     if (m.type < 0 || m.type >= typeCount)
                         continue;
                     const MobArchetype& arch = types[m.type];
-                    Renderer_DrawRectangle(
-                        Rect{ m.x - arch.size * 0.5f, m.y - arch.size * 0.5f, arch.size, arch.size },
+                    if (!Visibility_PointVisible(view, m.x, m.y, arch.size * 0.5f) || Visibility_IsTooSmall(camera, arch.size))
+                        continue;
+                    instances.push_back(QuadInstance{
+                        m.x, m.y, arch.size, arch.size, 0.0f, 0.0f,
                         Color{ arch.color.x, arch.color.y, arch.color.z, arch.color.w }
-                    );
+                    });
                 }
+                Renderer_DrawQuadsInstanced(instances.data(), (int)instances.size(), 0);
             }
         }
         
         EndCameraMode();
+        Profiler_EndGpuScope();
+        Profiler_EndScope();
 
+        Profiler_BeginScope("Lighting");
+        Profiler_BeginGpuScope("Lighting");
         if (fogStrength > 0.0f)
         {
-            Color nightOverlay = {0.0f, 0.0f, 0.0f, fogStrength};
-            Renderer_DrawRectangle(Rect{0, 0, (float)renderer->width, (float)renderer->height}, nightOverlay);
+            Lighting_Begin(lighting);
+            Lighting_AddLight(lighting, player.GetRenderPosition(alpha), PLAYER_LIGHT_RADIUS, 1.0f, playerLightColor);
+            if (multiplayerActive)
+            {
+                for (const auto& rp : remotePlayers)
+                {
+                    Vec2 p = rp.player.GetRenderPosition(alpha);
+                    if (Visibility_PointVisible(view, p.x, p.y, PLAYER_LIGHT_RADIUS))
+                        Lighting_AddLight(lighting, p, PLAYER_LIGHT_RADIUS, 1.0f, playerLightColor);
+                }
+            }
+            Lighting_Render(lighting, camera, fogStrength);
         }
+        Profiler_EndGpuScope();
+        Profiler_EndScope();
 
+        Profiler_BeginScope("UI");
+        Profiler_BeginGpuScope("UI");
         if (showDebug)
             DrawDebugInfo(player, world, renderer, camera, inCave, isNight, cycleTimer,
                          DAY_DURATION, NIGHT_DURATION, fogStrength);
@@ -474,6 +604,15 @@ int main(int argc, char** argv)
                                                    portBuffer, (int)sizeof(portBuffer));
 
             inventory.Draw(10.0f, (float)renderer->height - 50.0f, 32.0f);
+            if (showMinimap)
+            {
+                // one screen pixel per tile
+                const float MINIMAP_SIZE = 192.0f;
+                Vec2 mapCenter = player.GetRenderPosition(alpha);
+                minimap.Update(world->GetRaw(), mapCenter, world->GetTileSize());
+                minimap.Draw(Rect{ (float)renderer->width - MINIMAP_SIZE - 10.0f, (float)renderer->height - MINIMAP_SIZE - 10.0f,
+                                   MINIMAP_SIZE, MINIMAP_SIZE }, mapCenter, world->GetTileSize());
+            }
             player.DrawStamina();
             player.DrawHP();
             if (localDead)
@@ -517,6 +656,7 @@ int main(int argc, char** argv)
                         clientReady = Client_Init(&client);
                     if (clientReady && Client_Connect(&client, "127.0.0.1", (uint16_t)port))
                     {
+                        Client_SetWorld(&client, world->GetRaw());
                         mpMode = MpMode::Client;
                         remotePlayers.clear();
                         pendingInputs.clear();
@@ -534,6 +674,7 @@ int main(int argc, char** argv)
                     clientReady = Client_Init(&client);
                 if (clientReady && Client_Connect(&client, ipBuffer, (uint16_t)port))
                 {
+                    Client_SetWorld(&client, world->GetRaw());
                     mpMode = MpMode::Client;
                     remotePlayers.clear();
                     pendingInputs.clear();
@@ -615,8 +756,40 @@ int main(int argc, char** argv)
             rendererNoticeTimer -= dt;
             Renderer_DrawTextEx(rendererNotice, 20.0f, 20.0f, 18.0f, Color{1.0f, 0.95f, 0.6f, 1.0f}, TEXT_STYLE_OUTLINE_SHADOW);
         }
+        Profiler_EndGpuScope();
+        Profiler_EndScope();
+
+        if (showProfiler)
+            Profiler_DrawOverlay((float)renderer->width - 430.0f, 180.0f, 420.0f, 200.0f);
 
+        // the save runs after the frame is recorded and waits for one with slack, unless overdue
+        Profiler_BeginScope("Save");
+        if (currentGameState == STATE_PLAYING && mpMode == MpMode::None)
+        {
+            autoSaveTimer += dt;
+            if (autoSaveTimer >= AUTOSAVE_INTERVAL &&
+                (FramePacer_HasBudget(&pacer, AUTOSAVE_BUDGET) || autoSaveTimer >= AUTOSAVE_INTERVAL + AUTOSAVE_MAX_DELAY))
+            {
+                GameSaveState state = {};
+                Vec2 playerPos = player.GetPosition();
+                state.playerX = playerPos.x;
+                state.playerY = playerPos.y;
+                state.playerHP = player.GetHP();
+                state.inCave = inCave ? 1 : 0;
+                state.isNight = isNight ? 1 : 0;
+                state.cycleTimer = cycleTimer;
+                state.fogStrength = fogStrength;
+                state.caveEntranceX = caveEntrance.x;
+                state.caveEntranceY = caveEntrance.y;
+                Storage_SaveGame(world->GetRaw(), &state);
+                autoSaveTimer = 0.0f;
+            }
+        }
+        Profiler_EndScope();
+
+        Profiler_BeginScope("Swap");
         Renderer_EndFrame(renderer);
+        Profiler_EndScope();
 
         if (pendingRendererSwitch)
         {
@@ -667,6 +840,7 @@ int main(int argc, char** argv)
                 delete world;
                 world = nullptr;
             }
+            minimap.Reset();
             pauseMenuOpen = false;
             currentGameState = STATE_MENU;
             mainMenu.SetGameState(STATE_MENU);
@@ -674,8 +848,9 @@ int main(int argc, char** argv)
         }
 
         char buffer[256];
-        snprintf(buffer, sizeof(buffer), "Eternal Night - %s - FPS: %.2f",
-                 Renderer_GetBackendName(Renderer_GetBackend(renderer)), GetFPS());
+        snprintf(buffer, sizeof(buffer), "Eternal Night - %s - %s - FPS: %.2f",
+                 Renderer_GetBackendName(Renderer_GetBackend(renderer)),
+                 FramePacer_GetModeName(pacer.mode), GetFPS());
         Window_SetTitle(window, buffer);
     }
 
@@ -705,6 +880,14 @@ int main(int argc, char** argv)
     if (world)
         delete world;
 
+    minimap.Reset();
+    Assets_ReleaseTexture(itemSprite);
+    Assets_ReleaseTexture(swordSprite);
+    UnloadTextureAtlas(spriteAtlas);
+    UnloadLighting(lighting);
+    Profiler_Shutdown();
+    Assets_Shutdown();
+
     Window_Destroy(window);
     Renderer_Destroy(renderer);
     Forge_Shutdown();
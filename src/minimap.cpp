@@ -0,0 +1,232 @@
+#include "minimap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const int MINIMAP_UPLOADS_PER_FRAME = 4;
+// 4 KB each; trimming goes down to three quarters so it does not run every frame
+static const size_t MINIMAP_MAX_THUMBNAILS = 1024;
+
+static int FloorDiv(int v, int d)
+{
+    return v >= 0 ? v / d : (v - d + 1) / d;
+}
+
+static int PositiveMod(int v, int m)
+{
+    int r = v % m;
+    return r < 0 ? r + m : r;
+}
+
+static long long ThumbnailKey(int cx, int cy, int mode)
+{
+    unsigned long long x = (unsigned int)cx;
+    unsigned long long y = (unsigned int)cy;
+    return (long long)((x << 33) ^ (y << 1) ^ (unsigned long long)(mode ? 1 : 0));
+}
+
+static unsigned char ColorByte(float v)
+{
+    return (unsigned char)(std::fmin(std::fmax(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+Minimap::Minimap(int viewChunks)
+    : viewChunks(viewChunks > 0 ? viewChunks : 1), ring(nullptr), mode(0)
+{
+    // a view that straddles chunk borders touches one chunk more than it spans
+    ringChunks = this->viewChunks + 1;
+    slots.assign((size_t)(ringChunks * ringChunks), RingSlot{ 0, 0 });
+    blank.assign((size_t)CHUNK_SIZE * CHUNK_SIZE * 4, 0);
+}
+
+Minimap::~Minimap()
+{
+    Reset();
+}
+
+void Minimap::Reset()
+{
+    if (ring)
+    {
+        UnloadTexture(ring);
+        ring = nullptr;
+    }
+    slots.assign(slots.size(), RingSlot{ 0, 0 });
+    thumbnails.clear();
+}
+
+const Minimap::Thumbnail* Minimap::RefreshThumbnail(ForgeWorld* world, int cx, int cy, int mode)
+{
+    unsigned char types[CHUNK_SIZE * CHUNK_SIZE];
+    if (!World_GetChunkTiles(world, cx, cy, mode, types))
+        return nullptr;
+
+    unsigned char palette[TILE_CAVE_ENTRANCE + 1][4];
+    for (int t = 0; t <= TILE_CAVE_ENTRANCE; t++)
+    {
+        Vec4 c = World_GetTileColor((TileType)t);
+        palette[t][0] = ColorByte(c.x);
+        palette[t][1] = ColorByte(c.y);
+        palette[t][2] = ColorByte(c.z);
+        palette[t][3] = t == TILE_EMPTY ? 0 : ColorByte(c.w);
+    }
+
+    Thumbnail& thumb = thumbnails[ThumbnailKey(cx, cy, mode)];
+    thumb.cx = cx;
+    thumb.cy = cy;
+    thumb.revision = World_PeekChunkRevision(world, cx, cy, mode);
+    thumb.pixels.resize((size_t)CHUNK_SIZE * CHUNK_SIZE * 4);
+
+    float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++)
+    {
+        int t = types[i] <= TILE_CAVE_ENTRANCE ? (int)types[i] : (int)TILE_EMPTY;
+        std::memcpy(&thumb.pixels[(size_t)i * 4], palette[t], 4);
+        for (int c = 0; c < 4; c++)
+            sum[c] += palette[t][c];
+    }
+    float n = (float)(CHUNK_SIZE * CHUNK_SIZE) * 255.0f;
+    thumb.average = Color{ sum[0] / n, sum[1] / n, sum[2] / n, sum[3] / n };
+    return &thumb;
+}
+
+void Minimap::UploadSlot(int cx, int cy, long long key, const Thumbnail* thumb)
+{
+    int sx = PositiveMod(cx, ringChunks);
+    int sy = PositiveMod(cy, ringChunks);
+    UpdateTextureRec(ring, Rect{ (float)(sx * CHUNK_SIZE), (float)(sy * CHUNK_SIZE), (float)CHUNK_SIZE, (float)CHUNK_SIZE },
+                     thumb ? thumb->pixels.data() : blank.data());
+
+    RingSlot& slot = slots[(size_t)(sy * ringChunks + sx)];
+    slot.key = key;
+    slot.revision = thumb ? thumb->revision : 0;
+}
+
+void Minimap::TrimThumbnails(int centerCx, int centerCy)
+{
+    if (thumbnails.size() <= MINIMAP_MAX_THUMBNAILS)
+        return;
+
+    // slots only remember keys, so a dropped thumbnail that is still shown is rebuilt
+    std::vector<std::pair<long long, long long>> byDistance;
+    byDistance.reserve(thumbnails.size());
+    for (const auto& entry : thumbnails)
+    {
+        long long dx = (long long)entry.second.cx - centerCx;
+        long long dy = (long long)entry.second.cy - centerCy;
+        byDistance.push_back({ dx * dx + dy * dy, entry.first });
+    }
+
+    size_t keep = MINIMAP_MAX_THUMBNAILS * 3 / 4;
+    std::nth_element(byDistance.begin(), byDistance.begin() + (std::ptrdiff_t)keep, byDistance.end());
+    for (size_t i = keep; i < byDistance.size(); i++)
+        thumbnails.erase(byDistance[i].second);
+}
+
+void Minimap::Update(ForgeWorld* world, Vec2 center, float tileSize)
+{
+    if (!world)
+        return;
+
+    Renderer* renderer = GetGlobalRenderer();
+    if (!ring && renderer && Renderer_GetBackend(renderer) == RENDERER_BACKEND_OPENGL)
+    {
+        int size = ringChunks * CHUNK_SIZE;
+        std::vector<unsigned char> clear((size_t)size * size * 4, 0);
+        ring = LoadTextureFromPixels(clear.data(), size, size);
+        if (ring)
+        {
+            SetTextureFilter(ring, TEXTURE_FILTER_POINT);
+            SetTextureWrap(ring, TEXTURE_WRAP_REPEAT);
+        }
+        slots.assign(slots.size(), RingSlot{ 0, 0 });
+    }
+    mode = world->isCave;
+    // uploads are dropped on other backends, so the slots must not be marked current
+    bool useRing = ring && renderer && Renderer_GetBackend(renderer) == RENDERER_BACKEND_OPENGL;
+
+    float half = viewChunks * CHUNK_SIZE * 0.5f;
+    float tileX = center.x / tileSize;
+    float tileY = center.y / tileSize;
+    int cx0 = FloorDiv((int)floorf(tileX - half), CHUNK_SIZE);
+    int cy0 = FloorDiv((int)floorf(tileY - half), CHUNK_SIZE);
+    int cx1 = FloorDiv((int)floorf(tileX + half), CHUNK_SIZE);
+    int cy1 = FloorDiv((int)floorf(tileY + half), CHUNK_SIZE);
+
+    int uploads = MINIMAP_UPLOADS_PER_FRAME;
+    for (int cy = cy0; cy <= cy1 && uploads > 0; cy++)
+    {
+        for (int cx = cx0; cx <= cx1 && uploads > 0; cx++)
+        {
+            long long key = ThumbnailKey(cx, cy, mode);
+            // chunks the world has not loaded keep their last thumbnail, or stay blank
+            unsigned int revision = World_PeekChunkRevision(world, cx, cy, mode);
+            auto it = thumbnails.find(key);
+            const Thumbnail* thumb = it != thumbnails.end() ? &it->second : nullptr;
+            bool stale = revision != 0 && (!thumb || thumb->revision != revision);
+
+            bool shown = true;
+            if (useRing)
+            {
+                const RingSlot& slot = slots[(size_t)(PositiveMod(cy, ringChunks) * ringChunks + PositiveMod(cx, ringChunks))];
+                shown = thumb ? (slot.revision == thumb->revision && slot.key == key) : slot.revision == 0;
+            }
+            if (!stale && shown)
+                continue;
+
+            uploads--;
+            if (stale)
+                thumb = RefreshThumbnail(world, cx, cy, mode);
+            if (useRing)
+                UploadSlot(cx, cy, key, thumb);
+        }
+    }
+
+    TrimThumbnails((cx0 + cx1) / 2, (cy0 + cy1) / 2);
+}
+
+void Minimap::Draw(Rect dest, Vec2 center, float tileSize) const
+{
+    Renderer_DrawRectangle(dest, Color{ 0.05f, 0.05f, 0.08f, 0.75f });
+
+    float viewTiles = (float)(viewChunks * CHUNK_SIZE);
+    float tileX = center.x / tileSize - viewTiles * 0.5f;
+    float tileY = center.y / tileSize - viewTiles * 0.5f;
+    Renderer* renderer = GetGlobalRenderer();
+    if (ring && renderer && Renderer_GetBackend(renderer) == RENDERER_BACKEND_OPENGL)
+    {
+        // the ring repeats, so the source rect may run past its edge and wrap around
+        float ringTiles = (float)(ringChunks * CHUNK_SIZE);
+        float u = tileX - floorf(tileX / ringTiles) * ringTiles;
+        float v = tileY - floorf(tileY / ringTiles) * ringTiles;
+        Renderer_DrawTexturePro(*ring, Rect{ u, v, viewTiles, viewTiles }, dest, Vec2{ 0.0f, 0.0f }, 0.0f, Color{ 1, 1, 1, 1 });
+    }
+    else
+    {
+        // no texture to scroll: one rectangle per chunk in its average color
+        float scale = dest.width / viewTiles;
+        int cx0 = FloorDiv((int)floorf(tileX), CHUNK_SIZE);
+        int cy0 = FloorDiv((int)floorf(tileY), CHUNK_SIZE);
+        int cx1 = FloorDiv((int)floorf(tileX + viewTiles), CHUNK_SIZE);
+        int cy1 = FloorDiv((int)floorf(tileY + viewTiles), CHUNK_SIZE);
+        for (int cy = cy0; cy <= cy1; cy++)
+        {
+            for (int cx = cx0; cx <= cx1; cx++)
+            {
+                auto it = thumbnails.find(ThumbnailKey(cx, cy, mode));
+                if (it == thumbnails.end())
+                    continue;
+
+                float x0 = std::fmax(dest.x, dest.x + ((float)(cx * CHUNK_SIZE) - tileX) * scale);
+                float y0 = std::fmax(dest.y, dest.y + ((float)(cy * CHUNK_SIZE) - tileY) * scale);
+                float x1 = std::fmin(dest.x + dest.width, dest.x + ((float)((cx + 1) * CHUNK_SIZE) - tileX) * scale);
+                float y1 = std::fmin(dest.y + dest.height, dest.y + ((float)((cy + 1) * CHUNK_SIZE) - tileY) * scale);
+                if (x1 > x0 && y1 > y0)
+                    Renderer_DrawRectangle(Rect{ x0, y0, x1 - x0, y1 - y0 }, it->second.average);
+            }
+        }
+    }
+
+    Renderer_DrawRectangle(Rect{ dest.x + dest.width * 0.5f - 2.0f, dest.y + dest.height * 0.5f - 2.0f, 4.0f, 4.0f }, Color{ 1.0f, 0.1f, 0.1f, 1.0f });
+    Renderer_DrawRectangleLines(dest, 2, Color{ 0.8f, 0.8f, 0.85f, 0.9f });
+}
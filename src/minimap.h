@@ -0,0 +1,57 @@
+#ifndef __MINIMAP_H__
+#define __MINIMAP_H__
+
+#include "engine/forge.h"
+#include <unordered_map>
+#include <vector>
+
+// Map of the chunks around the player built from per-chunk thumbnails (one
+// texel per tile). Thumbnails are rebuilt only when a chunk's revision changes
+// and are kept after the chunk scrolls away, so revisited areas cost nothing;
+// past MINIMAP_MAX_THUMBNAILS the ones farthest from the player are dropped.
+// On screen they are composed into a ring texture addressed by chunk
+// coordinate modulo its size: moving only uploads the newly revealed chunks
+// and the view scrolls by offsetting texture coordinates.
+class Minimap
+{
+public:
+    // viewChunks is how many chunks fit across the map
+    explicit Minimap(int viewChunks = 6);
+    ~Minimap();
+
+    // forgets every thumbnail and releases the texture; call when the world is
+    // replaced and before the renderer goes away
+    void Reset();
+    void Update(ForgeWorld* world, Vec2 center, float tileSize);
+    void Draw(Rect dest, Vec2 center, float tileSize) const;
+
+private:
+    struct Thumbnail
+    {
+        int cx;
+        int cy;
+        unsigned int revision;
+        Color average;      // drawn instead of the texture on backends without one
+        std::vector<unsigned char> pixels;
+    };
+
+    struct RingSlot
+    {
+        long long key;      // chunk shown in the slot; meaningless while revision is 0 (blank)
+        unsigned int revision;
+    };
+
+    const Thumbnail* RefreshThumbnail(ForgeWorld* world, int cx, int cy, int mode);
+    void UploadSlot(int cx, int cy, long long key, const Thumbnail* thumb);
+    void TrimThumbnails(int centerCx, int centerCy);
+
+    int viewChunks;
+    int ringChunks;
+    Texture2D* ring;
+    std::vector<RingSlot> slots;
+    std::unordered_map<long long, Thumbnail> thumbnails;
+    std::vector<unsigned char> blank;
+    int mode;
+};
+
+#endif // __MINIMAP_H__
@@ -31,14 +31,14 @@ RemotePlayer* FindRemote(std::vector<RemotePlayer>& list, uint8_t id)
 }
 
 void UpdateMultiplayerInput(Player& player, World* world, NetInputState& netInput,
-                           Texture2D* weaponSprite, bool uiBlockInput,
+                           Texture2D* weaponSprite, bool attackPressed,
                            float& attackBufferTimer, Vec2& lastAttackDir,
                            const Camera2D& camera, float dt)
 {
     (void)world;
     if (attackBufferTimer > 0.0f)
         attackBufferTimer -= dt;
-    if (weaponSprite && !uiBlockInput && Input_IsMousePressed(MOUSE_LEFT))
+    if (weaponSprite && weaponSprite->width > 0 && attackPressed)
     {
         Vec2 mouse = { (float)Input_GetMouseX(), (float)Input_GetMouseY() };
         Vec2 worldMouse = { camera.x + mouse.x / camera.zoom, camera.y + mouse.y / camera.zoom };
@@ -102,7 +102,7 @@ void ProcessNetworkSnapshot(const NetPlayerState* snap, int snapCount, uint8_t l
 
             if (mpMode == MpMode::Client)
             {
-                while (!pendingInputs.empty() && pendingInputs.front().seq <= ps.lastInputSeq)
+                while (!pendingInputs.empty() && !Net_SeqNewer(pendingInputs.front().seq, ps.lastInputSeq))
                 {
                     pendingInputs.erase(pendingInputs.begin());
                 }
@@ -28,7 +28,7 @@ Color ColorForId(uint8_t id);
 RemotePlayer* FindRemote(std::vector<RemotePlayer>& list, uint8_t id);
 
 void UpdateMultiplayerInput(Player& player, World* world, NetInputState& netInput,
-                           Texture2D* weaponSprite, bool uiBlockInput,
+                           Texture2D* weaponSprite, bool attackPressed,
                            float& attackBufferTimer, Vec2& lastAttackDir,
                            const Camera2D& camera, float dt);
 
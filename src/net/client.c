@@ -1,4 +1,5 @@
 #include "client.h"
+#include "replication.h"
 #include <string.h>
 
 static bool SendHello(ClientState* c)
@@ -48,6 +49,10 @@ static void HandleSnapshot(ClientState* c, const uint8_t* payload, int payloadLe
         memcpy(&p->attackBaseAngle, payload + offset, sizeof(float)); offset += sizeof(float);
         memcpy(&p->lastInputSeq, payload + offset, sizeof(uint16_t)); offset += sizeof(uint16_t);
     }
+
+    if (c->playerCount == count && offset + (int)sizeof(float) <= payloadLen)
+        memcpy(&c->serverTickMs, payload + offset, sizeof(float));
+    c->snapshotsReceived++;
 }
 
 static void HandleMobs(ClientState* c, const uint8_t* payload, int payloadLen)
@@ -69,6 +74,95 @@ static void HandleMobs(ClientState* c, const uint8_t* payload, int payloadLen)
     }
 }
 
+static void HandleWelcome(ClientState* c, const uint8_t* payload, int payloadLen)
+{
+    if (payloadLen >= 1 + 1 + (int)sizeof(int))
+    {
+        c->playerId = payload[0];
+        memcpy(&c->seed, payload + 2, sizeof(int));
+    }
+    int serverVersion = 0;
+    if (payloadLen >= 1 + 1 + (int)sizeof(int) * 2)
+        memcpy(&serverVersion, payload + 6, sizeof(int));
+    c->send.bundle = serverVersion >= NET_BUNDLE_MIN_VERSION;
+
+    float amounts[3];
+    if (!c->world || payloadLen < 1 + 1 + (int)sizeof(int) * 2 + (int)sizeof(amounts))
+        return;
+    memcpy(amounts, payload + 10, sizeof(amounts));
+
+    // untouched chunks are generated locally, so the generator must match the server's
+    ForgeWorld* w = c->world;
+    if (w->seed != c->seed || w->waterAmount != amounts[0] || w->stoneAmount != amounts[1] || w->caveAmount != amounts[2])
+    {
+        w->seed = c->seed;
+        w->waterAmount = amounts[0];
+        w->stoneAmount = amounts[1];
+        w->caveAmount = amounts[2];
+        World_SetCaveMode(w, 0);
+        World_ReloadChunks(w);
+    }
+}
+
+static void SendChunkDropped(ClientState* c, int cx, int cy, int mode)
+{
+    uint8_t frame[16];
+    int len = Net_WriteChunkDropped(frame, (int)sizeof(frame), cx, cy, mode);
+    if (len > 0)
+        NetSendBuffer_Append(&c->send, frame, len);
+}
+
+static void HandleChunkData(ClientState* c, const uint8_t* payload, int payloadLen)
+{
+    if (!c->world) return;
+    int cx, cy, mode;
+    uint8_t tiles[CHUNK_SIZE * CHUNK_SIZE];
+    if (!Net_ReadChunkData(payload, payloadLen, &cx, &cy, &mode, tiles))
+        return;
+
+    // the server has marked this chunk as sent, so with the chunk map full a
+    // far chunk makes room, and any streamed chunk that is not kept is asked for again
+    if (!World_SetChunkTiles(c->world, cx, cy, mode, tiles))
+    {
+        int ex, ey, emode, emodified;
+        if (World_EvictFarChunk(c->world, cx, cy, mode, &ex, &ey, &emode, &emodified) && emodified)
+            SendChunkDropped(c, ex, ey, emode);
+        if (!World_SetChunkTiles(c->world, cx, cy, mode, tiles))
+        {
+            SendChunkDropped(c, cx, cy, mode);
+            return;
+        }
+    }
+    c->chunksReceived++;
+}
+
+static void HandleTileEdits(ClientState* c, const uint8_t* payload, int payloadLen)
+{
+    if (!c->world) return;
+    TileEdit edits[NET_MAX_EDITS_PER_MESSAGE];
+    int count = Net_ReadTileEdits(payload, payloadLen, edits, NET_MAX_EDITS_PER_MESSAGE);
+    for (int i = 0; i < count; ++i)
+        World_ApplyEdit(c->world, &edits[i], 0);
+    c->editsReceived += (uint32_t)count;
+}
+
+static void SendLocalEdits(ClientState* c)
+{
+    if (!c->world) return;
+
+    TileEdit edits[NET_MAX_EDITS_PER_MESSAGE];
+    uint8_t frame[NET_MAX_MESSAGE];
+    while (c->world->editCount > 0)
+    {
+        if (NET_BUFFER_SIZE - c->send.len < NET_MAX_MESSAGE)
+            break;
+        int count = World_PopEdits(c->world, edits, NET_MAX_EDITS_PER_MESSAGE);
+        int len = Net_WriteTileEdits(frame, (int)sizeof(frame), edits, count);
+        if (len <= 0 || !NetSendBuffer_Append(&c->send, frame, len))
+            break;
+    }
+}
+
 bool Client_Init(ClientState* c)
 {
     if (!c) return false;
@@ -91,8 +185,10 @@ bool Client_Connect(ClientState* c, const char* host, uint16_t port)
     }
 
     Net_SetNonBlocking(&c->sock, true);
+    Net_SetNoDelay(&c->sock, true);
     NetRecvBuffer_Init(&c->recv);
     NetSendBuffer_Init(&c->send);
+    c->pingSentTime = 0.0;
     c->connected = true;
 
     SendHello(c);
@@ -105,6 +201,17 @@ void Client_Disconnect(ClientState* c)
     if (Net_IsValid(c->sock))
         Net_Close(&c->sock);
     c->connected = false;
+    Client_SetWorld(c, NULL);
+}
+
+void Client_SetWorld(ClientState* c, ForgeWorld* world)
+{
+    if (!c) return;
+    if (c->world && c->world != world)
+        World_EnableEditLog(c->world, 0);
+    c->world = world;
+    if (world)
+        World_EnableEditLog(world, 1);
 }
 
 void Client_Update(ClientState* c, float dt)
@@ -118,6 +225,7 @@ void Client_Update(ClientState* c, float dt)
         int r = Net_Recv(&c->sock, temp, (int)sizeof(temp));
         if (r > 0)
         {
+            c->bytesReceived += (uint64_t)r;
             if (!NetRecvBuffer_Push(&c->recv, temp, r))
             {
                 Client_Disconnect(c);
@@ -131,11 +239,7 @@ void Client_Update(ClientState* c, float dt)
             {
                 if (type == MSG_WELCOME)
                 {
-                    if (payloadLen >= 1 + 1 + (int)sizeof(int))
-                    {
-                        c->playerId = payload[0];
-                        memcpy(&c->seed, payload + 2, sizeof(int));
-                    }
+                    HandleWelcome(c, payload, payloadLen);
                 }
                 else if (type == MSG_SNAPSHOT)
                 {
@@ -145,6 +249,30 @@ void Client_Update(ClientState* c, float dt)
                 {
                     HandleMobs(c, payload, payloadLen);
                 }
+                else if (type == MSG_CHUNK_DATA)
+                {
+                    HandleChunkData(c, payload, payloadLen);
+                }
+                else if (type == MSG_TILE_EDITS)
+                {
+                    HandleTileEdits(c, payload, payloadLen);
+                }
+                else if (type == MSG_PING)
+                {
+                    uint8_t pong[3] = { 1, 0, (uint8_t)MSG_PONG };
+                    NetSendBuffer_Append(&c->send, pong, (int)sizeof(pong));
+                }
+                else if (type == MSG_PONG && c->pingSentTime > 0.0)
+                {
+                    c->rttMs = (float)((Net_GetTime() - c->pingSentTime) * 1000.0);
+                    c->pingSentTime = 0.0;
+                    c->pongsReceived++;
+                }
+            }
+            if (c->recv.error)
+            {
+                Client_Disconnect(c);
+                return;
             }
         }
         else if (r == 0)
@@ -162,7 +290,13 @@ void Client_Update(ClientState* c, float dt)
         }
     }
 
+    if (!c->connected) return;
+
+    SendLocalEdits(c);
+
+    int pending = c->send.len - c->send.offset;
     NetSendBuffer_Flush(&c->send, &c->sock);
+    c->bytesSent += (uint64_t)(pending - (c->send.len - c->send.offset));
 }
 
 void Client_SendInput(ClientState* c, const NetInputState* in)
@@ -186,6 +320,15 @@ void Client_SendInput(ClientState* c, const NetInputState* in)
     NetSendBuffer_Append(&c->send, msg, (int)(2 + totalLen));
 }
 
+void Client_SendPing(ClientState* c)
+{
+    if (!c || !c->connected || c->pingSentTime > 0.0) return;
+
+    uint8_t ping[3] = { 1, 0, (uint8_t)MSG_PING };
+    if (NetSendBuffer_Append(&c->send, ping, (int)sizeof(ping)))
+        c->pingSentTime = Net_GetTime();
+}
+
 int Client_GetSnapshot(ClientState* c, NetPlayerState* outPlayers, int maxPlayers, bool* outIsNight, float* outCycleTimer)
 {
     if (!c || !outPlayers || maxPlayers <= 0) return 0;
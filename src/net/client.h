@@ -3,6 +3,7 @@
 
 #include "net.h"
 #include "protocol.h"
+#include "engine/worldgen.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -29,13 +30,29 @@ typedef struct ClientState
 
     NetMobState mobs[NET_MAX_MOBS];
     int mobCount;
+
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+    uint32_t snapshotsReceived;
+    float serverTickMs;
+
+    ForgeWorld* world;
+    uint32_t chunksReceived;
+    uint32_t editsReceived;
+
+    double pingSentTime;    // 0 when no ping is outstanding
+    float rttMs;            // of the last answered Client_SendPing
+    uint32_t pongsReceived;
 } ClientState;
 
 bool Client_Init(ClientState* c);
 bool Client_Connect(ClientState* c, const char* host, uint16_t port);
 void Client_Disconnect(ClientState* c);
+void Client_SetWorld(ClientState* c, ForgeWorld* world);
 void Client_Update(ClientState* c, float dt);
 void Client_SendInput(ClientState* c, const NetInputState* in);
+// times a round trip to the server; ignored while the previous ping is unanswered
+void Client_SendPing(ClientState* c);
 int  Client_GetSnapshot(ClientState* c, NetPlayerState* outPlayers, int maxPlayers, bool* outIsNight, float* outCycleTimer);
 bool Client_IsConnected(ClientState* c);
 
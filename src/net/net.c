@@ -1,5 +1,10 @@
 #include "net.h"
+#include "protocol.h"
 #include <string.h>
+#ifndef _WIN32
+#include <netinet/tcp.h>
+#include <time.h>
+#endif
 
 static bool g_net_inited = false;
 
@@ -77,6 +82,25 @@ bool Net_SetNonBlocking(NetSocket* s, bool nonBlocking)
 #endif
 }
 
+bool Net_SetNoDelay(NetSocket* s, bool noDelay)
+{
+    if (!s || !Net_IsValid(*s)) return false;
+    int flag = noDelay ? 1 : 0;
+    return setsockopt(s->handle, IPPROTO_TCP, TCP_NODELAY, (const char*)&flag, sizeof(flag)) == 0;
+}
+
+bool Net_SetSendBufferSize(NetSocket* s, int bytes)
+{
+    if (!s || !Net_IsValid(*s) || bytes <= 0) return false;
+    return setsockopt(s->handle, SOL_SOCKET, SO_SNDBUF, (const char*)&bytes, sizeof(bytes)) == 0;
+}
+
+bool Net_SetRecvBufferSize(NetSocket* s, int bytes)
+{
+    if (!s || !Net_IsValid(*s) || bytes <= 0) return false;
+    return setsockopt(s->handle, SOL_SOCKET, SO_RCVBUF, (const char*)&bytes, sizeof(bytes)) == 0;
+}
+
 bool Net_Bind(NetSocket* s, uint16_t port)
 {
     if (!s || !Net_IsValid(*s)) return false;
@@ -151,6 +175,8 @@ int Net_Send(NetSocket* s, const void* data, int len)
     if (!data || len <= 0) return 0;
 #ifdef _WIN32
     return send(s->handle, (const char*)data, len, 0);
+#elif defined(MSG_NOSIGNAL)
+    return (int)send(s->handle, data, (size_t)len, MSG_NOSIGNAL);
 #else
     return (int)send(s->handle, data, (size_t)len, 0);
 #endif
@@ -172,7 +198,23 @@ bool Net_WouldBlock(void)
     int err = WSAGetLastError();
     return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
 #else
-    return false;
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS;
+#endif
+}
+
+double Net_GetTime(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
 #endif
 }
 
@@ -180,6 +222,8 @@ void NetRecvBuffer_Init(NetRecvBuffer* b)
 {
     if (!b) return;
     b->len = 0;
+    b->bundleLeft = 0;
+    b->error = false;
 }
 
 bool NetRecvBuffer_Push(NetRecvBuffer* b, const uint8_t* data, int len)
@@ -191,26 +235,76 @@ bool NetRecvBuffer_Push(NetRecvBuffer* b, const uint8_t* data, int len)
     return true;
 }
 
+static void NetRecvBuffer_Consume(NetRecvBuffer* b, int count)
+{
+    b->len -= count;
+    if (b->len > 0)
+        memmove(b->data, b->data + count, (size_t)b->len);
+}
+
 bool NetRecvBuffer_PopMessage(NetRecvBuffer* b, uint8_t* outType, uint8_t* outPayload, int* outPayloadLen)
 {
-    if (!b || b->len < 3) return false;
+    if (!b || b->error) return false;
 
-    uint16_t msgLen = (uint16_t)(b->data[0] | (b->data[1] << 8));
-    if (msgLen > NET_MAX_MESSAGE) return false;
-    if (b->len < (int)(2 + msgLen)) return false;
+    // the bundle header is dropped as soon as it arrives and its entries are read
+    // as they come in; waiting for the whole bundle could need more than the buffer holds
+    if (b->bundleLeft == 0 && b->len >= 3 && b->data[2] == MSG_BUNDLE)
+    {
+        int bodyLen = (int)(b->data[0] | (b->data[1] << 8)) - 1;
+        if (bodyLen < 2 || bodyLen > NET_BUFFER_SIZE - NET_BUNDLE_HEADER)
+        {
+            b->error = true;
+            return false;
+        }
+        b->bundleLeft = bodyLen;
+        NetRecvBuffer_Consume(b, NET_BUNDLE_HEADER);
+    }
 
-    uint8_t type = b->data[2];
-    int payloadLen = (int)msgLen - 1;
+    uint8_t type;
+    int headerLen;
+    int payloadLen;
+    if (b->bundleLeft > 0)
+    {
+        if (b->len < 2) return false;
+        type = b->data[0];
+        headerLen = 2;
+        payloadLen = b->data[1];
+        if (payloadLen & 0x80)
+        {
+            if (b->len < 3) return false;
+            headerLen = 3;
+            payloadLen = (payloadLen & 0x7F) | (b->data[2] << 7);
+        }
+        // entries have to end exactly where the bundle says it ends
+        if (type == MSG_BUNDLE || payloadLen > NET_MAX_MESSAGE - 1 || headerLen + payloadLen > b->bundleLeft)
+        {
+            b->error = true;
+            return false;
+        }
+    }
+    else
+    {
+        if (b->len < 3) return false;
+        uint16_t msgLen = (uint16_t)(b->data[0] | (b->data[1] << 8));
+        if (msgLen < 1 || msgLen > NET_MAX_MESSAGE)
+        {
+            b->error = true;
+            return false;
+        }
+        type = b->data[2];
+        headerLen = 3;
+        payloadLen = (int)msgLen - 1;
+    }
+    if (b->len < headerLen + payloadLen) return false;
 
     if (outType) *outType = type;
     if (outPayload && payloadLen > 0)
-        memcpy(outPayload, b->data + 3, (size_t)payloadLen);
+        memcpy(outPayload, b->data + headerLen, (size_t)payloadLen);
     if (outPayloadLen) *outPayloadLen = payloadLen;
 
-    int remaining = b->len - (2 + (int)msgLen);
-    if (remaining > 0)
-        memmove(b->data, b->data + 2 + msgLen, (size_t)remaining);
-    b->len = remaining;
+    if (b->bundleLeft > 0)
+        b->bundleLeft -= headerLen + payloadLen;
+    NetRecvBuffer_Consume(b, headerLen + payloadLen);
 
     return true;
 }
@@ -220,6 +314,8 @@ void NetSendBuffer_Init(NetSendBuffer* b)
     if (!b) return;
     b->len = 0;
     b->offset = 0;
+    b->sealed = 0;
+    b->bundle = false;
 }
 
 bool NetSendBuffer_Append(NetSendBuffer* b, const uint8_t* data, int len)
@@ -231,9 +327,64 @@ bool NetSendBuffer_Append(NetSendBuffer* b, const uint8_t* data, int len)
     return true;
 }
 
+static int BundleEntryHeader(int payloadLen)
+{
+    return payloadLen < 0x80 ? 2 : 3;
+}
+
+// Rewrites the frames appended since the last seal as one bundle, but only when
+// that is smaller than sending them as they are, so a bundle never costs bytes.
+static void NetSendBuffer_Seal(NetSendBuffer* b)
+{
+    int start = b->sealed;
+    int size = b->len - start;
+    if (size <= 0) return;
+
+    int bundled = NET_BUNDLE_HEADER;
+    for (int at = start; at < b->len;)
+    {
+        int payloadLen = (int)(b->data[at] | (b->data[at + 1] << 8)) - 1;
+        bundled += BundleEntryHeader(payloadLen) + payloadLen;
+        at += 3 + payloadLen;
+    }
+
+    if (bundled < size)
+    {
+        uint8_t frames[NET_BUFFER_SIZE];
+        memcpy(frames, b->data + start, (size_t)size);
+
+        uint16_t totalLen = (uint16_t)(bundled - 2);
+        uint8_t* out = b->data + start;
+        *out++ = (uint8_t)(totalLen & 0xFF);
+        *out++ = (uint8_t)((totalLen >> 8) & 0xFF);
+        *out++ = (uint8_t)MSG_BUNDLE;
+        for (int at = 0; at < size;)
+        {
+            int payloadLen = (int)(frames[at] | (frames[at + 1] << 8)) - 1;
+            *out++ = frames[at + 2];
+            if (payloadLen < 0x80)
+            {
+                *out++ = (uint8_t)payloadLen;
+            }
+            else
+            {
+                *out++ = (uint8_t)(0x80 | (payloadLen & 0x7F));
+                *out++ = (uint8_t)(payloadLen >> 7);
+            }
+            memcpy(out, frames + at + 3, (size_t)payloadLen);
+            out += payloadLen;
+            at += 3 + payloadLen;
+        }
+        b->len = start + bundled;
+    }
+    b->sealed = b->len;
+}
+
 bool NetSendBuffer_Flush(NetSendBuffer* b, NetSocket* s)
 {
     if (!b || !s || !Net_IsValid(*s)) return false;
+    if (b->bundle)
+        NetSendBuffer_Seal(b);
     if (b->offset >= b->len) return true;
 
     int toSend = b->len - b->offset;
@@ -249,6 +400,7 @@ bool NetSendBuffer_Flush(NetSendBuffer* b, NetSocket* s)
     {
         b->len = 0;
         b->offset = 0;
+        b->sealed = 0;
     }
     return true;
 }
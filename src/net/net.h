@@ -12,6 +12,8 @@
 #else
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
 #endif
@@ -33,10 +35,17 @@ typedef struct NetSocket
 #define NET_MAX_MESSAGE 2048
 #define NET_BUFFER_SIZE 8192
 
+// A bundle is one [len16][MSG_BUNDLE] frame whose body holds the tick's messages
+// as compact entries: [type][len], where len is the payload size in one byte
+// below 0x80 and otherwise in two (low 7 bits with 0x80 set, then the rest).
+#define NET_BUNDLE_HEADER 3
+
 typedef struct NetRecvBuffer
 {
     uint8_t data[NET_BUFFER_SIZE];
     int len;
+    int bundleLeft; // body bytes of the current bundle not read yet
+    bool error;     // set on a malformed frame; the peer should be dropped
 } NetRecvBuffer;
 
 typedef struct NetSendBuffer
@@ -44,6 +53,8 @@ typedef struct NetSendBuffer
     uint8_t data[NET_BUFFER_SIZE];
     int len;
     int offset;
+    int sealed;
+    bool bundle;
 } NetSendBuffer;
 
 bool Net_Init(void);
@@ -53,6 +64,9 @@ NetSocket Net_CreateTCP(void);
 bool Net_IsValid(NetSocket s);
 void Net_Close(NetSocket* s);
 bool Net_SetNonBlocking(NetSocket* s, bool nonBlocking);
+bool Net_SetNoDelay(NetSocket* s, bool noDelay);
+bool Net_SetSendBufferSize(NetSocket* s, int bytes);
+bool Net_SetRecvBufferSize(NetSocket* s, int bytes);
 
 bool Net_Bind(NetSocket* s, uint16_t port);
 bool Net_Listen(NetSocket* s);
@@ -62,6 +76,7 @@ bool Net_Connect(NetSocket* s, const char* host, uint16_t port);
 int  Net_Send(NetSocket* s, const void* data, int len);
 int  Net_Recv(NetSocket* s, void* data, int len);
 bool Net_WouldBlock(void);
+double Net_GetTime(void);
 
 void NetRecvBuffer_Init(NetRecvBuffer* b);
 bool NetRecvBuffer_Push(NetRecvBuffer* b, const uint8_t* data, int len);
@@ -3,17 +3,34 @@
 
 #include <stdint.h>
 
-#define NET_PROTOCOL_VERSION 2
+#define NET_PROTOCOL_VERSION 4
+// version 3 bundled whole frames; 4 packs compact entries, see net.h
+#define NET_BUNDLE_MIN_VERSION 4
 #define NET_MAX_PLAYERS 8
+// seconds between the snapshots the server sends each client
+#define NET_SNAPSHOT_INTERVAL 0.033f
 #define NET_MAX_MOBS 64
 
+#define NET_CHUNK_ENCODING_RAW 0
+#define NET_CHUNK_ENCODING_RLE 1
+#define NET_TILE_EDIT_SIZE 10
+#define NET_MAX_EDITS_PER_MESSAGE 128
+
 typedef enum NetMsgType
 {
     MSG_HELLO = 1,
     MSG_WELCOME = 2,
     MSG_INPUT = 3,
     MSG_SNAPSHOT = 4,
-    MSG_MOBS = 5
+    MSG_MOBS = 5,
+    MSG_PING = 6,
+    MSG_PONG = 7,
+    MSG_BUNDLE = 8,
+    MSG_CHUNK_DATA = 9,
+    MSG_TILE_EDITS = 10,
+    MSG_CHUNK_DROPPED = 11,
+
+    MSG_TYPE_COUNT
 } NetMsgType;
 
 typedef struct NetPlayerState
@@ -50,4 +67,10 @@ typedef struct NetMobState
     float hp;
 } NetMobState;
 
+// true when sequence a comes after b, allowing for uint16 wraparound
+static inline int Net_SeqNewer(uint16_t a, uint16_t b)
+{
+    return (int16_t)(uint16_t)(a - b) > 0;
+}
+
 #endif // __NET_PROTOCOL_H__
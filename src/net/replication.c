@@ -0,0 +1,162 @@
+#include "replication.h"
+#include <string.h>
+
+#define CHUNK_TILE_COUNT (CHUNK_SIZE * CHUNK_SIZE)
+#define CHUNK_HEADER_SIZE 10
+
+static int EncodeRLE(const uint8_t* tiles, uint8_t* out, int outSize)
+{
+    int len = 0;
+    int i = 0;
+    while (i < CHUNK_TILE_COUNT)
+    {
+        uint8_t type = tiles[i];
+        int run = 1;
+        while (i + run < CHUNK_TILE_COUNT && run < 255 && tiles[i + run] == type)
+            run++;
+        if (len + 2 > outSize)
+            return -1;
+        out[len++] = (uint8_t)run;
+        out[len++] = type;
+        i += run;
+    }
+    return len;
+}
+
+static bool DecodeRLE(const uint8_t* data, int len, uint8_t* outTiles)
+{
+    int at = 0;
+    for (int i = 0; i + 1 < len; i += 2)
+    {
+        int run = data[i];
+        if (run == 0 || at + run > CHUNK_TILE_COUNT)
+            return false;
+        memset(outTiles + at, data[i + 1], (size_t)run);
+        at += run;
+    }
+    return at == CHUNK_TILE_COUNT;
+}
+
+static void WriteFrameHeader(uint8_t* out, int frameLen, NetMsgType type)
+{
+    uint16_t totalLen = (uint16_t)(frameLen - 2);
+    out[0] = (uint8_t)(totalLen & 0xFF);
+    out[1] = (uint8_t)((totalLen >> 8) & 0xFF);
+    out[2] = (uint8_t)type;
+}
+
+int Net_WriteChunkData(uint8_t* out, int outSize, int cx, int cy, int mode, const uint8_t* tiles)
+{
+    if (!out || !tiles || outSize < 3 + CHUNK_HEADER_SIZE + CHUNK_TILE_COUNT) return 0;
+
+    int offset = 3;
+    memcpy(out + offset, &cx, sizeof(int)); offset += sizeof(int);
+    memcpy(out + offset, &cy, sizeof(int)); offset += sizeof(int);
+    out[offset++] = (uint8_t)(mode ? 1 : 0);
+
+    int encodingPos = offset++;
+    int rle = EncodeRLE(tiles, out + offset, CHUNK_TILE_COUNT - 1);
+    if (rle > 0)
+    {
+        out[encodingPos] = NET_CHUNK_ENCODING_RLE;
+        offset += rle;
+    }
+    else
+    {
+        out[encodingPos] = NET_CHUNK_ENCODING_RAW;
+        memcpy(out + offset, tiles, CHUNK_TILE_COUNT);
+        offset += CHUNK_TILE_COUNT;
+    }
+
+    WriteFrameHeader(out, offset, MSG_CHUNK_DATA);
+    return offset;
+}
+
+bool Net_ReadChunkData(const uint8_t* payload, int payloadLen, int* outCx, int* outCy, int* outMode, uint8_t* outTiles)
+{
+    if (!payload || !outTiles || payloadLen < CHUNK_HEADER_SIZE) return false;
+
+    int offset = 0;
+    memcpy(outCx, payload + offset, sizeof(int)); offset += sizeof(int);
+    memcpy(outCy, payload + offset, sizeof(int)); offset += sizeof(int);
+    *outMode = payload[offset++];
+    uint8_t encoding = payload[offset++];
+
+    const uint8_t* data = payload + offset;
+    int dataLen = payloadLen - offset;
+    if (encoding == NET_CHUNK_ENCODING_RAW)
+    {
+        if (dataLen != CHUNK_TILE_COUNT)
+            return false;
+        memcpy(outTiles, data, CHUNK_TILE_COUNT);
+        return true;
+    }
+    if (encoding == NET_CHUNK_ENCODING_RLE)
+        return DecodeRLE(data, dataLen, outTiles);
+    return false;
+}
+
+int Net_WriteTileEdits(uint8_t* out, int outSize, const TileEdit* edits, int count)
+{
+    if (!out || !edits || count <= 0) return 0;
+    if (count > NET_MAX_EDITS_PER_MESSAGE) count = NET_MAX_EDITS_PER_MESSAGE;
+
+    int frameLen = 4 + count * NET_TILE_EDIT_SIZE;
+    if (frameLen > outSize) return 0;
+
+    int offset = 3;
+    out[offset++] = (uint8_t)count;
+    for (int i = 0; i < count; ++i)
+    {
+        memcpy(out + offset, &edits[i].x, sizeof(int)); offset += sizeof(int);
+        memcpy(out + offset, &edits[i].y, sizeof(int)); offset += sizeof(int);
+        out[offset++] = edits[i].mode;
+        out[offset++] = edits[i].type;
+    }
+
+    WriteFrameHeader(out, offset, MSG_TILE_EDITS);
+    return offset;
+}
+
+int Net_ReadTileEdits(const uint8_t* payload, int payloadLen, TileEdit* outEdits, int maxEdits)
+{
+    if (!payload || !outEdits || payloadLen < 1) return 0;
+
+    int count = payload[0];
+    if (count > maxEdits) count = maxEdits;
+    if (1 + count * NET_TILE_EDIT_SIZE > payloadLen) count = (payloadLen - 1) / NET_TILE_EDIT_SIZE;
+
+    int offset = 1;
+    for (int i = 0; i < count; ++i)
+    {
+        memcpy(&outEdits[i].x, payload + offset, sizeof(int)); offset += sizeof(int);
+        memcpy(&outEdits[i].y, payload + offset, sizeof(int)); offset += sizeof(int);
+        outEdits[i].mode = payload[offset++];
+        outEdits[i].type = payload[offset++];
+    }
+    return count;
+}
+
+int Net_WriteChunkDropped(uint8_t* out, int outSize, int cx, int cy, int mode)
+{
+    int frameLen = 3 + (int)sizeof(int) * 2 + 1;
+    if (!out || outSize < frameLen) return 0;
+
+    int offset = 3;
+    memcpy(out + offset, &cx, sizeof(int)); offset += sizeof(int);
+    memcpy(out + offset, &cy, sizeof(int)); offset += sizeof(int);
+    out[offset++] = (uint8_t)(mode ? 1 : 0);
+
+    WriteFrameHeader(out, offset, MSG_CHUNK_DROPPED);
+    return offset;
+}
+
+bool Net_ReadChunkDropped(const uint8_t* payload, int payloadLen, int* outCx, int* outCy, int* outMode)
+{
+    if (!payload || payloadLen < (int)sizeof(int) * 2 + 1) return false;
+
+    memcpy(outCx, payload, sizeof(int));
+    memcpy(outCy, payload + sizeof(int), sizeof(int));
+    *outMode = payload[sizeof(int) * 2] ? 1 : 0;
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef __NET_REPLICATION_H__
+#define __NET_REPLICATION_H__
+
+#include "protocol.h"
+#include "engine/worldgen.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Both writers emit a complete length-prefixed frame and return its size, or 0 if it does not fit.
+int  Net_WriteChunkData(uint8_t* out, int outSize, int cx, int cy, int mode, const uint8_t* tiles);
+bool Net_ReadChunkData(const uint8_t* payload, int payloadLen, int* outCx, int* outCy, int* outMode, uint8_t* outTiles);
+
+int  Net_WriteTileEdits(uint8_t* out, int outSize, const TileEdit* edits, int count);
+int  Net_ReadTileEdits(const uint8_t* payload, int payloadLen, TileEdit* outEdits, int maxEdits);
+
+// sent by a client that no longer holds a streamed chunk, so the server sends it again
+int  Net_WriteChunkDropped(uint8_t* out, int outSize, int cx, int cy, int mode);
+bool Net_ReadChunkDropped(const uint8_t* payload, int payloadLen, int* outCx, int* outCy, int* outMode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __NET_REPLICATION_H__
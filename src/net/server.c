@@ -1,5 +1,8 @@
 #include "server.h"
+#include "replication.h"
 #include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
 #include <math.h>
 
 static const float PLAYER_SPEED = 200.0f;
@@ -9,6 +12,33 @@ static const float PLAYER_MAX_HP = 100.0f;
 static const float PLAYER_RESPAWN_TIME = 5.0f;
 static const float DAY_DURATION = 5.0f;
 static const float NIGHT_DURATION = 180.0f;
+static const float PING_INTERVAL = 1.0f;
+// rttMaxMs covers the previous window plus the current one
+static const float RTT_MAX_WINDOW = 10.0f;
+static const int SOCKET_SEND_BUFFER = 64 * 1024;
+static const float CHUNK_STREAM_RATE = 48.0f * 1024.0f;
+static const float CHUNK_STREAM_BURST = 16.0f * 1024.0f;
+static const float CHUNK_SCAN_INTERVAL = 0.1f;
+static const float EDIT_REACH_TILES = 64.0f;
+static const float INPUT_RATE_LIMIT = 240.0f;
+static const float INPUT_BURST = 60.0f;
+static const int RECV_BYTES_PER_TICK = 4096;
+static const int MESSAGES_PER_TICK = 64;
+
+#define CHUNK_STREAM_RADIUS 4
+
+static const char* MSG_NAMES[MSG_TYPE_COUNT] = {
+    [MSG_HELLO] = "hello",
+    [MSG_WELCOME] = "welcome",
+    [MSG_INPUT] = "input",
+    [MSG_SNAPSHOT] = "snapshot",
+    [MSG_MOBS] = "mobs",
+    [MSG_PING] = "ping",
+    [MSG_PONG] = "pong",
+    [MSG_CHUNK_DATA] = "chunk_data",
+    [MSG_TILE_EDITS] = "tile_edits",
+    [MSG_CHUNK_DROPPED] = "chunk_dropped",
+};
 
 static void ResetClient(ServerClient* c)
 {
@@ -30,11 +60,76 @@ static void ResetClient(ServerClient* c)
     c->lastInputSeq = 0;
 }
 
-static bool SendWelcome(ServerClient* c, uint8_t id, int seed)
+static void DropClient(ServerClient* c)
+{
+    c->connected = false;
+    Net_Close(&c->sock);
+}
+
+static bool QueueMessage(ServerState* s, ServerClient* c, const uint8_t* data, int len)
+{
+    if (!NetSendBuffer_Append(&c->send, data, len))
+    {
+        c->stats.droppedAppends++;
+        s->totals.droppedAppends++;
+        return false;
+    }
+
+    uint8_t type = data[2];
+    if (type < MSG_TYPE_COUNT)
+    {
+        c->stats.msgsSent[type]++;
+        s->totals.msgsSent[type]++;
+    }
+
+    int pending = c->send.len - c->send.offset;
+    if (pending > c->stats.sendHighWater)
+        c->stats.sendHighWater = pending;
+    if (pending > s->totals.sendHighWater)
+        s->totals.sendHighWater = pending;
+    return true;
+}
+
+static void FlushClient(ServerState* s, ServerClient* c)
+{
+    int pending = c->send.len - c->send.offset;
+    NetSendBuffer_Flush(&c->send, &c->sock);
+    int sent = pending - (c->send.len - c->send.offset);
+    c->stats.bytesSent += (uint64_t)sent;
+    s->totals.bytesSent += (uint64_t)sent;
+}
+
+static void SendPing(ServerState* s, ServerClient* c)
+{
+    // one ping in flight at a time, so a slow pong is timed against its own ping
+    if (c->pingSentTime > 0.0)
+        return;
+
+    uint8_t msg[3] = { 1, 0, (uint8_t)MSG_PING };
+    if (QueueMessage(s, c, msg, (int)sizeof(msg)))
+        c->pingSentTime = Net_GetTime();
+}
+
+static void HandlePong(ServerState* s, ServerClient* c)
+{
+    (void)s;
+    if (c->pingSentTime <= 0.0)
+        return;
+
+    float rtt = (float)((Net_GetTime() - c->pingSentTime) * 1000.0);
+    c->pingSentTime = 0.0;
+    c->stats.rttMs = c->stats.rttMs > 0.0f ? c->stats.rttMs * 0.875f + rtt * 0.125f : rtt;
+    if (rtt > c->stats.rttMaxMs)
+        c->stats.rttMaxMs = rtt;
+    if (rtt > c->rttWindowMaxMs)
+        c->rttWindowMaxMs = rtt;
+}
+
+static bool SendWelcome(ServerState* s, ServerClient* c, uint8_t id, int seed)
 {
     if (!c || !Net_IsValid(c->sock)) return false;
     uint8_t msg[32];
-    uint16_t payloadLen = 1 + 1 + 4;
+    uint16_t payloadLen = 1 + 1 + 4 + 4 + 4 * 3;
     uint16_t totalLen = (uint16_t)(1 + payloadLen);
     msg[0] = (uint8_t)(totalLen & 0xFF);
     msg[1] = (uint8_t)((totalLen >> 8) & 0xFF);
@@ -42,8 +137,20 @@ static bool SendWelcome(ServerClient* c, uint8_t id, int seed)
     msg[3] = id;
     msg[4] = NET_MAX_PLAYERS;
     memcpy(&msg[5], &seed, sizeof(int));
+    int version = NET_PROTOCOL_VERSION;
+    memcpy(&msg[9], &version, sizeof(int));
+
+    // generation parameters let clients reproduce untouched chunks locally
+    float amounts[3] = { 0.5f, 0.5f, 0.5f };
+    if (s->world)
+    {
+        amounts[0] = s->world->waterAmount;
+        amounts[1] = s->world->stoneAmount;
+        amounts[2] = s->world->caveAmount;
+    }
+    memcpy(&msg[13], amounts, sizeof(amounts));
 
-    return NetSendBuffer_Append(&c->send, msg, (int)(2 + totalLen));
+    return QueueMessage(s, c, msg, (int)(2 + totalLen));
 }
 
 static void SendSnapshot(ServerState* s, ServerClient* c)
@@ -86,12 +193,13 @@ static void SendSnapshot(ServerState* s, ServerClient* c)
     }
 
     buffer[countPos] = count;
+    memcpy(buffer + offset, &s->tickTimeMs, sizeof(float)); offset += sizeof(float);
 
     uint16_t totalLen = (uint16_t)(offset - 2);
     buffer[0] = (uint8_t)(totalLen & 0xFF);
     buffer[1] = (uint8_t)((totalLen >> 8) & 0xFF);
 
-    NetSendBuffer_Append(&c->send, buffer, offset);
+    QueueMessage(s, c, buffer, offset);
 }
 
 bool Server_Init(ServerState* s, uint16_t port, int seed)
@@ -121,6 +229,9 @@ bool Server_Init(ServerState* s, uint16_t port, int seed)
     s->cycleTimer = 0.0f;
     s->isNight = false;
     s->snapshotTimer = 0.0f;
+    s->tickTimeMs = 0.0f;
+    s->pingTimer = 0.0f;
+    s->rttWindowTimer = 0.0f;
     s->world = NULL;
     s->tileSize = 16.0f;
     s->playerRadius = 8.0f;
@@ -149,44 +260,327 @@ void Server_SetWorld(ServerState* s, ForgeWorld* world, float tileSize, float pl
     s->world = world;
     s->tileSize = tileSize;
     s->playerRadius = playerRadius;
+    if (world)
+        World_EnableEditLog(world, 1);
 }
 
-static void HandleClientMessage(ServerState* s, ServerClient* c, uint8_t type, const uint8_t* payload, int payloadLen)
+static long long SentChunkKey(int cx, int cy)
 {
-    (void)payloadLen;
-    if (!s || !c) return;
+    return (long long)(((unsigned long long)(unsigned int)cx << 32) | (unsigned int)cy);
+}
 
-    if (type == MSG_HELLO)
+static unsigned int SentChunkHash(long long key)
+{
+    return (unsigned int)(((unsigned long long)key * 2654435761ULL) % SERVER_SENT_CHUNK_CAPACITY);
+}
+
+static bool SentChunkFind(ServerClient* c, long long key, unsigned int* outIndex)
+{
+    unsigned int idx = SentChunkHash(key);
+    for (unsigned int n = 0; n < SERVER_SENT_CHUNK_CAPACITY; ++n)
     {
-        SendWelcome(c, c->id, s->seed);
+        unsigned int i = (idx + n) % SERVER_SENT_CHUNK_CAPACITY;
+        if (!c->sentChunkUsed[i])
+        {
+            if (outIndex) *outIndex = i;
+            return false;
+        }
+        if (c->sentChunks[i] == key)
+        {
+            if (outIndex) *outIndex = i;
+            return true;
+        }
     }
-    else if (type == MSG_INPUT)
+    return false;
+}
+
+static void SentChunkAdd(ServerClient* c, long long key)
+{
+    // clients keep every chunk they receive, so forgetting what was sent only costs a resend
+    if (c->sentChunkCount >= SERVER_SENT_CHUNK_CAPACITY * 3 / 4)
+    {
+        memset(c->sentChunkUsed, 0, sizeof(c->sentChunkUsed));
+        c->sentChunkCount = 0;
+    }
+
+    unsigned int i = 0;
+    if (SentChunkFind(c, key, &i))
+        return;
+    c->sentChunks[i] = key;
+    c->sentChunkUsed[i] = 1;
+    c->sentChunkCount++;
+}
+
+static void SentChunkRemove(ServerClient* c, long long key)
+{
+    unsigned int i = 0;
+    if (!SentChunkFind(c, key, &i))
+        return;
+
+    // re-insert the rest of the probe run so lookups past the hole still succeed
+    c->sentChunkUsed[i] = 0;
+    c->sentChunkCount--;
+    for (unsigned int n = 1; n < SERVER_SENT_CHUNK_CAPACITY; ++n)
     {
-        if (payload && payloadLen >= (int)(sizeof(float) * 4 + 1 + sizeof(uint16_t)))
+        unsigned int j = (i + n) % SERVER_SENT_CHUNK_CAPACITY;
+        if (!c->sentChunkUsed[j])
+            break;
+        long long moved = c->sentChunks[j];
+        c->sentChunkUsed[j] = 0;
+        c->sentChunkCount--;
+        SentChunkAdd(c, moved);
+    }
+}
+
+static int FloorDiv(int a, int b)
+{
+    return a < 0 ? (a - b + 1) / b : a / b;
+}
+
+typedef struct ChunkCandidate
+{
+    int cx, cy;
+    int dist;
+} ChunkCandidate;
+
+static void StreamChunks(ServerState* s, ServerClient* c, float dt)
+{
+    if (!s->world || c->isDead)
+        return;
+
+    c->chunkTokens += CHUNK_STREAM_RATE * dt;
+    if (c->chunkTokens > CHUNK_STREAM_BURST)
+        c->chunkTokens = CHUNK_STREAM_BURST;
+
+    c->chunkScanTimer += dt;
+    if (c->chunkScanTimer < CHUNK_SCAN_INTERVAL || c->chunkTokens <= 0.0f)
+        return;
+    c->chunkScanTimer = 0.0f;
+
+    int mode = s->world->isCave;
+    int pcx = FloorDiv((int)floorf(c->x / s->tileSize), CHUNK_SIZE);
+    int pcy = FloorDiv((int)floorf(c->y / s->tileSize), CHUNK_SIZE);
+
+    ChunkCandidate candidates[(2 * CHUNK_STREAM_RADIUS + 1) * (2 * CHUNK_STREAM_RADIUS + 1)];
+    int count = 0;
+    for (int dy = -CHUNK_STREAM_RADIUS; dy <= CHUNK_STREAM_RADIUS; ++dy)
+    {
+        for (int dx = -CHUNK_STREAM_RADIUS; dx <= CHUNK_STREAM_RADIUS; ++dx)
         {
-            int offset = 0;
-            memcpy(&c->input.seq, payload + offset, sizeof(uint16_t)); offset += sizeof(uint16_t);
-            memcpy(&c->input.moveX, payload + offset, sizeof(float)); offset += sizeof(float);
-            memcpy(&c->input.moveY, payload + offset, sizeof(float)); offset += sizeof(float);
-            c->input.attack = payload[offset++];
-            memcpy(&c->input.attackDirX, payload + offset, sizeof(float)); offset += sizeof(float);
-            memcpy(&c->input.attackDirY, payload + offset, sizeof(float)); offset += sizeof(float);
-            c->lastInputSeq = c->input.seq;
-
-            if (c->input.attack)
+            int cx = pcx + dx;
+            int cy = pcy + dy;
+            if (!World_IsChunkModified(s->world, cx, cy, mode))
+                continue;
+            if (SentChunkFind(c, SentChunkKey(cx, cy), NULL))
+                continue;
+
+            ChunkCandidate cand = { cx, cy, dx * dx + dy * dy };
+            int at = count++;
+            while (at > 0 && candidates[at - 1].dist > cand.dist)
             {
-                float dirLenSq = c->input.attackDirX * c->input.attackDirX + c->input.attackDirY * c->input.attackDirY;
-                if (dirLenSq > 0.0001f)
-                {
-                    float inv = 1.0f / sqrtf(dirLenSq);
-                    c->attackDirX = c->input.attackDirX * inv;
-                    c->attackDirY = c->input.attackDirY * inv;
-                    c->attackBaseAngle = atan2f(c->attackDirY, c->attackDirX);
-                    c->attackBuffered = true;
-                }
+                candidates[at] = candidates[at - 1];
+                at--;
             }
+            candidates[at] = cand;
         }
     }
+
+    uint8_t tiles[CHUNK_SIZE * CHUNK_SIZE];
+    uint8_t frame[NET_MAX_MESSAGE];
+    for (int i = 0; i < count && c->chunkTokens > 0.0f; ++i)
+    {
+        int space = NET_BUFFER_SIZE - c->send.len;
+        if (space < NET_MAX_MESSAGE)
+            break;
+
+        if (!World_GetChunkTiles(s->world, candidates[i].cx, candidates[i].cy, mode, tiles))
+            continue;
+        int len = Net_WriteChunkData(frame, (int)sizeof(frame), candidates[i].cx, candidates[i].cy, mode, tiles);
+        if (len <= 0 || !QueueMessage(s, c, frame, len))
+            break;
+
+        c->chunkTokens -= (float)len;
+        SentChunkAdd(c, SentChunkKey(candidates[i].cx, candidates[i].cy));
+    }
+}
+
+static void HandleTileEdits(ServerState* s, ServerClient* c, const uint8_t* payload, int payloadLen)
+{
+    if (!s->world || c->isDead)
+        return;
+
+    TileEdit edits[NET_MAX_EDITS_PER_MESSAGE];
+    int count = Net_ReadTileEdits(payload, payloadLen, edits, NET_MAX_EDITS_PER_MESSAGE);
+    float px = c->x / s->tileSize;
+    float py = c->y / s->tileSize;
+    for (int i = 0; i < count; ++i)
+    {
+        TileEdit* e = &edits[i];
+        if (e->mode != (unsigned char)s->world->isCave)
+            continue;
+        float dx = (float)e->x + 0.5f - px;
+        float dy = (float)e->y + 0.5f - py;
+        if (dx * dx + dy * dy > EDIT_REACH_TILES * EDIT_REACH_TILES)
+            continue;
+        World_ApplyEdit(s->world, e, 1);
+    }
+}
+
+static void BroadcastEdits(ServerState* s)
+{
+    if (!s->world)
+        return;
+
+    TileEdit edits[NET_MAX_EDITS_PER_MESSAGE];
+    uint8_t frame[NET_MAX_MESSAGE];
+    int count;
+    while ((count = World_PopEdits(s->world, edits, NET_MAX_EDITS_PER_MESSAGE)) > 0)
+    {
+        int len = Net_WriteTileEdits(frame, (int)sizeof(frame), edits, count);
+        for (int i = 0; i < NET_MAX_PLAYERS; ++i)
+        {
+            ServerClient* c = &s->clients[i];
+            if (!c->connected || !Net_IsValid(c->sock))
+                continue;
+            if (QueueMessage(s, c, frame, len))
+                continue;
+
+            // the client missed these edits; forget its copies so streaming resends the chunks
+            for (int e = 0; e < count; ++e)
+                SentChunkRemove(c, SentChunkKey(FloorDiv(edits[e].x, CHUNK_SIZE), FloorDiv(edits[e].y, CHUNK_SIZE)));
+        }
+    }
+}
+
+// only the newest input is simulated; an attack anywhere in the tick still counts
+static void MergePendingAttack(ServerClient* c, const NetInputState* in)
+{
+    if (!in->attack)
+        return;
+
+    float dirLenSq = in->attackDirX * in->attackDirX + in->attackDirY * in->attackDirY;
+    if (dirLenSq > 0.0001f)
+    {
+        float inv = 1.0f / sqrtf(dirLenSq);
+        c->pendingAttack = true;
+        c->pendingAttackDirX = in->attackDirX * inv;
+        c->pendingAttackDirY = in->attackDirY * inv;
+    }
+}
+
+static void HandleInput(ServerState* s, ServerClient* c, const uint8_t* payload, int payloadLen)
+{
+    if (!payload || payloadLen < (int)(sizeof(float) * 4 + 1 + sizeof(uint16_t)))
+        return;
+
+    NetInputState in;
+    int offset = 0;
+    memcpy(&in.seq, payload + offset, sizeof(uint16_t)); offset += sizeof(uint16_t);
+    memcpy(&in.moveX, payload + offset, sizeof(float)); offset += sizeof(float);
+    memcpy(&in.moveY, payload + offset, sizeof(float)); offset += sizeof(float);
+    in.attack = payload[offset++];
+    memcpy(&in.attackDirX, payload + offset, sizeof(float)); offset += sizeof(float);
+    memcpy(&in.attackDirY, payload + offset, sizeof(float)); offset += sizeof(float);
+
+    if (!isfinite(in.moveX) || !isfinite(in.moveY) || !isfinite(in.attackDirX) || !isfinite(in.attackDirY))
+    {
+        c->stats.inputsInvalid++;
+        s->totals.inputsInvalid++;
+        return;
+    }
+
+    // checked before anything else touches pending state, so a replayed packet
+    // cannot slip an attack in through the rate-limited path
+    if (c->hasInputSeq && !Net_SeqNewer(in.seq, c->newestInputSeq))
+    {
+        c->stats.inputsStale++;
+        s->totals.inputsStale++;
+        return;
+    }
+    c->newestInputSeq = in.seq;
+    c->hasInputSeq = true;
+
+    // a dropped input still delivers its attack, or a click could be lost entirely
+    if (c->inputTokens < 1.0f)
+    {
+        c->stats.inputsRateLimited++;
+        s->totals.inputsRateLimited++;
+        MergePendingAttack(c, &in);
+        return;
+    }
+    c->inputTokens -= 1.0f;
+
+    in.moveX = fmaxf(-1.0f, fminf(1.0f, in.moveX));
+    in.moveY = fmaxf(-1.0f, fminf(1.0f, in.moveY));
+
+    MergePendingAttack(c, &in);
+    c->pendingInput = in;
+    c->inputPending = true;
+}
+
+static void ApplyPendingInput(ServerClient* c)
+{
+    if (c->inputPending)
+    {
+        c->input = c->pendingInput;
+        c->lastInputSeq = c->input.seq;
+        c->hasInput = true;
+        c->inputPending = false;
+    }
+
+    // may come from a rate-limited input with nothing else pending this tick
+    if (c->pendingAttack)
+    {
+        c->attackDirX = c->pendingAttackDirX;
+        c->attackDirY = c->pendingAttackDirY;
+        c->attackBaseAngle = atan2f(c->attackDirY, c->attackDirX);
+        c->attackBuffered = true;
+        c->pendingAttack = false;
+    }
+}
+
+void Server_HandleClientMessage(ServerState* s, ServerClient* c, uint8_t type, const uint8_t* payload, int payloadLen)
+{
+    (void)payloadLen;
+    if (!s || !c) return;
+
+    if (type < MSG_TYPE_COUNT)
+    {
+        c->stats.msgsReceived[type]++;
+        s->totals.msgsReceived[type]++;
+    }
+
+    if (type == MSG_HELLO)
+    {
+        int version = 0;
+        if (payload && payloadLen >= (int)sizeof(int))
+            memcpy(&version, payload, sizeof(int));
+        c->send.bundle = version >= NET_BUNDLE_MIN_VERSION;
+        SendWelcome(s, c, c->id, s->seed);
+    }
+    else if (type == MSG_PING)
+    {
+        uint8_t pong[3] = { 1, 0, (uint8_t)MSG_PONG };
+        QueueMessage(s, c, pong, (int)sizeof(pong));
+    }
+    else if (type == MSG_PONG)
+    {
+        HandlePong(s, c);
+    }
+    else if (type == MSG_TILE_EDITS)
+    {
+        HandleTileEdits(s, c, payload, payloadLen);
+    }
+    else if (type == MSG_INPUT)
+    {
+        HandleInput(s, c, payload, payloadLen);
+    }
+    else if (type == MSG_CHUNK_DROPPED)
+    {
+        int cx, cy, mode;
+        if (s->world && Net_ReadChunkDropped(payload, payloadLen, &cx, &cy, &mode) && mode == s->world->isCave)
+            SentChunkRemove(c, SentChunkKey(cx, cy));
+    }
 }
 
 static void UpdatePlayer(ServerState* s, ServerClient* p, float dt)
@@ -283,8 +677,13 @@ void Server_Update(ServerState* s, float dt)
         c->connected = true;
         c->id = (uint8_t)slot;
         c->sock = client;
+        c->inputTokens = INPUT_BURST;
+        c->connectTime = Net_GetTime();
+        s->totalConnections++;
         Net_SetNonBlocking(&c->sock, true);
-        SendWelcome(c, c->id, s->seed);
+        Net_SetNoDelay(&c->sock, true);
+        Net_SetSendBufferSize(&c->sock, SOCKET_SEND_BUFFER);
+        SendWelcome(s, c, c->id, s->seed);
     }
 
     uint8_t temp[512];
@@ -294,42 +693,61 @@ void Server_Update(ServerState* s, float dt)
         if (!c->connected || !Net_IsValid(c->sock))
             continue;
 
-        for (;;)
+        c->inputTokens += INPUT_RATE_LIMIT * dt;
+        if (c->inputTokens > INPUT_BURST)
+            c->inputTokens = INPUT_BURST;
+
+        // bounded reads: whatever is left stays in the socket and applies TCP backpressure
+        int budget = RECV_BYTES_PER_TICK;
+        while (budget > 0)
         {
-            int r = Net_Recv(&c->sock, temp, (int)sizeof(temp));
+            int want = NET_BUFFER_SIZE - c->recv.len;
+            if (want > (int)sizeof(temp)) want = (int)sizeof(temp);
+            if (want > budget) want = budget;
+            if (want <= 0)
+                break;
+
+            int r = Net_Recv(&c->sock, temp, want);
             if (r > 0)
             {
-                if (!NetRecvBuffer_Push(&c->recv, temp, r))
-                {
-                    c->connected = false;
-                    Net_Close(&c->sock);
-                    break;
-                }
-
-                uint8_t type;
-                uint8_t payload[NET_MAX_MESSAGE];
-                int payloadLen;
-                while (NetRecvBuffer_PopMessage(&c->recv, &type, payload, &payloadLen))
-                {
-                    HandleClientMessage(s, c, type, payload, payloadLen);
-                }
+                c->stats.bytesReceived += (uint64_t)r;
+                s->totals.bytesReceived += (uint64_t)r;
+                NetRecvBuffer_Push(&c->recv, temp, r);
+                budget -= r;
             }
             else if (r == 0)
             {
-                c->connected = false;
-                Net_Close(&c->sock);
+                DropClient(c);
                 break;
             }
             else
             {
                 if (!Net_WouldBlock())
-                {
-                    c->connected = false;
-                    Net_Close(&c->sock);
-                }
+                    DropClient(c);
                 break;
             }
         }
+
+        if (!c->connected)
+            continue;
+
+        uint8_t type;
+        uint8_t payload[NET_MAX_MESSAGE];
+        int payloadLen;
+        int handled = 0;
+        while (handled < MESSAGES_PER_TICK && NetRecvBuffer_PopMessage(&c->recv, &type, payload, &payloadLen))
+        {
+            Server_HandleClientMessage(s, c, type, payload, payloadLen);
+            handled++;
+        }
+
+        if (c->recv.error)
+        {
+            DropClient(c);
+            continue;
+        }
+
+        ApplyPendingInput(c);
     }
 
     s->cycleTimer += dt;
@@ -384,7 +802,7 @@ void Server_Update(ServerState* s, float dt)
     }
 
     s->snapshotTimer += dt;
-    if (s->snapshotTimer >= 0.033f)
+    if (s->snapshotTimer >= NET_SNAPSHOT_INTERVAL)
     {
         s->snapshotTimer = 0.0f;
         for (int i = 0; i < NET_MAX_PLAYERS; ++i)
@@ -396,11 +814,47 @@ void Server_Update(ServerState* s, float dt)
         }
     }
 
+    BroadcastEdits(s);
+    for (int i = 0; i < NET_MAX_PLAYERS; ++i)
+    {
+        ServerClient* c = &s->clients[i];
+        if (c->connected && Net_IsValid(c->sock))
+            StreamChunks(s, c, dt);
+    }
+
+    s->pingTimer += dt;
+    if (s->pingTimer >= PING_INTERVAL)
+    {
+        s->pingTimer = 0.0f;
+        for (int i = 0; i < NET_MAX_PLAYERS; ++i)
+        {
+            ServerClient* c = &s->clients[i];
+            if (c->connected && Net_IsValid(c->sock))
+                SendPing(s, c);
+        }
+    }
+
+    s->rttWindowTimer += dt;
+    if (s->rttWindowTimer >= RTT_MAX_WINDOW)
+    {
+        s->rttWindowTimer = 0.0f;
+        for (int i = 0; i < NET_MAX_PLAYERS; ++i)
+        {
+            ServerClient* c = &s->clients[i];
+            c->stats.rttMaxMs = c->rttWindowMaxMs;
+            c->rttWindowMaxMs = 0.0f;
+        }
+    }
+}
+
+void Server_Flush(ServerState* s)
+{
+    if (!s || !s->running) return;
     for (int i = 0; i < NET_MAX_PLAYERS; ++i)
     {
         ServerClient* c = &s->clients[i];
         if (c->connected && Net_IsValid(c->sock))
-            NetSendBuffer_Flush(&c->send, &c->sock);
+            FlushClient(s, c);
     }
 }
 
@@ -441,6 +895,96 @@ void Server_Broadcast(ServerState* s, const uint8_t* data, int len)
         ServerClient* c = &s->clients[i];
         if (!c->connected || !Net_IsValid(c->sock))
             continue;
-        NetSendBuffer_Append(&c->send, data, len);
+        QueueMessage(s, c, data, len);
+    }
+}
+
+static void Appendf(char* out, int outSize, int* len, const char* fmt, ...)
+{
+    if (*len >= outSize) return;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(out + *len, (size_t)(outSize - *len), fmt, args);
+    va_end(args);
+    if (n > 0)
+        *len = (*len + n < outSize) ? *len + n : outSize - 1;
+}
+
+static void AppendMsgCountsJson(char* out, int outSize, int* len, const uint32_t* counts)
+{
+    Appendf(out, outSize, len, "{");
+    bool first = true;
+    for (int t = 0; t < MSG_TYPE_COUNT; ++t)
+    {
+        if (!MSG_NAMES[t]) continue;
+        Appendf(out, outSize, len, "%s\"%s\":%u", first ? "" : ",", MSG_NAMES[t], counts[t]);
+        first = false;
+    }
+    Appendf(out, outSize, len, "}");
+}
+
+static void AppendStatsJson(char* out, int outSize, int* len, const NetStats* st)
+{
+    Appendf(out, outSize, len,
+        "\"bytesSent\":%llu,\"bytesReceived\":%llu,\"droppedAppends\":%u,\"sendHighWater\":%d,",
+        (unsigned long long)st->bytesSent, (unsigned long long)st->bytesReceived,
+        st->droppedAppends, st->sendHighWater);
+    Appendf(out, outSize, len,
+        "\"inputsRateLimited\":%u,\"inputsStale\":%u,\"inputsInvalid\":%u,",
+        st->inputsRateLimited, st->inputsStale, st->inputsInvalid);
+    Appendf(out, outSize, len, "\"msgsSent\":");
+    AppendMsgCountsJson(out, outSize, len, st->msgsSent);
+    Appendf(out, outSize, len, ",\"msgsReceived\":");
+    AppendMsgCountsJson(out, outSize, len, st->msgsReceived);
+}
+
+int Server_FormatStats(ServerState* s, char* out, int outSize, bool json)
+{
+    if (!s || !out || outSize <= 0) return 0;
+    out[0] = '\0';
+    int len = 0;
+    double now = Net_GetTime();
+
+    int connected = 0;
+    for (int i = 0; i < NET_MAX_PLAYERS; ++i)
+        if (s->clients[i].connected) connected++;
+
+    if (json)
+    {
+        Appendf(out, outSize, &len, "{\"tickMs\":%.3f,\"connected\":%d,\"totalConnections\":%u,\"clients\":[",
+            s->tickTimeMs, connected, s->totalConnections);
+        bool first = true;
+        for (int i = 0; i < NET_MAX_PLAYERS; ++i)
+        {
+            ServerClient* c = &s->clients[i];
+            if (!c->connected) continue;
+            Appendf(out, outSize, &len, "%s{\"id\":%u,\"uptime\":%.1f,\"rttMs\":%.2f,\"rttMaxMs\":%.2f,",
+                first ? "" : ",", c->id, now - c->connectTime, c->stats.rttMs, c->stats.rttMaxMs);
+            AppendStatsJson(out, outSize, &len, &c->stats);
+            Appendf(out, outSize, &len, "}");
+            first = false;
+        }
+        Appendf(out, outSize, &len, "],\"totals\":{");
+        AppendStatsJson(out, outSize, &len, &s->totals);
+        Appendf(out, outSize, &len, "}}\n");
+        return len;
+    }
+
+    Appendf(out, outSize, &len, "tick %.2fms clients %d tx %llu rx %llu drops %u hw %d",
+        s->tickTimeMs, connected,
+        (unsigned long long)s->totals.bytesSent, (unsigned long long)s->totals.bytesReceived,
+        s->totals.droppedAppends, s->totals.sendHighWater);
+    for (int i = 0; i < NET_MAX_PLAYERS; ++i)
+    {
+        ServerClient* c = &s->clients[i];
+        if (!c->connected) continue;
+        double up = now - c->connectTime;
+        if (up < 0.001) up = 0.001;
+        Appendf(out, outSize, &len, " | #%u rtt %.1fms tx %.0fB/s rx %.0fB/s hw %d drops %u rejected %u",
+            c->id, c->stats.rttMs,
+            (double)c->stats.bytesSent / up, (double)c->stats.bytesReceived / up,
+            c->stats.sendHighWater, c->stats.droppedAppends,
+            c->stats.inputsRateLimited + c->stats.inputsStale + c->stats.inputsInvalid);
     }
+    return len;
 }
@@ -12,6 +12,23 @@ extern "C"
 {
 #endif
 
+#define SERVER_SENT_CHUNK_CAPACITY 1024
+
+typedef struct NetStats
+{
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+    uint32_t msgsSent[MSG_TYPE_COUNT];
+    uint32_t msgsReceived[MSG_TYPE_COUNT];
+    uint32_t droppedAppends;
+    int sendHighWater;
+    float rttMs;
+    float rttMaxMs;
+    uint32_t inputsRateLimited;
+    uint32_t inputsStale;
+    uint32_t inputsInvalid;
+} NetStats;
+
 typedef struct ServerClient
 {
     bool connected;
@@ -36,6 +53,27 @@ typedef struct ServerClient
     bool attackQueued;
     bool attackBuffered;
     uint16_t lastInputSeq;
+    bool hasInput;
+    uint16_t newestInputSeq;    // newest seq seen, accepted or rate-limited; older ones are replays
+    bool hasInputSeq;
+
+    NetInputState pendingInput;
+    bool inputPending;
+    bool pendingAttack;
+    float pendingAttackDirX;
+    float pendingAttackDirY;
+    float inputTokens;
+
+    NetStats stats;
+    double connectTime;
+    double pingSentTime;   // 0 when no ping is outstanding
+    float rttWindowMaxMs;
+
+    long long sentChunks[SERVER_SENT_CHUNK_CAPACITY];
+    uint8_t sentChunkUsed[SERVER_SENT_CHUNK_CAPACITY];
+    int sentChunkCount;
+    float chunkTokens;
+    float chunkScanTimer;
 } ServerClient;
 
 typedef struct ServerState
@@ -48,6 +86,12 @@ typedef struct ServerState
     bool isNight;
 
     float snapshotTimer;
+    float tickTimeMs;
+    float pingTimer;
+    float rttWindowTimer;
+
+    NetStats totals;
+    uint32_t totalConnections;
 
     NetSocket listenSock;
     ServerClient clients[NET_MAX_PLAYERS];
@@ -61,8 +105,12 @@ bool Server_Init(ServerState* s, uint16_t port, int seed);
 void Server_Shutdown(ServerState* s);
 void Server_SetWorld(ServerState* s, ForgeWorld* world, float tileSize, float playerRadius);
 void Server_Update(ServerState* s, float dt);
+void Server_Flush(ServerState* s);
+// what Server_Update does with each message read from a client's socket
+void Server_HandleClientMessage(ServerState* s, ServerClient* c, uint8_t type, const uint8_t* payload, int payloadLen);
 int  Server_GetSnapshot(ServerState* s, NetPlayerState* outPlayers, int maxPlayers, bool* outIsNight, float* outCycleTimer);
 void Server_Broadcast(ServerState* s, const uint8_t* data, int len);
+int  Server_FormatStats(ServerState* s, char* out, int outSize, bool json);
 
 #ifdef __cplusplus
 }
@@ -2,7 +2,7 @@
 #include <math.h>
 
 Player::Player(Vec2 position)
-    : position(position), speed(200.0f), size(16.0f)
+    : position(position), previousPosition(position), speed(200.0f), size(16.0f)
 {
 }
 
@@ -45,14 +45,30 @@ void Player::Update(float dt, Vec2 move, ForgeWorld* world, float tileSize)
     }
 }
 
+Vec2 Player::GetRenderPosition(float alpha) const
+{
+    return Vec2{
+        previousPosition.x + (position.x - previousPosition.x) * alpha,
+        previousPosition.y + (position.y - previousPosition.y) * alpha
+    };
+}
+
 void Player::Draw() const
 {
-    Renderer_DrawRectangle(
-        Rect{ position.x - size / 2.0f, position.y - size / 2.0f, size, size },
-        color
-    );
+    QuadInstance body = GetBodyInstance();
+    Renderer_DrawQuadsInstanced(&body, 1, 0);
+    DrawWeapon();
+}
+
+QuadInstance Player::GetBodyInstance(float alpha) const
+{
+    Vec2 p = GetRenderPosition(alpha);
+    return QuadInstance{ p.x, p.y, size, size, 0.0f, 0.0f, color };
+}
 
-    if (isAttacking && weaponSprite)
+void Player::DrawWeapon(float alpha) const
+{
+    if (isAttacking && weaponSprite && weaponSprite->width > 0)
     {
         float t = attackProgress;
         t = t * t * (3.0f - 2.0f * t);
@@ -66,8 +82,9 @@ void Player::Draw() const
         float scale = targetLength / maxDim;
         Rect src = { 0, 0, drawW, drawH };
         float reach = size * 0.55f;
-        float sx = position.x + attackDir.x * reach;
-        float sy = position.y + attackDir.y * reach;
+        Vec2 p = GetRenderPosition(alpha);
+        float sx = p.x + attackDir.x * reach;
+        float sy = p.y + attackDir.y * reach;
         Rect dst = { sx, sy, drawW * scale, drawH * scale };
         Vec2 origin = { (drawW * scale) * 0.15f, (drawH * scale) * 0.5f };
 
@@ -10,7 +10,12 @@ public:
     Player(float x, float y) : Player(Vec2{ x, y }) {}
 
     void Update(float dt, Vec2 move, ForgeWorld* world, float tileSize);
+    // alpha blends from the state before the last simulation step to the current one
+    void BeginStep() { previousPosition = position; }
+    Vec2 GetRenderPosition(float alpha) const;
     void Draw() const;
+    QuadInstance GetBodyInstance(float alpha = 1.0f) const;
+    void DrawWeapon(float alpha = 1.0f) const;
     void DrawHP() const;
     void DrawStamina() const;
     bool Attack(Vec2 dir);
@@ -41,6 +46,7 @@ public:
 
 private:
     Vec2 position;
+    Vec2 previousPosition;
     float speed;
     float size;
 
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include "engine/forge.h"
+#include "inventory.h"
+#include "world.h"
+
+// Headless rendering benchmark: replays fixed scenes into an offscreen GL
+// context and reports per-frame CPU time, GPU time, draw calls and upload bytes.
+//
+//   forge_render_bench [frames] [width] [height]
+//
+// Without a display SDL's offscreen driver is selected (EGL pbuffer); set
+// LIBGL_ALWAYS_SOFTWARE=1 to run on Mesa llvmpipe.
+
+static const int BENCH_SEED = 12345;
+static const int BENCH_MOBS = 1000;
+static const int BENCH_WARMUP_FRAMES = 30;
+static const int BENCH_DEFAULT_FRAMES = 300;
+
+struct BenchScene
+{
+    const char* name;
+    std::function<void()> draw;
+};
+
+struct BenchResult
+{
+    double cpuAvg;
+    double cpuP95;
+    double gpuAvg;
+    int gpuFrames;
+    double drawCalls;
+    double uploadBytes;
+};
+
+// cpu/gpu are milliseconds; the sample of the previous frame is read once its
+// GPU queries resolve at the next Profiler_BeginFrame
+static BenchResult RunScene(Renderer* renderer, const BenchScene& scene, int frames)
+{
+    std::vector<double> cpu;
+    cpu.reserve((size_t)frames);
+    double gpuTotal = 0.0;
+    int gpuFrames = 0;
+    long long drawCalls = 0;
+    long long uploadBytes = 0;
+
+    for (int i = 0; i < BENCH_WARMUP_FRAMES + frames + 1; ++i)
+    {
+        Profiler_BeginFrame();
+        const ProfilerFrame* prev = Profiler_GetFrame(0);
+        if (i > BENCH_WARMUP_FRAMES && prev && prev->gpu_resolved && prev->gpu_count > 0)
+        {
+            gpuTotal += prev->gpu[0].duration * 1000.0;
+            gpuFrames++;
+        }
+        if (i == BENCH_WARMUP_FRAMES + frames)
+            break;
+
+        double start = GetTime();
+        Renderer_BeginFrame(renderer);
+        Renderer_Clear(Color{0.0f, 0.0f, 0.0f, 1.0f});
+        Profiler_BeginGpuScope(scene.name);
+        scene.draw();
+        Profiler_EndGpuScope();
+        Renderer_Flush();
+        double submit = GetTime() - start;
+
+        Renderer_EndFrame(renderer);
+        // keeps frames from queueing up behind each other, so every query is
+        // ready by the next frame and GPU time is not smeared across frames
+        glFinish();
+
+        if (i >= BENCH_WARMUP_FRAMES)
+        {
+            cpu.push_back(submit * 1000.0);
+            drawCalls += Renderer_GetFrameDrawCalls();
+            uploadBytes += (long long)Renderer_GetFrameUploadBytes();
+        }
+    }
+
+    BenchResult result = {};
+    double total = 0.0;
+    for (double ms : cpu)
+        total += ms;
+    result.cpuAvg = total / (double)frames;
+    std::sort(cpu.begin(), cpu.end());
+    result.cpuP95 = cpu[std::min((size_t)frames - 1, (size_t)((double)frames * 0.95))];
+    result.gpuAvg = gpuFrames > 0 ? gpuTotal / (double)gpuFrames : 0.0;
+    result.gpuFrames = gpuFrames;
+    result.drawCalls = (double)drawCalls / (double)frames;
+    result.uploadBytes = (double)uploadBytes / (double)frames;
+    return result;
+}
+
+static Camera2D CenteredCamera(float x, float y, float zoom, int width, int height)
+{
+    return Camera2D{ x - (float)width * 0.5f / zoom, y - (float)height * 0.5f / zoom, zoom };
+}
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_FRAMES;
+    int width = argc > 2 ? atoi(argv[2]) : 1280;
+    int height = argc > 3 ? atoi(argv[3]) : 720;
+    if (frames <= 0)
+        frames = BENCH_DEFAULT_FRAMES;
+    if (width <= 0 || height <= 0)
+    {
+        width = 1280;
+        height = 720;
+    }
+
+    if (!getenv("SDL_VIDEODRIVER") && !getenv("DISPLAY") && !getenv("WAYLAND_DISPLAY"))
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+
+    Forge_Init();
+    Window* window = Window_CreateOffscreen(width, height);
+    if (!window)
+    {
+        Forge_Shutdown();
+        return 1;
+    }
+    Renderer* renderer = Renderer_Create(window);
+    SetGlobalRenderer(renderer);
+    Window_SetSwapInterval(window, 0);
+
+    Profiler_Init();
+    Profiler_SetGpuEnabled(1);
+
+    World* world = new World(WORLD_LOAD_RADIUS_CHUNKS, BENCH_SEED);
+    World* mobWorld = new World(WORLD_LOAD_RADIUS_CHUNKS, BENCH_SEED);
+
+    // mobs are scattered over the zoom 1 view with a fixed LCG and left in place
+    World_SetMobCapacity(mobWorld->GetRaw(), BENCH_MOBS);
+    unsigned int rng = 1u;
+    for (int i = 0; i < BENCH_MOBS; ++i)
+    {
+        rng = rng * 1664525u + 1013904223u;
+        float x = ((float)(rng >> 8) / 16777216.0f - 0.5f) * (float)width;
+        rng = rng * 1664525u + 1013904223u;
+        float y = ((float)(rng >> 8) / 16777216.0f - 0.5f) * (float)height;
+        World_SpawnMob(mobWorld->GetRaw(), 0, x, y);
+    }
+
+    Inventory inventory;
+    Texture2D* itemSprite = LoadTexture("assets/test.png");
+    inventory.AddItem("sword", Color{1, 1, 1, 1}, itemSprite, ITEM_WEAPON);
+    inventory.AddItem("misc", Color{1, 0, 0, 1}, itemSprite, ITEM_MISC);
+    inventory.AddItem("Stone", Color{0.5f, 0.5f, 0.5f, 1.0f}, nullptr, ITEM_BLOCK, TILE_STONE, 99);
+    inventory.AddItem("Dirt", Color{0.6f, 0.4f, 0.2f, 1.0f}, nullptr, ITEM_BLOCK, TILE_DIRT, 64);
+    inventory.AddItem("Sand", Color{0.9f, 0.8f, 0.4f, 1.0f}, nullptr, ITEM_BLOCK, TILE_SAND, 50);
+
+    std::vector<BenchScene> scenes;
+    static const float ZOOMS[] = { 1.0f, 0.5f, 0.25f, 0.1f };
+    static const char* ZOOM_NAMES[] = { "tiles zoom 1.0", "tiles zoom 0.5", "tiles zoom 0.25", "tiles zoom 0.1" };
+    for (int z = 0; z < 4; ++z)
+    {
+        Camera2D camera = CenteredCamera(0.0f, 0.0f, ZOOMS[z], width, height);
+        scenes.push_back({ ZOOM_NAMES[z], [=]() { world->Draw(camera, width, height, false); } });
+    }
+    scenes.push_back({ "1000 mobs", [=]()
+    {
+        mobWorld->Draw(CenteredCamera(0.0f, 0.0f, 1.0f, width, height), width, height, true);
+    } });
+    scenes.push_back({ "text", [=]()
+    {
+        char line[128];
+        for (int row = 0; row * 18 < height; ++row)
+        {
+            snprintf(line, sizeof(line), "%03d The quick brown fox jumps over the lazy dog 0123456789 !?%%&", row);
+            Renderer_DrawTextEx(line, 8.0f, (float)(row * 18), 16.0f, Color{1.0f, 1.0f, 1.0f, 1.0f},
+                (TextStyle)(row % 4));
+        }
+    } });
+    scenes.push_back({ "inventory", [&]()
+    {
+        inventory.Draw(10.0f, (float)height - 50.0f, 32.0f);
+    } });
+
+    printf("%-16s %9s %9s %9s %8s %10s\n", "scene", "cpu ms", "cpu p95", "gpu ms", "draws", "upload KB");
+    for (const BenchScene& scene : scenes)
+    {
+        BenchResult r = RunScene(renderer, scene, frames);
+        char gpu[32];
+        if (r.gpuFrames > 0)
+            snprintf(gpu, sizeof(gpu), "%9.3f", r.gpuAvg);
+        else
+            snprintf(gpu, sizeof(gpu), "%9s", "n/a");
+        printf("%-16s %9.3f %9.3f %s %8.1f %10.1f\n", scene.name, r.cpuAvg, r.cpuP95, gpu, r.drawCalls, r.uploadBytes / 1024.0);
+        fflush(stdout);
+    }
+
+    delete mobWorld;
+    delete world;
+    UnloadTexture(itemSprite);
+    Profiler_Shutdown();
+
+    Window_Destroy(window);
+    Renderer_Destroy(renderer);
+    Forge_Shutdown();
+    return 0;
+}
@@ -2,23 +2,59 @@
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 #include "world.h"
 #include "net/server.h"
+#include "engine/forgesystem.h"
 
 static const int WORLD_SEED = 12345;
 static const float PLAYER_RADIUS = 16.0f * 0.45f;
 static const float PLAYER_ATTACK_RANGE = 55.0f;
 static const float PLAYER_ATTACK_ARC_COS = 0.35f;
 static const float PLAYER_ATTACK_DAMAGE = 12.0f;
+static const float STATS_FILE_INTERVAL = 1.0f;
+static const float STATS_LOG_INTERVAL = 10.0f;
+
+static void WriteStatsFile(ServerState* server, const std::string& path)
+{
+    static char buffer[16384];
+    int len = Server_FormatStats(server, buffer, (int)sizeof(buffer), true);
+
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f)
+        return;
+    fwrite(buffer, 1, (size_t)len, f);
+    fclose(f);
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+    rename(tmp.c_str(), path.c_str());
+}
 
 int main(int argc, char** argv)
 {
+    // EternalNight-srv [port] [--load] [--stats <path>]
+    bool loadSave = false;
+    std::string statsPath;
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--load") == 0)
+            loadSave = true;
+        else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+            statsPath = argv[++i];
+        else
+            args.push_back(argv[i]);
+    }
+
     uint16_t port = 7777;
-    if (argc > 1)
+    if (args.size() > 0)
     {
-        int p = atoi(argv[1]);
+        int p = atoi(args[0]);
         if (p > 0 && p <= 65535) port = (uint16_t)p;
     }
 
@@ -27,9 +63,26 @@ int main(int argc, char** argv)
         return 1;
 
     World world(WORLD_LOAD_RADIUS_CHUNKS, WORLD_SEED);
+    if (loadSave)
+    {
+        GameSaveState saved = {};
+        if (Storage_LoadGame(world.GetRaw(), &saved))
+        {
+            World_SetCaveMode(world.GetRaw(), 0);
+            World_DetectModifiedChunks(world.GetRaw());
+            server.seed = world.GetRaw()->seed;
+            dbg_msg("server", "Serving saved world (seed %d)", server.seed);
+        }
+        else
+        {
+            dbg_msg("server", "No save could be loaded, generating seed %d", WORLD_SEED);
+        }
+    }
     Server_SetWorld(&server, world.GetRaw(), world.GetTileSize(), PLAYER_RADIUS);
 
     float mobSyncTimer = 0.0f;
+    float statsFileTimer = 0.0f;
+    float statsLogTimer = 0.0f;
     auto last = std::chrono::steady_clock::now();
 
     while (server.running)
@@ -38,6 +91,7 @@ int main(int argc, char** argv)
         std::chrono::duration<float> elapsed = now - last;
         last = now;
         float dt = std::clamp(elapsed.count(), 0.0f, 0.1f);
+        auto tickStart = std::chrono::steady_clock::now();
 
         Server_Update(&server, dt);
 
@@ -120,6 +174,27 @@ int main(int argc, char** argv)
             }
         }
 
+        Server_Flush(&server);
+
+        std::chrono::duration<float, std::milli> tickTime = std::chrono::steady_clock::now() - tickStart;
+        server.tickTimeMs = tickTime.count();
+
+        statsFileTimer += dt;
+        if (!statsPath.empty() && statsFileTimer >= STATS_FILE_INTERVAL)
+        {
+            statsFileTimer = 0.0f;
+            WriteStatsFile(&server, statsPath);
+        }
+
+        statsLogTimer += dt;
+        if (statsLogTimer >= STATS_LOG_INTERVAL)
+        {
+            statsLogTimer = 0.0f;
+            char line[2048];
+            Server_FormatStats(&server, line, (int)sizeof(line), false);
+            dbg_msg("server", "%s", line);
+        }
+
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
@@ -7,7 +7,7 @@
 #include <algorithm>
 
 MainMenu::MainMenu()
-    : gameState(STATE_MENU), buttonTexture(nullptr), sliderTexture(nullptr),
+    : gameState(STATE_MENU), atlas(nullptr), buttonTexture(nullptr), sliderTexture(nullptr),
       backPressed(false), sliderWidth(200), draggingSlider(-1), background(nullptr)
 {
     config.seed = 12345;
@@ -26,11 +26,15 @@ MainMenu::~MainMenu()
 {
     if (buttonTexture) 
     {
-        UnloadTexture(buttonTexture);
+        Assets_ReleaseTexture(buttonTexture);
     }
     if (sliderTexture)
     {
-        UnloadTexture(sliderTexture);
+        Assets_ReleaseTexture(sliderTexture);
+    }
+    if (atlas)
+    {
+        UnloadTextureAtlas(atlas);
     }
     if (background)
     {
@@ -41,8 +45,9 @@ MainMenu::~MainMenu()
 
 void MainMenu::LoadTextures()
 {
-    buttonTexture = LoadTexture("assets/gui_button.png");
-    sliderTexture = LoadTexture("assets/gui_slider.png");
+    atlas = LoadTextureAtlas(512);
+    buttonTexture = Assets_LoadTexture(atlas, "assets/gui_button.png");
+    sliderTexture = Assets_LoadTexture(atlas, "assets/gui_slider.png");
 }
 
 void MainMenu::DrawButton9Slice(float x, float y, float w, float h, const std::string& label, bool& outPressed)
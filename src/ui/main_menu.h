@@ -47,6 +47,7 @@ private:
     GameState gameState;
     WorldConfig config;
     
+    TextureAtlas* atlas;
     Texture2D* buttonTexture;
     Texture2D* sliderTexture;
     MenuBackground* background;
@@ -1,112 +1,185 @@
 #include "menu_background.h"
 #include "../engine/renderer.h"
 #include "../engine/camera.h"
+#include "../world.h"
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
 
-MenuBackground::MenuBackground()
-    : currentFrameIndex(0), frameWidth(2000), frameHeight(1600), nextSeed(54321)
+static const float BACKGROUND_TILE_SIZE = 16.0f;
+static const float BACKGROUND_ZOOM = 0.8f;
+
+// Runs on the worker thread: the world only lives long enough to sample its tiles.
+static void GenerateBackgroundTiles(BackgroundTiles* job, std::atomic<bool>* done)
 {
-    srand((unsigned)time(nullptr));
-    if (frames.empty())
+    ForgeWorld* world = World_Create(1, job->seed);
+    if (world)
     {
-        for (int i = 0; i < 3; ++i)
+        World_SetWaterAmount(world, job->waterAmount);
+        World_SetStoneAmount(world, job->stoneAmount);
+        World_SetCaveAmount(world, job->caveAmount);
+
+        job->tiles.resize((size_t)job->width * (size_t)job->height);
+        for (int y = 0; y < job->height; ++y)
         {
-            GenerateNextFrame();
+            for (int x = 0; x < job->width; ++x)
+            {
+                job->tiles[(size_t)y * job->width + x] =
+                    (unsigned char)World_GetTile(world, job->originX + x, job->originY + y);
+            }
         }
+        World_Destroy(world);
     }
-    if (!frames.empty())
+    done->store(true, std::memory_order_release);
+}
+
+MenuBackground::MenuBackground()
+    : currentFrameIndex(0), frameWidth(2000), frameHeight(1600), nextSeed(54321), generatedCount(0),
+      job(), jobFrameIndex(-1), jobDone(false)
+{
+    srand((unsigned)time(nullptr));
+    for (auto& frame : frames)
     {
-        frames[0].stage = 0;
-        frames[0].animationTimer = 0.0f;
+        frame = {};
+        frame.renderTexture = LoadRenderTexture(frameWidth, frameHeight);
     }
+    PrepareFrame(frames[0]);
 }
 
 MenuBackground::~MenuBackground()
 {
+    if (worker.joinable())
+        worker.join();
     for (auto& frame : frames)
-    {
-        if (frame.world)
-        {
-            delete frame.world;
-            frame.world = nullptr;
-        }
         UnloadRenderTexture(frame.renderTexture);
-    }
-    frames.clear();
 }
 
-void MenuBackground::GenerateNextFrame()
+void MenuBackground::PrepareFrame(BackgroundFrameState& frame)
 {
-    BackgroundFrameState newFrame = {};
-    
-    newFrame.seed = nextSeed;
-    newFrame.world = new World(8, nextSeed);
-    ForgeWorld* raw = newFrame.world->GetRaw();
-    raw->waterAmount = 0.2f + (rand() % 40) * 0.01f;
-    raw->stoneAmount = 0.2f + (rand() % 50) * 0.01f;
-    raw->caveAmount = 0.1f + (rand() % 30) * 0.01f;
-    World_ReloadChunks(raw);
-    
-    newFrame.renderTexture = LoadRenderTexture(frameWidth, frameHeight);
-    
-    newFrame.cameraX = (float)(rand() % 20000 - 10000);
-    newFrame.cameraY = (float)(rand() % 20000 - 10000);
-    
-    newFrame.x = 0.0f;
-    newFrame.y = 0.0f;
-    newFrame.opacity = 0.0f;
-    newFrame.stage = 0;
-    newFrame.animationTimer = 0.0f;
-    newFrame.fadeInDuration = 2.0f;
-    newFrame.moveDuration = 4.0f;
-    newFrame.fadeOutDuration = 1.5f;
-    
-    if (frames.size() % 2 == 0)
+    frame.ready = false;
+    frame.seed = nextSeed;
+    frame.cameraX = (float)(rand() % 20000 - 10000);
+    frame.cameraY = (float)(rand() % 20000 - 10000);
+
+    frame.x = 0.0f;
+    frame.y = 0.0f;
+    frame.opacity = 0.0f;
+    frame.stage = 0;
+    frame.animationTimer = 0.0f;
+    frame.fadeInDuration = 2.0f;
+    frame.moveDuration = 4.0f;
+    frame.fadeOutDuration = 1.5f;
+
+    if (generatedCount % 2 == 0)
     {
-        newFrame.startX = frameWidth * 0.1f;
-        newFrame.startY = frameHeight * 0.05f;
-        newFrame.endX = -frameWidth * 0.3f;
-        newFrame.endY = -frameHeight * 0.2f;
+        frame.startX = frameWidth * 0.1f;
+        frame.startY = frameHeight * 0.05f;
+        frame.endX = -frameWidth * 0.3f;
+        frame.endY = -frameHeight * 0.2f;
     }
     else
     {
-        newFrame.startX = -frameWidth * 0.2f;
-        newFrame.startY = frameHeight * 0.1f;
-        newFrame.endX = frameWidth * 0.6f;
-        newFrame.endY = frameHeight * 0.1f;
+        frame.startX = -frameWidth * 0.2f;
+        frame.startY = frameHeight * 0.1f;
+        frame.endX = frameWidth * 0.6f;
+        frame.endY = frameHeight * 0.1f;
     }
-    
-    newFrame.x = newFrame.startX;
-    newFrame.y = newFrame.startY;
-    
-    frames.push_back(newFrame);
+
+    frame.x = frame.startX;
+    frame.y = frame.startY;
+
+    // the camera projection spans the window, so that is the area baked into the texture
+    Renderer* renderer = GetGlobalRenderer();
+    float viewW = (renderer ? (float)renderer->width : (float)frameWidth) / BACKGROUND_ZOOM;
+    float viewH = (renderer ? (float)renderer->height : (float)frameHeight) / BACKGROUND_ZOOM;
+
+    job.seed = nextSeed;
+    job.waterAmount = 0.2f + (rand() % 40) * 0.01f;
+    job.stoneAmount = 0.2f + (rand() % 50) * 0.01f;
+    job.caveAmount = 0.1f + (rand() % 30) * 0.01f;
+    job.originX = (int)floorf(frame.cameraX / BACKGROUND_TILE_SIZE);
+    job.originY = (int)floorf(frame.cameraY / BACKGROUND_TILE_SIZE);
+    job.width = (int)ceilf(viewW / BACKGROUND_TILE_SIZE) + 2;
+    job.height = (int)ceilf(viewH / BACKGROUND_TILE_SIZE) + 2;
+    job.tiles.clear();
+
+    jobFrameIndex = (int)(&frame - frames);
+    jobDone.store(false, std::memory_order_relaxed);
+    worker = std::thread(GenerateBackgroundTiles, &job, &jobDone);
+
+    generatedCount++;
     nextSeed += 1000 + (rand() % 5000);
 }
 
-void MenuBackground::UpdateCurrentFrame(float dt)
+void MenuBackground::PollJob()
+{
+    if (jobFrameIndex < 0 || !jobDone.load(std::memory_order_acquire))
+        return;
+
+    worker.join();
+    BakeFrame(frames[jobFrameIndex]);
+    job.tiles.clear();
+    job.tiles.shrink_to_fit();
+    jobFrameIndex = -1;
+
+    BackgroundFrameState& next = frames[1 - currentFrameIndex];
+    if (!next.ready)
+        PrepareFrame(next);
+}
+
+void MenuBackground::BakeFrame(BackgroundFrameState& frame)
 {
-    if (frames.empty())
+    frame.ready = true;
+    if (frame.renderTexture.texture.id == 0 || job.tiles.empty())
         return;
-    
+
+    TileMap map = LoadTileMap(job.width, job.height, job.tiles.data());
+    World::ApplyTilePalette();
+
+    BeginTextureMode(frame.renderTexture);
+    Renderer_Clear(Color{0.5f, 0.8f, 1.0f, 1.0f});
+
+    Camera2D camera = {frame.cameraX, frame.cameraY, BACKGROUND_ZOOM};
+    BeginCameraMode(camera);
+    Renderer_DrawTileMap(&map, Rect{
+        job.originX * BACKGROUND_TILE_SIZE, job.originY * BACKGROUND_TILE_SIZE,
+        job.width * BACKGROUND_TILE_SIZE, job.height * BACKGROUND_TILE_SIZE
+    });
+    EndCameraMode();
+
+    EndTextureMode();
+    UnloadTileMap(&map);
+}
+
+void MenuBackground::UpdateCurrentFrame(float dt)
+{
     BackgroundFrameState& frame = frames[currentFrameIndex];
+    if (!frame.ready)
+        return;
+
     frame.animationTimer += dt;
-    
+
     float totalDuration = frame.fadeInDuration + frame.moveDuration + frame.fadeOutDuration;
-    
+
     if (frame.animationTimer >= totalDuration)
     {
-        currentFrameIndex = (currentFrameIndex + 1) % frames.size();
-        frames[currentFrameIndex].stage = 0;
-        frames[currentFrameIndex].animationTimer = 0.0f;
-        
-        if (frames.size() < 4)
-            GenerateNextFrame();
-        
+        frame.opacity = 0.0f;
+
+        // hold on black until the next frame has been baked
+        BackgroundFrameState& next = frames[1 - currentFrameIndex];
+        if (!next.ready)
+            return;
+
+        currentFrameIndex = 1 - currentFrameIndex;
+        next.stage = 0;
+        next.animationTimer = 0.0f;
+
+        if (jobFrameIndex < 0)
+            PrepareFrame(frame);
+
         return;
     }
-    
+
     if (frame.animationTimer < frame.fadeInDuration)
     {
         frame.opacity = frame.animationTimer / frame.fadeInDuration;
@@ -139,41 +212,23 @@ void MenuBackground::Update(float dt)
 
 void MenuBackground::Draw()
 {
-    if (frames.empty())
-        return;
-    
     Renderer* renderer = GetGlobalRenderer();
     if (!renderer)
         return;
 
+    PollJob();
+
     Renderer_Clear(Color{0.0f, 0.0f, 0.0f, 1.0f});
-    
+
     const BackgroundFrameState& frame = frames[currentFrameIndex];
-    
-    bool needsRender = true;
-    
-    if (needsRender && frame.world && frame.renderTexture.texture.id > 0)
-    {
-        BeginTextureMode(frame.renderTexture);
-        Renderer_Clear(Color{0.5f, 0.8f, 1.0f, 1.0f});
-        
-        Camera2D camera = {frame.cameraX, frame.cameraY, 0.8f};
-        BeginCameraMode(camera);
-        
-        frame.world->Draw(camera, frameWidth, frameHeight, true);
-        
-        EndCameraMode();
-        EndTextureMode();
-    }
-    
-    if (frame.renderTexture.texture.id > 0)
+    if (frame.ready && frame.renderTexture.texture.id > 0)
     {
         Rect src = {0, 0, (float)frameWidth, (float)frameHeight};
         Rect dst = {0, 0, (float)renderer->width, (float)renderer->height};
         Color tint = {1.0f, 1.0f, 1.0f, frame.opacity};
         Renderer_DrawTexturePro(frame.renderTexture.texture, src, dst, Vec2{0, 0}, 0.0f, tint);
     }
-    
+
     Color overlay = {0.0f, 0.0f, 0.0f, 0.5f};
     Renderer_DrawRectangle(Rect{0, 0, (float)renderer->width, (float)renderer->height}, overlay);
 }
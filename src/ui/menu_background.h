@@ -3,13 +3,14 @@
 
 #include "../engine/forge.h"
 #include "../engine/rendertexture.h"
-#include "../world.h"
+#include <atomic>
+#include <thread>
 #include <vector>
 
 struct BackgroundFrameState
 {
-    World* world;
     RenderTexture renderTexture;
+    bool ready;           // terrain has been baked into renderTexture
     float animationTimer;
     float fadeInDuration;
     float moveDuration;
@@ -23,23 +24,43 @@ struct BackgroundFrameState
     int seed;
 };
 
+// Tiles of one background frame, generated off the main thread.
+struct BackgroundTiles
+{
+    int seed;
+    float waterAmount;
+    float stoneAmount;
+    float caveAmount;
+    int originX, originY;
+    int width, height;
+    std::vector<unsigned char> tiles;
+};
+
 class MenuBackground
 {
 public:
     MenuBackground();
     ~MenuBackground();
-    
+
     void Update(float dt);
     void Draw();
-    
+
 private:
-    void GenerateNextFrame();
+    void PrepareFrame(BackgroundFrameState& frame);
+    void PollJob();
+    void BakeFrame(BackgroundFrameState& frame);
     void UpdateCurrentFrame(float dt);
-    
-    std::vector<BackgroundFrameState> frames;
+
+    BackgroundFrameState frames[2];
     int currentFrameIndex;
     int frameWidth, frameHeight;
     int nextSeed;
+    int generatedCount;
+
+    BackgroundTiles job;
+    int jobFrameIndex;
+    std::thread worker;
+    std::atomic<bool> jobDone;
 };
 
 #endif
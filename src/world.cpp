@@ -1,20 +1,58 @@
-#include "World.h"
+#include "world.h"
+#include <algorithm>
 #include <vector>
 #include <math.h>
 
+static const size_t CHUNK_TILEMAP_CACHE_CAPACITY = 1024;
+static const int MOB_GRID_CELL_TILES = 8;
+// below this many screen pixels per tile, chunks draw from their mip-mapped color maps
+static const float TERRAIN_LOD_TILE_PIXELS = 4.0f;
+static const int TERRAIN_LOD_LAYERS = 1024;
+static const int MOB_GRID_BUCKETS = 1024;
+
+static long long ChunkTilesKey(int cx, int cy, int mode)
+{
+    unsigned long long x = (unsigned int)cx;
+    unsigned long long y = (unsigned int)cy;
+    return (long long)((x << 33) ^ (y << 1) ^ (unsigned long long)(mode ? 1 : 0));
+}
+
 World::World(int loadRadiusChunks, int seed)
 {
     forgeWorld = World_Create(loadRadiusChunks, seed);
     tileSize = 16.0f;
     tileTriPos.reserve(8192);
     tileTriCol.reserve(16384);
+    drawFrame = 0;
+    tileUploadsLeft = 0;
+    tileUploadBudget = 1 << 30;
+    mobStep = 0;
+    mobGridStep = 0;
+    mobGridCount = -1;
+    lodArray = TileColorArray{};
+    Visibility_InitGrid(&mobGrid, MOB_GRID_CELL_TILES * tileSize, MOB_GRID_BUCKETS);
 }
 
 World::~World()
 {
+    for (auto& it : chunkTiles)
+        UnloadTileMap(&it.second.map);
+    UnloadTileColorArray(&lodArray);
+    Visibility_FreeGrid(&mobGrid);
     World_Destroy(forgeWorld);
 }
 
+void World::ApplyTilePalette()
+{
+    Color palette[TILE_CAVE_ENTRANCE + 1];
+    for (int t = 0; t <= TILE_CAVE_ENTRANCE; t++)
+    {
+        Vec4 c = World_GetTileColor((TileType)t);
+        palette[t] = Color{ c.x, c.y, c.z, t == TILE_EMPTY ? 0.0f : c.w };
+    }
+    Renderer_SetTilePalette(palette, TILE_CAVE_ENTRANCE + 1);
+}
+
 void World::Update(float dt, int isNight, Vec2 focusPos, Vec2 playerPos, float playerRadius, float* ioPlayerHP, bool updateMobs)
 {
     int camTileX = (int)floorf(focusPos.x / tileSize);
@@ -28,24 +66,252 @@ void World::Update(float dt, int isNight, Vec2 focusPos, Vec2 playerPos, float p
         ? camTileY / CHUNK_SIZE
         : (camTileY - CHUNK_SIZE + 1) / CHUNK_SIZE;
 
+    Profiler_BeginScope("Chunks");
     World_UpdateChunks(forgeWorld, centerChunkX, centerChunkY);
+    Profiler_EndScope();
     if (updateMobs)
+    {
+        Profiler_BeginScope("Mobs");
+        int mobCount = 0;
+        const Mob* mobs = World_GetMobs(forgeWorld, &mobCount);
+        mobPrevious.resize(mobs ? (size_t)mobCount : 0);
+        for (size_t i = 0; i < mobPrevious.size(); i++)
+            mobPrevious[i] = Vec2{ mobs[i].x, mobs[i].y };
         World_UpdateMobs(forgeWorld, dt, isNight, playerPos.x, playerPos.y, playerRadius, ioPlayerHP);
+        mobStep++;
+        Profiler_EndScope();
+    }
+    else
+        mobPrevious.clear();
+}
+
+void World::Draw(const Camera2D& camera, int screenW, int screenH, bool drawMobs, float alpha) const
+{
+    Rect view = Visibility_GetCameraRect(camera, screenW, screenH);
+    bool useLod = tileSize * camera.zoom < TERRAIN_LOD_TILE_PIXELS;
+
+    if (Renderer_GetBackend(GetGlobalRenderer()) != RENDERER_BACKEND_OPENGL)
+    {
+        int step = 1;
+        while (tileSize * camera.zoom * step < TERRAIN_LOD_TILE_PIXELS)
+            step *= 2;
+        VisibilityRange tiles = Visibility_GetCellRange(view, tileSize);
+        DrawTilesImmediate(tiles.x0, tiles.y0, tiles.x1, tiles.y1, step);
+    }
+    else
+    {
+        ApplyTilePalette();
+
+        drawFrame++;
+        tileUploadsLeft = tileUploadBudget;
+        int mode = forgeWorld->isCave;
+        float chunkWorldSize = CHUNK_SIZE * tileSize;
+        VisibilityRange chunks = Visibility_GetCellRange(view, chunkWorldSize);
+
+        lodInstances.clear();
+        for (int cy = chunks.y0; cy < chunks.y1; cy++)
+        {
+            for (int cx = chunks.x0; cx < chunks.x1; cx++)
+            {
+                // color maps match the tilemap shader when magnified, so switching is seamless
+                int layer = useLod ? GetChunkLodLayer(cx, cy, mode) : -1;
+                if (layer >= 0)
+                {
+                    lodInstances.push_back(QuadInstance{
+                        (cx + 0.5f) * chunkWorldSize, (cy + 0.5f) * chunkWorldSize,
+                        chunkWorldSize, chunkWorldSize, 0.0f, (float)layer,
+                        Color{ 1.0f, 1.0f, 1.0f, 1.0f }
+                    });
+                    continue;
+                }
+
+                const TileMap* map = GetChunkTileMap(cx, cy, mode);
+                if (map)
+                    Renderer_DrawTileMap(map, Rect{ cx * chunkWorldSize, cy * chunkWorldSize, chunkWorldSize, chunkWorldSize });
+            }
+        }
+        if (!lodInstances.empty())
+            Renderer_DrawQuadsInstanced(lodInstances.data(), (int)lodInstances.size(), lodArray.texture);
+
+        EvictChunkTileMaps();
+    }
+
+    if (drawMobs)
+    {
+        int mobCount = 0;
+        const Mob* mobs = World_GetMobs(forgeWorld, &mobCount);
+        int typeCount = 0;
+        const MobArchetype* types = World_GetMobArchetypes(forgeWorld, &typeCount);
+        if (mobs && types)
+        {
+            // attacks remove mobs between steps, so a count change also invalidates the grid
+            if (mobGridStep != mobStep || mobGridCount != mobCount)
+                RebuildMobGrid();
+
+            visibleMobs.resize((size_t)mobCount);
+            int visibleCount = mobCount > 0 ? Visibility_Query(&mobGrid, view, visibleMobs.data(), mobCount) : 0;
+            // grid order varies as mobs change cells; keep overlapping mobs stacked the same way
+            std::sort(visibleMobs.begin(), visibleMobs.begin() + visibleCount);
+
+            mobInstances.clear();
+            for (int v = 0; v < visibleCount; v++)
+            {
+                int i = visibleMobs[v];
+                const Mob& mob = mobs[i];
+                if (mob.type < 0 || mob.type >= typeCount)
+                    continue;
+                const MobArchetype& arch = types[mob.type];
+                if (Visibility_IsTooSmall(camera, arch.size))
+                    continue;
+
+                // removals swap mobs around, so only blend short moves
+                float x = mob.x;
+                float y = mob.y;
+                if ((size_t)i < mobPrevious.size())
+                {
+                    float dx = mob.x - mobPrevious[i].x;
+                    float dy = mob.y - mobPrevious[i].y;
+                    if (dx * dx + dy * dy < tileSize * tileSize)
+                    {
+                        x = mobPrevious[i].x + dx * alpha;
+                        y = mobPrevious[i].y + dy * alpha;
+                    }
+                }
+
+                mobInstances.push_back(QuadInstance{
+                    x, y, arch.size, arch.size, 0.0f, 0.0f,
+                    Color{ arch.color.x, arch.color.y, arch.color.z, arch.color.w }
+                });
+            }
+            Renderer_DrawQuadsInstanced(mobInstances.data(), (int)mobInstances.size(), 0);
+        }
+    }
+}
+
+void World::RebuildMobGrid() const
+{
+    int mobCount = 0;
+    const Mob* mobs = World_GetMobs(forgeWorld, &mobCount);
+    int typeCount = 0;
+    const MobArchetype* types = World_GetMobArchetypes(forgeWorld, &typeCount);
+
+    Visibility_ClearGrid(&mobGrid);
+    for (int i = 0; i < mobCount; i++)
+    {
+        float size = (mobs[i].type >= 0 && mobs[i].type < typeCount) ? types[mobs[i].type].size : 0.0f;
+        // drawn positions trail the simulation by up to one tile of interpolation
+        Visibility_Insert(&mobGrid, i, mobs[i].x, mobs[i].y, size * 0.5f + tileSize);
+    }
+    mobGridStep = mobStep;
+    mobGridCount = mobCount;
+}
+
+const TileMap* World::GetChunkTileMap(int cx, int cy, int mode) const
+{
+    unsigned int revision = World_GetChunkRevision(forgeWorld, cx, cy, mode);
+    if (revision == 0)
+        return nullptr;
+
+    ChunkTiles& entry = chunkTiles[ChunkTilesKey(cx, cy, mode)];
+    entry.lastUsed = drawFrame;
+    if (entry.revision != revision)
+    {
+        if (tileUploadsLeft <= 0)
+            return entry.map.texture ? &entry.map : nullptr;
+        tileUploadsLeft--;
+
+        unsigned char types[CHUNK_SIZE * CHUNK_SIZE];
+        if (!World_GetChunkTiles(forgeWorld, cx, cy, mode, types))
+            return nullptr;
+
+        if (!entry.map.texture)
+            entry.map = LoadTileMap(CHUNK_SIZE, CHUNK_SIZE, types);
+        else
+            UpdateTileMap(&entry.map, types);
+        entry.revision = revision;
+    }
+    return &entry.map;
+}
+
+int World::GetChunkLodLayer(int cx, int cy, int mode) const
+{
+    unsigned int revision = World_GetChunkRevision(forgeWorld, cx, cy, mode);
+    if (revision == 0)
+        return -1;
+
+    if (!lodArray.texture)
+    {
+        lodArray = LoadTileColorArray(CHUNK_SIZE, CHUNK_SIZE, TERRAIN_LOD_LAYERS);
+        if (!lodArray.texture)
+            return -1;
+        for (int layer = TERRAIN_LOD_LAYERS - 1; layer >= 0; layer--)
+            lodFreeLayers.push_back(layer);
+    }
+
+    ChunkTiles& entry = chunkTiles[ChunkTilesKey(cx, cy, mode)];
+    entry.lastUsed = drawFrame;
+    if (entry.lodSlot == 0)
+    {
+        // out of layers: the caller falls back to the chunk's tilemap
+        if (lodFreeLayers.empty())
+            return -1;
+        entry.lodSlot = lodFreeLayers.back() + 1;
+        entry.lodRevision = 0;
+        lodFreeLayers.pop_back();
+    }
+
+    if (entry.lodRevision != revision)
+    {
+        if (tileUploadsLeft <= 0)
+            return entry.lodRevision ? entry.lodSlot - 1 : -1;
+        tileUploadsLeft--;
+
+        unsigned char types[CHUNK_SIZE * CHUNK_SIZE];
+        if (!World_GetChunkTiles(forgeWorld, cx, cy, mode, types))
+            return -1;
+
+        UpdateTileColorLayer(&lodArray, entry.lodSlot - 1, types);
+        entry.lodRevision = revision;
+    }
+    return entry.lodSlot - 1;
 }
 
-void World::Draw(const Camera2D& camera, int screenW, int screenH, bool drawMobs) const
+void World::EvictChunkTileMaps() const
 {
-    int tilesXStart = (int)floorf(camera.x / tileSize);
-    int tilesYStart = (int)floorf(camera.y / tileSize);
+    if (chunkTiles.size() <= CHUNK_TILEMAP_CACHE_CAPACITY)
+        return;
 
-    int tilesXEnd = tilesXStart +
-        (int)ceilf(screenW / tileSize / camera.zoom) + 2;
+    std::vector<std::pair<unsigned int, long long>> byAge;
+    byAge.reserve(chunkTiles.size());
+    for (const auto& it : chunkTiles)
+    {
+        if (it.second.lastUsed != drawFrame)
+            byAge.emplace_back(it.second.lastUsed, it.first);
+    }
+
+    size_t excess = chunkTiles.size() - CHUNK_TILEMAP_CACHE_CAPACITY;
+    if (excess > byAge.size())
+        excess = byAge.size();
+    std::partial_sort(byAge.begin(), byAge.begin() + excess, byAge.end());
+
+    for (size_t i = 0; i < excess; i++)
+    {
+        auto it = chunkTiles.find(byAge[i].second);
+        UnloadTileMap(&it->second.map);
+        if (it->second.lodSlot)
+            lodFreeLayers.push_back(it->second.lodSlot - 1);
+        chunkTiles.erase(it);
+    }
+}
 
-    int tilesYEnd = tilesYStart +
-        (int)ceilf(screenH / tileSize / camera.zoom) + 2;
+void World::DrawTilesImmediate(int tilesXStart, int tilesYStart, int tilesXEnd, int tilesYEnd, int step) const
+{
+    // align blocks to the world grid so they do not crawl as the camera moves
+    tilesXStart = (int)floorf((float)tilesXStart / step) * step;
+    tilesYStart = (int)floorf((float)tilesYStart / step) * step;
 
-    const int tilesW = tilesXEnd - tilesXStart;
-    const int tilesH = tilesYEnd - tilesYStart;
+    const int tilesW = (tilesXEnd - tilesXStart + step - 1) / step;
+    const int tilesH = (tilesYEnd - tilesYStart + step - 1) / step;
     const int maxTiles = (tilesW > 0 && tilesH > 0)
         ? tilesW * tilesH
         : 0;
@@ -55,9 +321,10 @@ void World::Draw(const Camera2D& camera, int screenW, int screenH, bool drawMobs
     tileTriPos.reserve((size_t)maxTiles * 6 * 2);
     tileTriCol.reserve((size_t)maxTiles * 6 * 4);
 
-    for (int y = tilesYStart; y < tilesYEnd; y++)
+    const float blockSize = tileSize * step;
+    for (int y = tilesYStart; y < tilesYEnd; y += step)
     {
-        for (int x = tilesXStart; x < tilesXEnd; x++)
+        for (int x = tilesXStart; x < tilesXEnd; x += step)
         {
             TileType tileType = World_GetTile(forgeWorld, x, y);
             if (tileType == TILE_EMPTY)
@@ -67,8 +334,8 @@ void World::Draw(const Camera2D& camera, int screenW, int screenH, bool drawMobs
 
             float x0 = x * tileSize;
             float y0 = y * tileSize;
-            float x1 = x0 + tileSize;
-            float y1 = y0 + tileSize;
+            float x1 = x0 + blockSize;
+            float y1 = y0 + blockSize;
 
             float pos[] =
             {
@@ -98,27 +365,4 @@ void World::Draw(const Camera2D& camera, int screenW, int screenH, bool drawMobs
         tileTriCol.data(),
         (int)(tileTriPos.size() / 2)
     );
-
-    if (drawMobs)
-    {
-        int mobCount = 0;
-        const Mob* mobs = World_GetMobs(forgeWorld, &mobCount);
-        int typeCount = 0;
-        const MobArchetype* types = World_GetMobArchetypes(forgeWorld, &typeCount);
-        if (mobs && types)
-        {
-            for (int i = 0; i < mobCount; i++)
-            {
-                const Mob& mob = mobs[i];
-                if (mob.type < 0 || mob.type >= typeCount)
-                    continue;
-                const MobArchetype& arch = types[mob.type];
-
-                Renderer_DrawRectangle(
-                    Rect{ mob.x - arch.size * 0.5f, mob.y - arch.size * 0.5f, arch.size, arch.size },
-                    Color{ arch.color.x, arch.color.y, arch.color.z, arch.color.w }
-                );
-            }
-        }
-    }
 }
@@ -2,6 +2,7 @@
 #define __WORLD_H__
 
 #include "engine/forge.h"
+#include <unordered_map>
 #include <vector>
 
 class World
@@ -11,16 +12,52 @@ public:
     ~World();
 
     void Update(float dt, int isNight, Vec2 focusPos, Vec2 playerPos, float playerRadius, float* ioPlayerHP, bool updateMobs);
-    void Draw(const Camera2D& camera, int screenW, int screenH, bool drawMobs) const;
+    // alpha interpolates mobs between the last two Update calls; only chunks and
+    // mobs inside the camera rect for a screenW x screenH screen are drawn
+    void Draw(const Camera2D& camera, int screenW, int screenH, bool drawMobs, float alpha = 1.0f) const;
+    // chunk textures (re)uploaded per Draw; stale or missing chunks catch up on later frames
+    void SetTileUploadBudget(int uploads) { tileUploadBudget = uploads; }
+
+    static void ApplyTilePalette();
 
     float GetTileSize() const { return tileSize; }
     ForgeWorld* GetRaw() const { return forgeWorld; }
 
 private:
+    struct ChunkTiles
+    {
+        TileMap map;
+        unsigned int revision;
+        unsigned int lastUsed;
+        int lodSlot;            // layer + 1 in lodArray, 0 when the chunk has none
+        unsigned int lodRevision;
+    };
+
+    // step > 1 draws one tile of every step x step block, scaled up to cover it
+    void DrawTilesImmediate(int tilesXStart, int tilesYStart, int tilesXEnd, int tilesYEnd, int step) const;
+    const TileMap* GetChunkTileMap(int cx, int cy, int mode) const;
+    int GetChunkLodLayer(int cx, int cy, int mode) const;
+    void EvictChunkTileMaps() const;
+    void RebuildMobGrid() const;
+
     ForgeWorld* forgeWorld;
     float tileSize;
     mutable std::vector<float> tileTriPos;
     mutable std::vector<float> tileTriCol;
+    mutable std::vector<QuadInstance> mobInstances;
+    std::vector<Vec2> mobPrevious;
+    unsigned int mobStep;
+    mutable VisibilityGrid mobGrid;
+    mutable unsigned int mobGridStep;
+    mutable int mobGridCount;
+    mutable std::vector<int> visibleMobs;
+    mutable std::unordered_map<long long, ChunkTiles> chunkTiles;
+    mutable TileColorArray lodArray;
+    mutable std::vector<int> lodFreeLayers;
+    mutable std::vector<QuadInstance> lodInstances;
+    mutable unsigned int drawFrame;
+    mutable int tileUploadsLeft;
+    int tileUploadBudget;
 };
 
 #endif // __WORLD_H__
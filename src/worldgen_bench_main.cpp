@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "engine/worldgen.h"
+
+// World generation benchmark and output guard: generates fixed chunk sets for
+// several seeds and amount settings, reports chunks/s on one and on all
+// threads, and checks a digest of every set's tiles against the golden table
+// below. Any change to the digests changes worlds players already have, so a
+// mismatch exits non-zero.
+//
+//   worldgen_bench [repeats] [--threads N] [--print-golden]
+//
+// --print-golden prints the table for the current generator; only paste it in
+// when the output change is intended.
+
+static const int BENCH_CHUNK_RADIUS = 8;    // chunks -8..7 on both axes
+static const int BENCH_DEFAULT_REPEATS = 3;
+
+struct GenCase
+{
+    const char* name;
+    int seed;
+    int isCave;
+    float waterAmount;
+    float stoneAmount;
+    float caveAmount;
+    unsigned long long golden;
+};
+
+static const GenCase CASES[] =
+{
+    { "default",       12345,     0, 0.5f, 0.5f, 0.5f, 0x029d605850c82e1bull },
+    { "default cave",  12345,     1, 0.5f, 0.5f, 0.5f, 0x3fcd92c24eccaf6full },
+    { "wet",           1,         0, 0.9f, 0.2f, 0.5f, 0x2d0ffeb9c2af12f0ull },
+    { "rocky",         987654321, 0, 0.2f, 0.9f, 0.5f, 0xd82cac4360032ed9ull },
+    { "rocky cave",    987654321, 1, 0.2f, 0.9f, 0.9f, 0x3b56e208bfd9da1bull },
+    { "negative seed", -424242,   0, 0.0f, 1.0f, 0.0f, 0x177fb037b08522a4ull },
+};
+
+static const int CASE_COUNT = (int)(sizeof(CASES) / sizeof(CASES[0]));
+
+// FNV-1a over chunk coordinates and tile types, in chunk order
+static unsigned long long HashChunks(const std::vector<Chunk>& chunks)
+{
+    unsigned long long h = 1469598103934665603ull;
+    auto mix = [&h](unsigned char b) { h = (h ^ b) * 1099511628211ull; };
+    for (const Chunk& chunk : chunks)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            mix((unsigned char)((unsigned int)chunk.cx >> shift));
+            mix((unsigned char)((unsigned int)chunk.cy >> shift));
+        }
+        for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i)
+            mix((unsigned char)chunk.tiles[i].type);
+    }
+    return h;
+}
+
+static void GenerateRange(std::vector<Chunk>& chunks, const GenCase& c, int first, int last)
+{
+    for (int i = first; i < last; ++i)
+    {
+        Chunk& chunk = chunks[(size_t)i];
+        chunk.cx = i % (BENCH_CHUNK_RADIUS * 2) - BENCH_CHUNK_RADIUS;
+        chunk.cy = i / (BENCH_CHUNK_RADIUS * 2) - BENCH_CHUNK_RADIUS;
+        chunk.generated = 0;
+        Chunk_Generate(&chunk, c.seed, c.isCave, c.waterAmount, c.stoneAmount, c.caveAmount);
+    }
+}
+
+// returns the best wall time of `repeats` runs, in seconds
+static double Generate(std::vector<Chunk>& chunks, const GenCase& c, int threads, int repeats)
+{
+    int count = (int)chunks.size();
+    double best = 0.0;
+    for (int r = 0; r < repeats; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (threads <= 1)
+        {
+            GenerateRange(chunks, c, 0, count);
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            int per = (count + threads - 1) / threads;
+            for (int t = 0; t < threads; ++t)
+            {
+                int first = t * per;
+                int last = std::min(count, first + per);
+                if (first < last)
+                    workers.emplace_back(GenerateRange, std::ref(chunks), std::cref(c), first, last);
+            }
+            for (std::thread& w : workers)
+                w.join();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    int repeats = BENCH_DEFAULT_REPEATS;
+    int threads = (int)std::thread::hardware_concurrency();
+    bool printGolden = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--print-golden") == 0)
+            printGolden = true;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else
+            repeats = atoi(argv[i]);
+    }
+    if (repeats <= 0)
+        repeats = BENCH_DEFAULT_REPEATS;
+    if (threads <= 0)
+        threads = 1;
+
+    const int chunkCount = (BENCH_CHUNK_RADIUS * 2) * (BENCH_CHUNK_RADIUS * 2);
+    std::vector<Chunk> chunks((size_t)chunkCount);
+
+    if (printGolden)
+    {
+        for (const GenCase& c : CASES)
+        {
+            Generate(chunks, c, threads, 1);
+            printf("0x%016llxull  %s\n", HashChunks(chunks), c.name);
+        }
+        return 0;
+    }
+
+    printf("%d chunks per case, best of %d, %d threads\n", chunkCount, repeats, threads);
+    printf("%-14s %12s %12s %8s  %s\n", "case", "1T chunks/s", "MT chunks/s", "speedup", "digest");
+
+    int failures = 0;
+    double singleTotal = 0.0;
+    double multiTotal = 0.0;
+    for (const GenCase& c : CASES)
+    {
+        double single = Generate(chunks, c, 1, repeats);
+        unsigned long long singleHash = HashChunks(chunks);
+        double multi = Generate(chunks, c, threads, repeats);
+        unsigned long long multiHash = HashChunks(chunks);
+        singleTotal += single;
+        multiTotal += multi;
+
+        const char* status = "ok";
+        if (singleHash != c.golden)
+            status = "MISMATCH";
+        else if (multiHash != singleHash)
+            status = "MISMATCH (threaded)";
+        if (strcmp(status, "ok") != 0)
+            failures++;
+
+        printf("%-14s %12.0f %12.0f %7.2fx  %016llx %s\n", c.name,
+            (double)chunkCount / single, (double)chunkCount / multi, single / multi, singleHash, status);
+        if (singleHash != c.golden)
+            printf("%14s expected %016llx\n", "", c.golden);
+    }
+
+    printf("%-14s %12.0f %12.0f %7.2fx\n", "total",
+        (double)(chunkCount * CASE_COUNT) / singleTotal, (double)(chunkCount * CASE_COUNT) / multiTotal, singleTotal / multiTotal);
+
+    if (failures > 0)
+    {
+        printf("%d of %d cases differ from the golden digests\n", failures, CASE_COUNT);
+        return 1;
+    }
+    return 0;
+}